@@ -15,6 +15,24 @@ SOURCES += \
     laucmswidget.cpp \
     laumemoryobject.cpp \
     laudeepnetworkobject.cpp \
+    lauannotationjournal.cpp \
+    lauannotationstatistics.cpp \
+    laucocoexporter.cpp \
+    laucommandline.cpp \
+    laudatasetindex.cpp \
+    laudatasetreport.cpp \
+    laudirectorywalker.cpp \
+    laudirectorywatcher.cpp \
+    lauimagepreviewcache.cpp \
+    lauimageprefetchobject.cpp \
+    lauimagepyramidobject.cpp \
+    lauimagewriterobject.cpp \
+    lauperceptualhash.cpp \
+    lauposeannotation.cpp \
+    lauposeexporter.cpp \
+    lauposeimporter.cpp \
+    lauposeinferenceobject.cpp \
+    lauthumbnailbrowser.cpp \
     lauyoloposelabelerwidget.cpp
 
 HEADERS += \
@@ -22,8 +40,33 @@ HEADERS += \
     laucmswidget.h \
     laumemoryobject.h \
     laudeepnetworkobject.h \
+    lauannotationjournal.h \
+    lauannotationstatistics.h \
+    laucocoexporter.h \
+    laucommandline.h \
+    laudatasetindex.h \
+    laudatasetreport.h \
+    laudirectorywalker.h \
+    laudirectorywatcher.h \
+    lauimagepreviewcache.h \
+    lauimageprefetchobject.h \
+    lauimagepyramidobject.h \
+    lauimagewriterobject.h \
+    lauperceptualhash.h \
+    lauposeannotation.h \
+    lauposeexporter.h \
+    lauposeimporter.h \
+    lauposeinferenceobject.h \
+    lauthumbnailbrowser.h \
     lauyoloposelabelerwidget.h
 
+# CONFIG += headless builds only the command line subcommands, leaving the labeler window out
+headless {
+    DEFINES += HEADLESS
+    SOURCES -= lauyoloposelabelerwidget.cpp
+    HEADERS -= lauyoloposelabelerwidget.h
+}
+
 unix:macx {
     QMAKE_CXXFLAGS += -msse2 -msse3 -mssse3 -msse4.1
     QMAKE_CXXFLAGS_WARN_ON += -Wno-reorder
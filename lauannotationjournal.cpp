@@ -0,0 +1,253 @@
+#include "lauannotationjournal.h"
+
+#include <QDir>
+#include <QDebug>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUAnnotationJournal::LAUAnnotationJournal(QString filename, QObject *parent) : QThread(parent), fileString(filename), fileBytes(0), quitFlag(false), busyFlag(false), compactFlag(false)
+{
+    QDir().mkpath(QFileInfo(fileString).absolutePath());
+
+    // PICK UP WHATEVER A PREVIOUS SESSION LEFT BEHIND BEFORE WE START ADDING TO IT
+    load();
+
+    if (file.isOpen() == false) {
+        file.setFileName(fileString);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Append) == false) {
+            qDebug() << QString("LAUAnnotationJournal::LAUAnnotationJournal() can't open %1").arg(fileString);
+        }
+        fileBytes = file.size();
+    }
+
+    start(QThread::LowPriority);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUAnnotationJournal::~LAUAnnotationJournal()
+{
+    mutex.lock();
+    quitFlag = true;
+    queueCondition.wakeAll();
+    mutex.unlock();
+
+    // THE THREAD WRITES OUT ANYTHING STILL BUFFERED BEFORE IT RETURNS
+    wait();
+    file.close();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationJournal::append(QString filename, QByteArray xml)
+{
+    QByteArray bytes = record(filename, xml);
+
+    QMutexLocker locker(&mutex);
+    buffer.append(bytes);
+    pending[filename] = xml;
+
+    // WAKE THE THREAD TO OPEN A NEW BATCH, OR TO CLOSE THIS ONE EARLY IF IT'S GETTING BIG
+    if (buffer.size() == bytes.size() || buffer.size() > LAUANNOTATIONJOURNALBATCHBYTES) {
+        queueCondition.wakeAll();
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationJournal::markFolded(QString filename)
+{
+    QMutexLocker locker(&mutex);
+    if (pending.remove(filename) > 0 && pending.isEmpty()) {
+        // EVERYTHING IN THE JOURNAL IS NOW IN ITS TIFF SO THE WHOLE FILE CAN GO
+        compactFlag = true;
+        queueCondition.wakeAll();
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationJournal::flush()
+{
+    QMutexLocker locker(&mutex);
+    queueCondition.wakeAll();
+    while (buffer.isEmpty() == false || busyFlag) {
+        drainCondition.wait(&mutex);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QString LAUAnnotationJournal::defaultFilename()
+{
+    return (QString("%1/annotations.journal").arg(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationJournal::run()
+{
+    forever {
+        // SLEEP UNTIL THERE IS SOMETHING TO WRITE
+        mutex.lock();
+        busyFlag = false;
+        drainCondition.wakeAll();
+        while (buffer.isEmpty() && compactFlag == false && quitFlag == false) {
+            queueCondition.wait(&mutex);
+        }
+        if (buffer.isEmpty() && compactFlag == false) {
+            mutex.unlock();
+            return;
+        }
+
+        // THEN GIVE THE BATCH WINDOW A CHANCE TO COLLECT MORE EDITS UNLESS SOMEONE WANTS THEM ON DISK NOW
+        if (quitFlag == false && compactFlag == false && buffer.size() <= LAUANNOTATIONJOURNALBATCHBYTES) {
+            queueCondition.wait(&mutex, LAUANNOTATIONJOURNALFLUSHMSEC);
+        }
+        QByteArray bytes = buffer;
+        buffer.clear();
+        bool compactNow = compactFlag || (fileBytes + bytes.size() > LAUANNOTATIONJOURNALMAXBYTES);
+        compactFlag = false;
+        QHash<QString, QByteArray> edits = pending;
+        busyFlag = (bytes.isEmpty() == false || compactNow);
+        mutex.unlock();
+
+        if (compactNow) {
+            // THE PENDING TABLE ALREADY HOLDS THE NEWEST VERSION OF EVERYTHING IN THIS BATCH
+            if (compact(edits)) {
+                continue;
+            }
+        }
+
+        if (bytes.isEmpty() == false) {
+            // ONE WRITE AND ONE SYNC FOR EVERY EDIT THAT CAME IN DURING THE BATCH WINDOW
+            if (file.write(bytes) != bytes.size() || sync(&file) == false) {
+                qDebug() << QString("LAUAnnotationJournal::run() failed to write %1").arg(fileString);
+            }
+            fileBytes += bytes.size();
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUAnnotationJournal::compact(QHash<QString, QByteArray> edits)
+{
+    // REWRITE THE JOURNAL WITH JUST THE LATEST EDIT OF EACH UNFOLDED FILE AND SWAP IT IN
+    QSaveFile saveFile(fileString);
+    if (saveFile.open(QIODevice::WriteOnly) == false) {
+        return (false);
+    }
+
+    QHashIterator<QString, QByteArray> iterator(edits);
+    while (iterator.hasNext()) {
+        iterator.next();
+        saveFile.write(record(iterator.key(), iterator.value()));
+    }
+
+    file.close();
+    bool flag = saveFile.commit();
+    if (flag == false) {
+        qDebug() << QString("LAUAnnotationJournal::compact() failed to rewrite %1").arg(fileString);
+    }
+
+    file.setFileName(fileString);
+    file.open(QIODevice::WriteOnly | QIODevice::Append);
+    fileBytes = file.size();
+
+    return (flag);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationJournal::load()
+{
+    QFile inFile(fileString);
+    if (inFile.open(QIODevice::ReadOnly) == false) {
+        return;
+    }
+
+    // LATER RECORDS REPLACE EARLIER ONES, AND A TORN OR CORRUPT RECORD MARKS WHERE A CRASH CUT US OFF
+    QDataStream stream(&inFile);
+    while (stream.atEnd() == false) {
+        quint32 magic = 0;
+        QByteArray payload, hash;
+        stream >> magic >> payload >> hash;
+        if (stream.status() != QDataStream::Ok || magic != LAUANNOTATIONJOURNALMAGIC) {
+            break;
+        }
+        if (QCryptographicHash::hash(payload, QCryptographicHash::Md5) != hash) {
+            break;
+        }
+
+        QDataStream payloadStream(payload);
+        qint64 time = 0;
+        QString filename;
+        QByteArray xml;
+        payloadStream >> time >> filename >> xml;
+        if (payloadStream.status() == QDataStream::Ok) {
+            pending[filename] = xml;
+        }
+    }
+    inFile.close();
+
+    if (pending.isEmpty() == false) {
+        qDebug() << QString("LAUAnnotationJournal::load() found %1 unsaved edits in %2").arg(pending.count()).arg(fileString);
+    }
+
+    // START THE NEW SESSION FROM A CLEAN COPY SO A TORN TAIL DOESN'T HIDE THE RECORDS WE APPEND AFTER IT
+    compact(pending);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QByteArray LAUAnnotationJournal::record(QString filename, QByteArray xml)
+{
+    QByteArray payload;
+    QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+    payloadStream << (qint64)QDateTime::currentMSecsSinceEpoch() << filename << xml;
+
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream << (quint32)LAUANNOTATIONJOURNALMAGIC << payload << QCryptographicHash::hash(payload, QCryptographicHash::Md5);
+    return (bytes);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUAnnotationJournal::sync(QFile *file)
+{
+    if (file->flush() == false) {
+        return (false);
+    }
+#if defined(Q_OS_WIN)
+    return (FlushFileBuffers((HANDLE)_get_osfhandle(file->handle())) != 0);
+#else
+    return (::fsync(file->handle()) == 0);
+#endif
+}
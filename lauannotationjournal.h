@@ -0,0 +1,71 @@
+#ifndef LAUANNOTATIONJOURNAL_H
+#define LAUANNOTATIONJOURNAL_H
+
+#include <QHash>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QObject>
+#include <QByteArray>
+#include <QWaitCondition>
+
+#define LAUANNOTATIONJOURNALMAGIC       0x4C41554A
+#define LAUANNOTATIONJOURNALFLUSHMSEC   200
+#define LAUANNOTATIONJOURNALBATCHBYTES  (64 * 1024)
+#define LAUANNOTATIONJOURNALMAXBYTES    (4 * 1024 * 1024)
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUAnnotationJournal : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit LAUAnnotationJournal(QString filename = defaultFilename(), QObject *parent = nullptr);
+    ~LAUAnnotationJournal();
+
+    // LATEST EDIT OF EVERY FILE THAT HASN'T BEEN FOLDED INTO ITS TIFF YET, INCLUDING ANY LEFT OVER FROM A CRASH
+    QHash<QString, QByteArray> pendingEdits() const
+    {
+        QMutexLocker locker(&mutex);
+        return (pending);
+    }
+
+    // RECORD AN EDIT, IT REACHES THE DISK WITH THE NEXT BATCH OF EDITS
+    void append(QString filename, QByteArray xml);
+
+    // CALL ONCE A FILE'S LATEST EDIT IS SAFELY IN ITS OWN XML PACKET SO THE JOURNAL CAN FORGET IT
+    void markFolded(QString filename);
+
+    // BLOCK UNTIL EVERY EDIT APPENDED SO FAR HAS BEEN SYNCED TO DISK
+    void flush();
+
+    static QString defaultFilename();
+
+protected:
+    void run();
+
+private:
+    QString fileString;
+    QFile file;
+    qint64 fileBytes;
+
+    bool quitFlag;
+    bool busyFlag;
+    bool compactFlag;
+
+    mutable QMutex mutex;
+    QWaitCondition queueCondition;
+    QWaitCondition drainCondition;
+    QByteArray buffer;
+    QHash<QString, QByteArray> pending;
+
+    void load();
+    bool compact(QHash<QString, QByteArray> edits);
+
+    static QByteArray record(QString filename, QByteArray xml);
+    static bool sync(QFile *file);
+};
+
+#endif // LAUANNOTATIONJOURNAL_H
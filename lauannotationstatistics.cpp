@@ -0,0 +1,296 @@
+#include "lauannotationstatistics.h"
+
+#include <QtMath>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationStatisticsTask::run()
+{
+    // NOTHING HERE TOUCHES PIXELS, THE INDEX ALREADY HOLDS EVERY FIDUCIAL OR READS THEM FROM THE XML PACKET
+    for (int n = first; n < last; n++) {
+        if (cancelFlag->loadAcquire()) {
+            return;
+        }
+        if (scoreVector) {
+            scoreVector[n] = statistics->score(datasetIndex->entry(n));
+        } else {
+            statistics->accumulate(datasetIndex->entry(n));
+        }
+        doneCount->fetchAndAddRelaxed(1);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUAnnotationStatistics::LAUAnnotationStatistics(QStringList fiducials) : fiducialStrings(fiducials)
+{
+    ;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDatasetIndex::Entry LAUAnnotationStatistics::arrange(const LAUDatasetIndex::Entry &entry) const
+{
+    // OLDER FILES STORE THEIR FIDUCIALS IN A ROTATED ORDER, SO LINE THEM UP BY NAME BEFORE ANYTHING IS MEASURED
+    if (fiducialStrings.isEmpty()) {
+        return (entry);
+    }
+    return (LAUDatasetIndex::arrange(entry, fiducialStrings));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationStatistics::resizeFiducials(int count)
+{
+    while (visibleVector.count() < count) {
+        visibleVector << 0;
+        totalVector << 0;
+        positionHistograms << QVector<qint64>(LAUANNOTATIONSTATISTICSBINS, 0);
+        positionHistograms << QVector<qint64>(LAUANNOTATIONSTATISTICSBINS, 0);
+    }
+    while (pairHistograms.count() < count * (count - 1) / 2) {
+        pairHistograms << QVector<qint64>(LAUANNOTATIONSTATISTICSBINS, 0);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUAnnotationStatistics::bin(float value)
+{
+    return (qBound(0, (int)(value * LAUANNOTATIONSTATISTICSBINS), LAUANNOTATIONSTATISTICSBINS - 1));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUAnnotationStatistics::normalize(const LAUDatasetIndex::Entry &entry, QVector<float> *u, QVector<float> *v, float *diagonal)
+{
+    int fiducials = qMin(entry.xVector.count(), qMin(entry.yVector.count(), entry.zVector.count()));
+
+    // THE BOX AROUND THE VISIBLE FIDUCIALS TAKES OUT WHERE THE ANIMAL STANDS AND HOW BIG IT LOOKS
+    int visible = 0;
+    int xMin = 0, xMax = 0, yMin = 0, yMax = 0;
+    for (int n = 0; n < fiducials; n++) {
+        if (entry.zVector.at(n) == 0) {
+            continue;
+        }
+        int x = entry.xVector.at(n);
+        int y = entry.yVector.at(n);
+        if (visible++ == 0) {
+            xMin = xMax = x;
+            yMin = yMax = y;
+        } else {
+            xMin = qMin(xMin, x);
+            xMax = qMax(xMax, x);
+            yMin = qMin(yMin, y);
+            yMax = qMax(yMax, y);
+        }
+    }
+    if (visible < 2 || xMax == xMin || yMax == yMin) {
+        return (false);
+    }
+
+    u->fill(0.0f, fiducials);
+    v->fill(0.0f, fiducials);
+    for (int n = 0; n < fiducials; n++) {
+        (*u)[n] = (float)(entry.xVector.at(n) - xMin) / (float)(xMax - xMin);
+        (*v)[n] = (float)(entry.yVector.at(n) - yMin) / (float)(yMax - yMin);
+    }
+    *diagonal = (float)qSqrt((double)(xMax - xMin) * (xMax - xMin) + (double)(yMax - yMin) * (yMax - yMin));
+
+    return (true);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationStatistics::accumulate(LAUDatasetIndex::Entry entry)
+{
+    if (entry.missing || entry.labeled == false) {
+        return;
+    }
+    entry = arrange(entry);
+
+    int fiducials = qMin(entry.xVector.count(), qMin(entry.yVector.count(), entry.zVector.count()));
+    resizeFiducials(fiducials);
+
+    // A FIDUCIAL THE FILE DOESN'T HAVE AT ALL IS NEITHER SEEN NOR HIDDEN, AND ARRANGE LEAVES IT HIDDEN FOR THE REST
+    for (int n = 0; n < fiducials; n++) {
+        if (placed(entry, n) == false) {
+            continue;
+        }
+        totalVector[n]++;
+        if (entry.zVector.at(n) != 0) {
+            visibleVector[n]++;
+        }
+    }
+
+    QVector<float> u, v;
+    float diagonal = 0.0f;
+    if (normalize(entry, &u, &v, &diagonal) == false) {
+        return;
+    }
+
+    for (int j = 0; j < fiducials; j++) {
+        if (entry.zVector.at(j) == 0) {
+            continue;
+        }
+        positionHistograms[2 * j + 0][bin(u.at(j))]++;
+        positionHistograms[2 * j + 1][bin(v.at(j))]++;
+
+        for (int i = 0; i < j; i++) {
+            if (entry.zVector.at(i) != 0) {
+                float dx = (float)(entry.xVector.at(i) - entry.xVector.at(j));
+                float dy = (float)(entry.yVector.at(i) - entry.yVector.at(j));
+                pairHistograms[pairIndex(i, j)][bin(qSqrt(dx * dx + dy * dy) / diagonal)]++;
+            }
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationStatistics::merge(const LAUAnnotationStatistics &other)
+{
+    resizeFiducials(other.visibleVector.count());
+    for (int n = 0; n < other.visibleVector.count(); n++) {
+        visibleVector[n] += other.visibleVector.at(n);
+        totalVector[n] += other.totalVector.at(n);
+    }
+    for (int n = 0; n < other.positionHistograms.count(); n++) {
+        for (int b = 0; b < LAUANNOTATIONSTATISTICSBINS; b++) {
+            positionHistograms[n][b] += other.positionHistograms.at(n).at(b);
+        }
+    }
+    for (int n = 0; n < other.pairHistograms.count(); n++) {
+        for (int b = 0; b < LAUANNOTATIONSTATISTICSBINS; b++) {
+            pairHistograms[n][b] += other.pairHistograms.at(n).at(b);
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+float LAUAnnotationStatistics::quantile(const QVector<qint64> &histogram, qint64 total, float fraction)
+{
+    // INTERPOLATE INSIDE THE BIN WHERE THE RUNNING COUNT CROSSES THE TARGET
+    double target = (double)fraction * (double)total;
+    qint64 cumulative = 0;
+    for (int b = 0; b < histogram.count(); b++) {
+        if (histogram.at(b) > 0 && (double)(cumulative + histogram.at(b)) >= target) {
+            return ((float)(((double)b + (target - (double)cumulative) / (double)histogram.at(b)) / LAUANNOTATIONSTATISTICSBINS));
+        }
+        cumulative += histogram.at(b);
+    }
+    return (1.0f);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUAnnotationStatistics::finalize()
+{
+    positionMedians.fill(0.0f, positionHistograms.count());
+    positionSigmas.fill(-1.0f, positionHistograms.count());
+    pairMedians.fill(0.0f, pairHistograms.count());
+    pairSigmas.fill(-1.0f, pairHistograms.count());
+
+    // A NEGATIVE SIGMA MEANS TOO FEW SAMPLES TO SAY WHAT IS TYPICAL, AND THE SPREAD NEVER DROPS BELOW ONE BIN
+    for (int pass = 0; pass < 2; pass++) {
+        const QVector<QVector<qint64> > &histograms = (pass == 0) ? positionHistograms : pairHistograms;
+        QVector<float> &medians = (pass == 0) ? positionMedians : pairMedians;
+        QVector<float> &sigmas = (pass == 0) ? positionSigmas : pairSigmas;
+        for (int n = 0; n < histograms.count(); n++) {
+            qint64 total = 0;
+            for (int b = 0; b < LAUANNOTATIONSTATISTICSBINS; b++) {
+                total += histograms.at(n).at(b);
+            }
+            if (total < 10) {
+                continue;
+            }
+            medians[n] = quantile(histograms.at(n), total, 0.50f);
+            float spread = quantile(histograms.at(n), total, 0.75f) - quantile(histograms.at(n), total, 0.25f);
+            sigmas[n] = qMax(spread / 1.349f, 1.0f / LAUANNOTATIONSTATISTICSBINS);
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+float LAUAnnotationStatistics::score(LAUDatasetIndex::Entry entry) const
+{
+    if (entry.missing || entry.labeled == false) {
+        return (-FLT_MAX);
+    }
+    entry = arrange(entry);
+
+    int fiducials = qMin(qMin(entry.xVector.count(), entry.yVector.count()), qMin(entry.zVector.count(), visibleVector.count()));
+
+    // A VISIBLE FIDUCIAL AT THE ORIGIN OR OFF THE IMAGE IS A CLICK THAT NEVER HAPPENED, SO IT GOES TO THE TOP OF THE LIST
+    for (int n = 0; n < fiducials; n++) {
+        int x = entry.xVector.at(n);
+        int y = entry.yVector.at(n);
+        if (entry.zVector.at(n) != 0) {
+            if ((x == 0 && y == 0) || x < 0 || y < 0 || (entry.width > 0 && x >= entry.width) || (entry.height > 0 && y >= entry.height)) {
+                return (LAUANNOTATIONSTATISTICSORIGINSCORE);
+            }
+        }
+    }
+
+    // SUM OF SQUARED ROBUST Z SCORES, WHICH IS A MAHALANOBIS DISTANCE IF WE TREAT EACH MEASUREMENT AS INDEPENDENT
+    double sum = 0.0;
+    int terms = 0;
+
+    // A FIDUCIAL HIDDEN WHEN IT IS ALMOST ALWAYS SEEN, OR THE OTHER WAY AROUND, USUALLY MEANS THE FLAG WASN'T TOGGLED
+    for (int n = 0; n < fiducials; n++) {
+        if (totalVector.at(n) > 0 && placed(entry, n)) {
+            double rate = (double)visibleVector.at(n) / (double)totalVector.at(n);
+            double probability = (entry.zVector.at(n) != 0) ? rate : 1.0 - rate;
+            if (probability < LAUANNOTATIONSTATISTICSRARE) {
+                sum += -2.0 * qLn(qMax(probability, 1.0 / (double)totalVector.at(n)));
+            }
+        }
+    }
+
+    QVector<float> u, v;
+    float diagonal = 0.0f;
+    if (normalize(entry, &u, &v, &diagonal)) {
+        for (int j = 0; j < fiducials; j++) {
+            if (entry.zVector.at(j) == 0) {
+                continue;
+            }
+            if (positionSigmas.at(2 * j + 0) > 0.0f) {
+                double z = (u.at(j) - positionMedians.at(2 * j + 0)) / positionSigmas.at(2 * j + 0);
+                sum += z * z;
+                terms++;
+            }
+            if (positionSigmas.at(2 * j + 1) > 0.0f) {
+                double z = (v.at(j) - positionMedians.at(2 * j + 1)) / positionSigmas.at(2 * j + 1);
+                sum += z * z;
+                terms++;
+            }
+
+            for (int i = 0; i < j; i++) {
+                int k = pairIndex(i, j);
+                if (entry.zVector.at(i) != 0 && pairSigmas.at(k) > 0.0f) {
+                    float dx = (float)(entry.xVector.at(i) - entry.xVector.at(j));
+                    float dy = (float)(entry.yVector.at(i) - entry.yVector.at(j));
+                    double z = (qSqrt(dx * dx + dy * dy) / diagonal - pairMedians.at(k)) / pairSigmas.at(k);
+                    sum += z * z;
+                    terms++;
+                }
+            }
+        }
+    }
+
+    // A TYPICAL ANNOTATION LANDS NEAR ZERO NO MATTER HOW MANY FIDUCIALS IT HAS
+    return ((float)((sum - terms) / qSqrt(2.0 * qMax(terms, 1))));
+}
@@ -0,0 +1,88 @@
+#ifndef LAUANNOTATIONSTATISTICS_H
+#define LAUANNOTATIONSTATISTICS_H
+
+#include <cfloat>
+
+#include <QVector>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QStringList>
+
+#include "laudatasetindex.h"
+
+#define LAUANNOTATIONSTATISTICSBINS         128
+#define LAUANNOTATIONSTATISTICSRARE         0.05f
+#define LAUANNOTATIONSTATISTICSORIGINSCORE  1000000.0f
+#define LAUANNOTATIONSTATISTICSSUSPECTS     100
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUAnnotationStatistics
+{
+public:
+    // FIDUCIALS ARE MATCHED BY THESE NAMES, SO A FILE THAT STORES THEM IN ANOTHER ORDER ISN'T MISTAKEN FOR SWAPPED CLICKS
+    explicit LAUAnnotationStatistics(QStringList fiducials = QStringList());
+
+    // FIRST PASS, HISTOGRAMS OF EVERY FIDUCIAL'S POSITION AND EVERY PAIR'S DISTANCE INSIDE THE BOX AROUND THE FIDUCIALS
+    void accumulate(LAUDatasetIndex::Entry entry);
+    void merge(const LAUAnnotationStatistics &other);
+
+    // TURN THE HISTOGRAMS INTO A MEDIAN AND A SPREAD FROM THE QUARTILES, SO THE BAD CLICKS WE ARE HUNTING DON'T SKEW THEM
+    void finalize();
+
+    // SECOND PASS, HOW FAR THE ANNOTATION SITS FROM TYPICAL, IN STANDARD DEVIATIONS OF A CHI SQUARED, -FLT_MAX IF NOT SCORED
+    float score(LAUDatasetIndex::Entry entry) const;
+
+private:
+    QStringList fiducialStrings;
+
+    QVector<qint64> visibleVector;
+    QVector<qint64> totalVector;
+
+    // TWO HISTOGRAMS PER FIDUCIAL, X THEN Y, AND ONE PER PAIR WITH PAIR (I,J), I < J, STORED AT J*(J-1)/2+I
+    QVector<QVector<qint64> > positionHistograms;
+    QVector<QVector<qint64> > pairHistograms;
+
+    QVector<float> positionMedians, positionSigmas;
+    QVector<float> pairMedians, pairSigmas;
+
+    static int pairIndex(int i, int j)
+    {
+        return (j * (j - 1) / 2 + i);
+    }
+
+    LAUDatasetIndex::Entry arrange(const LAUDatasetIndex::Entry &entry) const;
+    bool placed(const LAUDatasetIndex::Entry &entry, int fiducial) const
+    {
+        return (fiducialStrings.isEmpty() || entry.nameList.at(fiducial).isEmpty() == false);
+    }
+
+    static bool normalize(const LAUDatasetIndex::Entry &entry, QVector<float> *u, QVector<float> *v, float *diagonal);
+    static int bin(float value);
+    static float quantile(const QVector<qint64> &histogram, qint64 total, float fraction);
+    void resizeFiducials(int count);
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUAnnotationStatisticsTask : public QRunnable
+{
+public:
+    // WITH NO SCORE VECTOR THE TASK ACCUMULATES INTO STATS, OTHERWISE IT SCORES AGAINST THEM
+    LAUAnnotationStatisticsTask(LAUDatasetIndex *index, int frst, int lst, LAUAnnotationStatistics *stats, float *scores, QAtomicInt *cancel, QAtomicInt *done) : datasetIndex(index), first(frst), last(lst), statistics(stats), scoreVector(scores), cancelFlag(cancel), doneCount(done) { ; }
+
+protected:
+    void run();
+
+private:
+    LAUDatasetIndex *datasetIndex;
+    int first, last;
+    LAUAnnotationStatistics *statistics;
+    float *scoreVector;
+    QAtomicInt *cancelFlag;
+    QAtomicInt *doneCount;
+};
+
+#endif // LAUANNOTATIONSTATISTICS_H
@@ -0,0 +1,233 @@
+#include "laucocoexporter.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QTemporaryFile>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUCocoExportTask::run()
+{
+    object->format(sequence, first, last);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUCocoExporter::LAUCocoExporter(LAUDatasetIndex *index, QString filename, QStringList labels, QStringList fiducials, QString root, bool skipDuplicates, QObject *parent) : QThread(parent), datasetIndex(index), fileString(filename), labelStrings(labels), fiducialStrings(fiducials), rootString(root), skipDuplicatesFlag(skipDuplicates), doneCount(0), annotationCount(0), okayFlag(false), quitFlag(false)
+{
+    threadPool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+    start(QThread::LowPriority);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUCocoExporter::~LAUCocoExporter()
+{
+    cancel();
+    wait();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUCocoExporter::cancel()
+{
+    QMutexLocker locker(&mutex);
+    quitFlag = true;
+    chunkCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QByteArray LAUCocoExporter::quote(QString string)
+{
+    QByteArray byteArray("\"");
+    QByteArray utf8 = string.toUtf8();
+    for (int n = 0; n < utf8.length(); n++) {
+        char c = utf8.at(n);
+        if (c == '"' || c == '\\') {
+            byteArray.append('\\').append(c);
+        } else if ((unsigned char)c < 0x20) {
+            byteArray.append(QString("\\u%1").arg((int)c, 4, 16, QChar('0')).toLatin1());
+        } else {
+            byteArray.append(c);
+        }
+    }
+    byteArray.append('"');
+    return (byteArray);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUCocoExporter::format(int sequence, int first, int last)
+{
+    Chunk chunk;
+    chunk.count = 0;
+
+    QDir rootDir(rootString);
+    for (int n = first; n < last; n++) {
+        mutex.lock();
+        bool quit = quitFlag;
+        mutex.unlock();
+        if (quit) {
+            break;
+        }
+
+        // ONLY LABELED IMAGES GO IN, AND ONLY THE FIRST OF A RUN OF NEAR DUPLICATES IF WE ARE SKIPPING THEM
+        // FIDUCIALS ARE MATCHED BY NAME SINCE OLDER FILES STORE THEM IN A ROTATED ORDER
+        LAUDatasetIndex::Entry entry = LAUDatasetIndex::arrange(datasetIndex->entry(n), fiducialStrings);
+        if (entry.missing || entry.labeled == false || entry.classIndex < 0 || entry.classIndex >= labelStrings.count()) {
+            continue;
+        } else if (skipDuplicatesFlag && datasetIndex->isDuplicate(n)) {
+            continue;
+        }
+
+        // ONE POSE PER IMAGE, SO THE ANNOTATION SHARES THE IMAGE'S ID AND NOTHING HAS TO BE COUNTED ACROSS BLOCKS
+        int id = n + 1;
+        QString filename = datasetIndex->filename(n);
+        filename = (rootString.isEmpty()) ? QFileInfo(filename).absoluteFilePath() : rootDir.relativeFilePath(filename);
+        chunk.images.append(QString(",\n{\"id\":%1,\"file_name\":").arg(id).toUtf8());
+        chunk.images.append(quote(filename));
+        chunk.images.append(QString(",\"width\":%1,\"height\":%2}").arg(entry.width).arg(entry.height).toUtf8());
+
+        // PAD THE BOX AROUND THE FIDUCIALS THE SAME WAY THE YOLO EXPORT DOES, THEN KEEP IT ON THE IMAGE
+        int xMin = entry.width, xMax = 0, yMin = entry.height, yMax = 0, visible = 0;
+        QByteArray keypoints;
+        for (int m = 0; m < fiducialStrings.count(); m++) {
+            if (m > 0) {
+                keypoints.append(',');
+            }
+            if (entry.nameList.at(m).isEmpty() == false) {
+                // COCO VISIBILITY IS 2 FOR VISIBLE AND 1 FOR PLACED BUT HIDDEN
+                int x = entry.xVector.at(m);
+                int y = entry.yVector.at(m);
+                int v = (entry.zVector.at(m) != 0) ? 2 : 1;
+                keypoints.append(QString("%1,%2,%3").arg(x).arg(y).arg(v).toUtf8());
+                xMin = qMin(xMin, x - LAUCOCOEXPORTERPADDING);
+                xMax = qMax(xMax, x + LAUCOCOEXPORTERPADDING);
+                yMin = qMin(yMin, y - LAUCOCOEXPORTERPADDING);
+                yMax = qMax(yMax, y + LAUCOCOEXPORTERPADDING);
+                visible += (v == 2);
+            } else {
+                keypoints.append("0,0,0");
+            }
+        }
+        xMin = qMax(0, xMin);
+        yMin = qMax(0, yMin);
+        xMax = qMin(entry.width, xMax);
+        yMax = qMin(entry.height, yMax);
+        int width = qMax(0, xMax - xMin);
+        int height = qMax(0, yMax - yMin);
+
+        chunk.annotations.append(QString(",\n{\"id\":%1,\"image_id\":%1,\"category_id\":%2,\"iscrowd\":0,\"bbox\":[%3,%4,%5,%6],\"area\":%7,\"num_keypoints\":%8,\"keypoints\":[").arg(id).arg(entry.classIndex + 1).arg(xMin).arg(yMin).arg(width).arg(height).arg((qint64)width * height).arg(visible).toUtf8());
+        chunk.annotations.append(keypoints);
+        chunk.annotations.append("]");
+        if (entry.confidence >= 0.0f) {
+            chunk.annotations.append(QString(",\"score\":%1").arg(entry.confidence, 0, 'f', 4).toUtf8());
+        }
+        chunk.annotations.append("}");
+        chunk.count++;
+    }
+
+    QMutexLocker locker(&mutex);
+    chunks[sequence] = chunk;
+    doneCount += last - first;
+    chunkCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUCocoExporter::run()
+{
+    // IMAGES GO STRAIGHT INTO THE OUTPUT WHILE ANNOTATIONS WAIT IN A SCRATCH FILE, SO ONE PASS FILLS BOTH ARRAYS
+    QSaveFile file(fileString);
+    QTemporaryFile scratchFile(QString("%1/XXXXXX.annotations").arg(QFileInfo(fileString).absolutePath()));
+    if (file.open(QIODevice::WriteOnly) == false || scratchFile.open() == false) {
+        return;
+    }
+
+    file.write("{\n\"info\":{\"description\":\"LAUYoloPoseLabeler\",\"date_created\":");
+    file.write(quote(QDateTime::currentDateTime().toString(Qt::ISODate)));
+    file.write("},\n\"licenses\":[],\n\"categories\":[");
+    QByteArray names;
+    for (int n = 0; n < fiducialStrings.count(); n++) {
+        names.append((n > 0) ? "," : "").append(quote(fiducialStrings.at(n)));
+    }
+    for (int n = 0; n < labelStrings.count(); n++) {
+        file.write(QString("%1\n{\"id\":%2,\"name\":").arg((n > 0) ? "," : "").arg(n + 1).toUtf8());
+        file.write(quote(labelStrings.at(n)));
+        file.write(",\"supercategory\":");
+        file.write(quote(labelStrings.at(n)));
+        file.write(",\"keypoints\":[");
+        file.write(names);
+        file.write("],\"skeleton\":[]}");
+    }
+    file.write("],\n\"images\":[");
+
+    int count = datasetIndex->count();
+    int blocks = (count + LAUCOCOEXPORTERBLOCKSIZE - 1) / LAUCOCOEXPORTERBLOCKSIZE;
+    int window = 2 * threadPool.maxThreadCount();
+    int dispatched = 0;
+    int written = 0;
+    bool firstImageFlag = true;
+    bool firstAnnotationFlag = true;
+    bool quit = false;
+    while (written < blocks) {
+        while (dispatched < blocks && dispatched - written < window) {
+            int first = dispatched * LAUCOCOEXPORTERBLOCKSIZE;
+            threadPool.start(new LAUCocoExportTask(this, dispatched++, first, qMin(first + LAUCOCOEXPORTERBLOCKSIZE, count)));
+        }
+
+        mutex.lock();
+        while (chunks.contains(written) == false && quitFlag == false) {
+            chunkCondition.wait(&mutex);
+        }
+        quit = quitFlag;
+        Chunk chunk = chunks.take(written++);
+        mutex.unlock();
+        if (quit) {
+            break;
+        }
+
+        // EVERY OBJECT IS FORMATTED WITH A LEADING COMMA, WHICH THE VERY FIRST ONE IN EACH ARRAY HAS TO LOSE
+        if (chunk.images.isEmpty() == false) {
+            file.write(chunk.images.mid((firstImageFlag) ? 1 : 0));
+            scratchFile.write(chunk.annotations.mid((firstAnnotationFlag) ? 1 : 0));
+            firstImageFlag = false;
+            firstAnnotationFlag = false;
+        }
+
+        mutex.lock();
+        annotationCount += chunk.count;
+        mutex.unlock();
+    }
+
+    threadPool.clear();
+    threadPool.waitForDone();
+    if (quit) {
+        file.cancelWriting();
+        return;
+    }
+
+    // COPY THE ANNOTATIONS ACROSS A MEGABYTE AT A TIME
+    file.write("\n],\n\"annotations\":[");
+    scratchFile.seek(0);
+    while (scratchFile.atEnd() == false) {
+        file.write(scratchFile.read(1024 * 1024));
+    }
+    file.write("\n]\n}\n");
+
+    bool flag = file.commit();
+
+    QMutexLocker locker(&mutex);
+    okayFlag = flag;
+}
@@ -0,0 +1,105 @@
+#ifndef LAUCOCOEXPORTER_H
+#define LAUCOCOEXPORTER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QObject>
+#include <QRunnable>
+#include <QByteArray>
+#include <QThreadPool>
+#include <QStringList>
+#include <QWaitCondition>
+
+#include "laudatasetindex.h"
+
+#define LAUCOCOEXPORTERBLOCKSIZE    1024
+#define LAUCOCOEXPORTERPADDING      20
+
+class LAUCocoExporter;
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUCocoExportTask : public QRunnable
+{
+public:
+    LAUCocoExportTask(LAUCocoExporter *obj, int seq, int frst, int lst) : object(obj), sequence(seq), first(frst), last(lst) { ; }
+
+protected:
+    void run();
+
+private:
+    LAUCocoExporter *object;
+    int sequence;
+    int first, last;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUCocoExporter : public QThread
+{
+    Q_OBJECT
+
+public:
+    // FILE NAMES IN THE JSON ARE RELATIVE TO ROOT, OR ABSOLUTE IF ROOT IS EMPTY
+    explicit LAUCocoExporter(LAUDatasetIndex *index, QString filename, QStringList labels, QStringList fiducials, QString root = QString(), bool skipDuplicates = false, QObject *parent = nullptr);
+    ~LAUCocoExporter();
+
+    // IMAGES LOOKED AT SO FAR, OUT OF HOWEVER MANY THE INDEX HELD WHEN WE STARTED
+    int progress() const
+    {
+        QMutexLocker locker(&mutex);
+        return (doneCount);
+    }
+
+    int annotations() const
+    {
+        QMutexLocker locker(&mutex);
+        return (annotationCount);
+    }
+
+    bool isOkay() const
+    {
+        QMutexLocker locker(&mutex);
+        return (okayFlag);
+    }
+
+    void cancel();
+
+    // THIS METHOD IS CALLED FROM THE WORKER THREADS
+    void format(int sequence, int first, int last);
+
+    static QByteArray quote(QString string);
+
+protected:
+    void run();
+
+private:
+    typedef struct {
+        QByteArray images;
+        QByteArray annotations;
+        int count;
+    } Chunk;
+
+    LAUDatasetIndex *datasetIndex;
+    QString fileString;
+    QStringList labelStrings;
+    QStringList fiducialStrings;
+    QString rootString;
+    bool skipDuplicatesFlag;
+
+    // BLOCKS ARE FORMATTED IN PARALLEL BUT WRITTEN IN ORDER, WITH ONLY A FEW OF THEM HELD IN MEMORY AT ONCE
+    QThreadPool threadPool;
+    QHash<int, Chunk> chunks;
+
+    mutable QMutex mutex;
+    QWaitCondition chunkCondition;
+    int doneCount;
+    int annotationCount;
+    bool okayFlag;
+    bool quitFlag;
+};
+
+#endif // LAUCOCOEXPORTER_H
@@ -0,0 +1,356 @@
+#include "laucommandline.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QCommandLineParser>
+
+#include "lauimage.h"
+#include "laudatasetindex.h"
+#include "laudirectorywalker.h"
+#include "laudeepnetworkobject.h"
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUCommandLine::LAUCommandLine(QStringList arguments) : argumentStrings(arguments), lastProgress(-LAUCOMMANDLINEPROGRESSMSEC)
+{
+    ;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUCommandLine::exec()
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QString("Batch actions of the labeler, run without a window."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QString("command"), commands().join(", "));
+    parser.addOption(QCommandLineOption(QStringList() << "i" << "input", QString("Directory of images to read."), QString("directory")));
+    parser.addOption(QCommandLineOption(QStringList() << "o" << "output", QString("Directory to write into."), QString("directory")));
+    parser.addOption(QCommandLineOption(QStringList() << "val-every", QString("Training images for each validation image."), QString("count"), QString("1")));
+    parser.addOption(QCommandLineOption(QStringList() << "skip-duplicates", QString("Export only the first frame of each run of near duplicates.")));
+    parser.addOption(QCommandLineOption(QStringList() << "model", QString("ONNX pose model to validate."), QString("file")));
+    parser.addOption(QCommandLineOption(QStringList() << "threshold", QString("Confidence a prediction needs to be kept."), QString("value"), QString("0.70")));
+
+    commandString = argumentStrings.value(1);
+    if (parser.parse(argumentStrings) == false) {
+        return (fail(parser.errorText()));
+    } else if (parser.isSet(QString("help"))) {
+        QTextStream(stdout) << parser.helpText();
+        return (0);
+    }
+
+    QString inputDirectoryString = parser.value(QString("input"));
+    QString outputDirectoryString = parser.value(QString("output"));
+    if (inputDirectoryString.isEmpty() || QDir(inputDirectoryString).exists() == false) {
+        return (fail(QString("An existing input directory is required.")));
+    } else if (outputDirectoryString.isEmpty()) {
+        return (fail(QString("An output directory is required.")));
+    }
+
+    timer.start();
+    if (commandString == QString("export-pose") || commandString == QString("export-classify")) {
+        bool okay = false;
+        int numImages = parser.value(QString("val-every")).toInt(&okay);
+        if (okay == false || numImages < 1) {
+            return (fail(QString("--val-every needs a positive integer.")));
+        }
+        LAUPoseExporter::ExportMode mode = (commandString == QString("export-pose")) ? LAUPoseExporter::ExportPose : LAUPoseExporter::ExportClassify;
+        return (exportDataset(mode, inputDirectoryString, outputDirectoryString, numImages + 1, parser.isSet(QString("skip-duplicates"))));
+    } else if (commandString == QString("validate")) {
+        bool okay = false;
+        float threshold = parser.value(QString("threshold")).toFloat(&okay);
+        if (okay == false) {
+            return (fail(QString("--threshold needs a number.")));
+        }
+        return (validate(inputDirectoryString, outputDirectoryString, parser.value(QString("model")), threshold));
+    } else if (commandString == QString("sort-by-class")) {
+        return (sortByClass(inputDirectoryString, outputDirectoryString));
+    }
+    return (fail(QString("Unknown command %1, expected one of %2.").arg(commandString).arg(commands().join(", "))));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUCommandLine::print(QJsonObject object)
+{
+    object.insert(QString("command"), commandString);
+    object.insert(QString("elapsed"), (double)timer.elapsed() / 1000.0);
+
+    QTextStream stream(stdout);
+    stream << QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact)) << "\n";
+    stream.flush();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUCommandLine::progress(int done, int total, bool force)
+{
+    // THROTTLED SO A FAST WALK DOESN'T DROWN WHOEVER IS READING
+    if (force == false && timer.elapsed() - lastProgress < LAUCOMMANDLINEPROGRESSMSEC) {
+        return;
+    }
+    lastProgress = timer.elapsed();
+
+    QJsonObject object;
+    object.insert(QString("event"), QString("progress"));
+    object.insert(QString("done"), done);
+    object.insert(QString("total"), total);
+    print(object);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUCommandLine::finish(bool okay, QJsonObject object)
+{
+    object.insert(QString("event"), QString("finished"));
+    object.insert(QString("status"), (okay) ? QString("ok") : QString("error"));
+    print(object);
+    return ((okay) ? 0 : 1);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUCommandLine::fail(QString message)
+{
+    QTextStream(stderr) << message << "\n";
+
+    QJsonObject object;
+    object.insert(QString("message"), message);
+    return (finish(false, object));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseAnnotation LAUCommandLine::findAnnotation(QString directory)
+{
+    // ONLY THE XML PACKET IS READ, AND THE WALK STOPS AT THE FIRST ONE THAT NAMES ITS FIDUCIALS
+    LAUDirectoryWalker walker(QStringList() << directory, QStringList() << "*.tif" << "*.tiff", static_cast<LAUDatasetIndex *>(nullptr));
+    QString string;
+    while (walker.next(&string)) {
+        QByteArray xml = LAUImage::readXmlPacket(string);
+        if (xml.isEmpty() == false) {
+            LAUPoseAnnotation annotation = LAUPoseAnnotation::fromXml(xml);
+            if (annotation.fiducials() > 0) {
+                return (annotation);
+            }
+        }
+    }
+    return (LAUPoseAnnotation());
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUCommandLine::exportDataset(LAUPoseExporter::ExportMode mode, QString inputDirectoryString, QString outputDirectoryString, int numImages, bool skipDuplicates)
+{
+    LAUPoseAnnotation annotation = findAnnotation(inputDirectoryString);
+    if (annotation.fiducials() == 0) {
+        return (fail(QString("No labeled images found in %1.").arg(inputDirectoryString)));
+    }
+
+    // THE SAME ENGINE THE MENU ACTION USES, POLLED INSTEAD OF WATCHED THROUGH A PROGRESS DIALOG
+    LAUPoseExporter exporter(inputDirectoryString, outputDirectoryString, annotation, numImages, skipDuplicates, mode);
+    while (exporter.wait(100) == false) {
+        progress(exporter.progress(), exporter.count());
+    }
+    progress(exporter.progress(), exporter.count(), true);
+
+    QJsonObject object;
+    object.insert(QString("images"), exporter.count());
+    object.insert(QString("exported"), exporter.exported());
+    object.insert(QString("failed"), exporter.failed());
+    object.insert(QString("unchanged"), exporter.unchanged());
+    object.insert(QString("removed"), exporter.removed());
+    return (finish(exporter.isOkay(), object));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUCommandLine::sortByClass(QString inputDirectoryString, QString outputDirectoryString)
+{
+    LAUPoseAnnotation annotation = findAnnotation(inputDirectoryString);
+    if (annotation.fiducials() == 0) {
+        return (fail(QString("No labeled images found in %1.").arg(inputDirectoryString)));
+    }
+
+    // ONE FOLDER PER CLASS, NAMED AFTER THE CLASS
+    QStringList labels = annotation.labels();
+    QList<QDir> classDirs;
+    for (int n = 0; n < labels.count(); n++) {
+        classDirs << QDir(QString("%1/%2").arg(outputDirectoryString).arg(labels.at(n)));
+        if (classDirs.last().exists() == false && classDirs.last().mkpath(classDirs.last().absolutePath()) == false) {
+            return (fail(QString("Unable to create %1.").arg(classDirs.last().absolutePath())));
+        }
+    }
+
+    // THE INDEX ALREADY KNOWS EVERY IMAGE'S CLASS, SO FILES ARE COPIED BYTE FOR BYTE WITHOUT DECODING A PIXEL
+    LAUDatasetIndex labelIndex(QStringList(), LAUDatasetIndex::defaultFilename(QStringList() << inputDirectoryString));
+    LAUDirectoryWalker walker(QStringList() << inputDirectoryString, QStringList() << "*.tif" << "*.tiff", &labelIndex);
+
+    int sortedCount = 0;
+    int failedCount = 0;
+    QString string;
+    int n = 0;
+    for (; walker.next(&string); n++) {
+        progress(n, walker.count());
+
+        LAUDatasetIndex::Entry entry = labelIndex.entry(n);
+        if (entry.labeled == false || entry.classIndex < 0 || entry.classIndex >= classDirs.count()) {
+            continue;
+        }
+
+        QString fileString = QString("%1/%2").arg(classDirs.at(entry.classIndex).absolutePath()).arg(QFileInfo(string).fileName());
+        if (QFile::exists(fileString)) {
+            QFile::remove(fileString);
+        }
+        if (QFile::copy(string, fileString)) {
+            sortedCount++;
+        } else {
+            failedCount++;
+        }
+    }
+    progress(n, n, true);
+
+    QJsonObject object;
+    object.insert(QString("images"), n);
+    object.insert(QString("sorted"), sortedCount);
+    object.insert(QString("failed"), failedCount);
+    return (finish(failedCount == 0, object));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUCommandLine::validate(QString inputDirectoryString, QString outputDirectoryString, QString modelString, float threshold)
+{
+    // AN EMPTY FILE NAME WOULD MAKE THE NETWORK ASK FOR ONE WITH A DIALOG
+    if (modelString.isEmpty() || QFileInfo::exists(modelString) == false) {
+        return (fail(QString("An existing ONNX model is required.")));
+    }
+
+    LAUYoloPoseObject poseNetwork(modelString);
+    if (poseNetwork.isValid() == false) {
+        return (fail(QString("Unable to load %1.").arg(modelString)));
+    }
+
+    LAUPoseAnnotation annotation = findAnnotation(inputDirectoryString);
+    if (annotation.fiducials() == 0) {
+        return (fail(QString("No labeled images found in %1.").arg(inputDirectoryString)));
+    }
+
+    // ONE FOLDER PER CLASS FOR THE PREDICTIONS, PLUS ONE FOR IMAGES WHOSE SAVED CLASS DISAGREES WITH THE MODEL
+    QStringList labels = annotation.labels();
+    QList<QDir> dirs;
+    for (int n = 0; n < labels.count(); n++) {
+        dirs << QDir(QString("%1/%2").arg(outputDirectoryString).arg(labels.at(n)));
+    }
+    dirs << QDir(QString("%1/%2").arg(outputDirectoryString).arg("errors"));
+    for (int n = 0; n < dirs.count(); n++) {
+        if (dirs.at(n).exists() == false && dirs.at(n).mkpath(dirs.at(n).absolutePath()) == false) {
+            return (fail(QString("Unable to create %1.").arg(dirs.at(n).absolutePath())));
+        }
+    }
+    QDir errorDir = dirs.takeLast();
+
+    LAUDirectoryWalker walker(QStringList() << inputDirectoryString, LAUDirectoryWalker::imageFilters(), static_cast<LAUDatasetIndex *>(nullptr));
+
+    int labeledCount = 0;
+    int errorCount = 0;
+    QString string;
+    int n = 0;
+    for (; walker.next(&string); n++) {
+        progress(n, walker.count());
+
+        LAUImage image(string);
+        LAUPoseAnnotation prediction = annotation;
+        prediction.setXml(image.xmlData());
+        prediction.setImageSize(image.width(), image.height());
+
+        QList<LAUMemoryObject> objects = poseNetwork.process(image);
+        if (objects.isEmpty()) {
+            continue;
+        }
+
+        // THE MOST CONFIDENT CLASS WINS, BUT EVERY CLASS'S CONFIDENCE GOES INTO THE FILE NAMES BELOW SO EACH FOLDER SORTS BY IT
+        int classes = qMin(poseNetwork.classes(), labels.count());
+        QVector<float> confidences(classes, 0.0f);
+        QList<QList<QVector3D> > points;
+        int best = -1;
+        for (int c = 0; c < classes; c++) {
+            confidences[c] = threshold;
+            points << poseNetwork.points(c, &confidences[c]);
+            if (best < 0 || confidences.at(c) > confidences.at(best)) {
+                best = c;
+            }
+        }
+        if (best < 0 || confidences.at(best) <= threshold) {
+            continue;
+        }
+
+        bool errorFlag = (image.xmlData().isEmpty() == false && prediction.classIndex() != best);
+        prediction.setClassIndex(best);
+        for (int f = 0; f < prediction.fiducials(); f++) {
+#ifdef ZOOMINTOHEAD
+            if (f < 6 || f > 11) {
+                continue;
+            }
+            QVector3D point = points.at(best).value(f - 4);
+#else
+            QVector3D point = points.at(best).value(f + 2);
+#endif
+            prediction.setFiducial(f, qRound(point.x()), qRound(point.y()), (point.z() > 0.5));
+        }
+
+        QStringList confidenceStrings;
+        for (int c = 0; c < classes; c++) {
+            QString confidenceString = QString("%1").arg(qRound(confidences.at(c) * 10000 + n));
+            while (confidenceString.length() < 4) {
+                confidenceString.prepend("0");
+            }
+            confidenceStrings << confidenceString;
+        }
+        QString fileString = QFileInfo(string).fileName().right(9);
+
+        // SAVE THE IMAGE TO THE ERROR FOLDER BEFORE ITS XML FIELD BECOMES THE MODEL OUTPUT
+        if (errorFlag) {
+            QString errorString = QString("%1/error_%2_%3").arg(errorDir.absolutePath()).arg(confidenceStrings.join("_")).arg(fileString);
+            if (LAUImage::copyWithXmlPacket(string, errorString, image.xmlData()) == false) {
+                image.save(errorString);
+            }
+            errorCount++;
+        }
+
+        // COPY THE FILE AND REWRITE ITS XML PACKET RATHER THAN RE-ENCODING EVERY PIXEL
+        prediction.setConfidence(confidences.at(best));
+        QByteArray xml = prediction.xml();
+        for (int c = 0; c < classes; c++) {
+            QStringList ordered = confidenceStrings;
+            ordered.move(c, 0);
+            QString labelString = QString("%1/%2_%3_%4").arg(dirs.at(c).absolutePath()).arg(labels.at(c)).arg(ordered.join("_")).arg(fileString);
+            if (LAUImage::copyWithXmlPacket(string, labelString, xml) == false) {
+                image.setXmlData(xml);
+                image.save(labelString);
+            }
+        }
+        labeledCount++;
+    }
+    progress(n, n, true);
+
+    QJsonObject object;
+    object.insert(QString("images"), n);
+    object.insert(QString("labeled"), labeledCount);
+    object.insert(QString("errors"), errorCount);
+    return (finish(true, object));
+}
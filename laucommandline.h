@@ -0,0 +1,56 @@
+#ifndef LAUCOMMANDLINE_H
+#define LAUCOMMANDLINE_H
+
+#include <QString>
+#include <QJsonObject>
+#include <QStringList>
+#include <QElapsedTimer>
+
+#include "lauposeannotation.h"
+#include "lauposeexporter.h"
+
+#define LAUCOMMANDLINEPROGRESSMSEC  500
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUCommandLine
+{
+public:
+    // ARGUMENTS AS QCOREAPPLICATION HANDS THEM OVER, PROGRAM NAME FIRST AND THE SUBCOMMAND SECOND
+    LAUCommandLine(QStringList arguments);
+
+    static QStringList commands()
+    {
+        return (QStringList() << "export-pose" << "export-classify" << "validate" << "sort-by-class");
+    }
+
+    static bool isCommand(QString string)
+    {
+        return (commands().contains(string));
+    }
+
+    // RUNS THE SUBCOMMAND TO COMPLETION WITHOUT AN EVENT LOOP, RETURNING THE PROCESS EXIT CODE
+    int exec();
+
+private:
+    QStringList argumentStrings;
+    QString commandString;
+    QElapsedTimer timer;
+    qint64 lastProgress;
+
+    int exportDataset(LAUPoseExporter::ExportMode mode, QString inputDirectoryString, QString outputDirectoryString, int numImages, bool skipDuplicates);
+    int validate(QString inputDirectoryString, QString outputDirectoryString, QString modelString, float threshold);
+    int sortByClass(QString inputDirectoryString, QString outputDirectoryString);
+
+    // ONE JSON OBJECT PER LINE ON STDOUT SO SCRIPTS CAN FOLLOW ALONG
+    void progress(int done, int total, bool force = false);
+    int finish(bool okay, QJsonObject object = QJsonObject());
+    int fail(QString message);
+    void print(QJsonObject object);
+
+    // CLASS AND FIDUCIAL NAMES COME FROM THE FIRST LABELED IMAGE, SINCE THERE IS NO PALETTE TO ASK
+    static LAUPoseAnnotation findAnnotation(QString directory);
+};
+
+#endif // LAUCOMMANDLINE_H
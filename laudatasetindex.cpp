@@ -0,0 +1,656 @@
+#include "laudatasetindex.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QXmlStreamReader>
+#include <QCryptographicHash>
+
+#include <algorithm>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndexTask::run()
+{
+    object->scan(first, last);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDatasetIndex::LAUDatasetIndex(QStringList strings, QString filename, QObject *parent) : QThread(parent), indexFilename(filename), skipDuplicatesFlag(false), missingCount(0), quitFlag(false), dirtyFlag(false)
+{
+    // READ BACK WHAT THE LAST SESSION LEARNED BEFORE THE SCAN STARTS
+    load();
+    append(strings);
+
+    // FILL IN THE TABLE IN THE BACKGROUND, LOOKUPS THAT GET AHEAD OF US READ THE HEADER THEMSELVES
+    start(QThread::LowPriority);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDatasetIndex::~LAUDatasetIndex()
+{
+    mutex.lock();
+    quitFlag = true;
+    queueCondition.wakeAll();
+    mutex.unlock();
+
+    wait();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QString LAUDatasetIndex::defaultFilename(QStringList directories)
+{
+    // THE SAME ROOTS IN ANY ORDER MAP TO THE SAME FILE
+    QStringList strings;
+    for (int n = 0; n < directories.count(); n++) {
+        strings << QDir(directories.at(n)).absolutePath();
+    }
+    strings.sort();
+
+    QByteArray hash = QCryptographicHash::hash(strings.join("\n").toUtf8(), QCryptographicHash::Md5).toHex();
+    return (QString("%1/datasets/%2.index").arg(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).arg(QString::fromLatin1(hash)));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDatasetIndex::Entry LAUDatasetIndex::emptyEntry()
+{
+    Entry entry;
+    entry.scanned = false;
+    entry.missing = false;
+    entry.labeled = false;
+    entry.classIndex = -1;
+    entry.confidence = -1.0f;
+    entry.bytes = -1;
+    entry.modified = -1;
+    entry.width = 0;
+    entry.height = 0;
+    entry.hashed = false;
+    entry.hash = 0;
+
+    return (entry);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::append(QStringList strings)
+{
+    Entry entry = emptyEntry();
+
+    QMutexLocker locker(&mutex);
+    for (int n = 0; n < strings.count(); n++) {
+        indexHash[strings.at(n)] = fileStrings.count();
+        fileStrings << strings.at(n);
+        entries << entry;
+    }
+    queueCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDatasetIndex::Entry LAUDatasetIndex::entry(int index)
+{
+    mutex.lock();
+    Entry entry = entries.at(index);
+    QString string = fileStrings.at(index);
+    mutex.unlock();
+
+    if (entry.scanned == false) {
+        // STAT THE FILE BEFORE READING IT SO A WRITE IN BETWEEN LEAVES US WITH A STALE TIME STAMP, NOT STALE LABELS
+        QFileInfo fileInfo(string);
+        qint64 bytes = fileInfo.size();
+        qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+        mutex.lock();
+        Entry stored = storedEntries.value(string, emptyEntry());
+        mutex.unlock();
+
+        bool readFlag = false;
+        if (fileInfo.exists() == false) {
+            entry = emptyEntry();
+            entry.scanned = true;
+            entry.missing = true;
+        } else if (stored.scanned && stored.bytes == bytes && stored.modified == modified) {
+            entry = stored;
+        } else {
+            QSize size;
+            entry = parse(LAUImage::readXmlPacket(string, &size));
+            entry.bytes = bytes;
+            entry.modified = modified;
+            entry.width = size.width();
+            entry.height = size.height();
+            readFlag = true;
+
+            // AN ENTRY WE UPDATED OURSELVES ONLY HAD ITS TAGS REWRITTEN, SO THE PIXELS AND THEIR HASH ARE STILL GOOD
+            if (stored.scanned && stored.bytes < 0 && stored.width == entry.width && stored.height == entry.height) {
+                entry.hashed = stored.hashed;
+                entry.hash = stored.hash;
+            }
+        }
+
+        // DON'T CLOBBER AN UPDATE THAT CAME IN WHILE WE WERE READING THE FILE
+        QMutexLocker locker(&mutex);
+        if (entries.at(index).scanned) {
+            return (entries.at(index));
+        }
+        replace(index, entry);
+        dirtyFlag = dirtyFlag || readFlag;
+    }
+    return (entry);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::scan(int first, int last)
+{
+    for (int n = first; n < last; n++) {
+        mutex.lock();
+        bool quit = quitFlag;
+        bool scanned = (quit == false) && entries.at(n).scanned;
+        mutex.unlock();
+
+        if (quit) {
+            return;
+        } else if (scanned == false) {
+            entry(n);
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::update(int index, QByteArray xml)
+{
+    Entry entry = parse(xml);
+
+    // THE PIXELS DON'T CHANGE, BUT THE WRITER IS ABOUT TO GIVE THE FILE A NEW TIME STAMP SO THE NEXT SESSION RE-READS IT
+    QMutexLocker locker(&mutex);
+    entry.width = entries.at(index).width;
+    entry.height = entries.at(index).height;
+    entry.hashed = entries.at(index).hashed;
+    entry.hash = entries.at(index).hash;
+    replace(index, entry);
+    dirtyFlag = true;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::rescan(int index)
+{
+    // THE BACKGROUND THREAD READS THE HEADER AGAIN, AS DOES ANY LOOKUP THAT GETS THERE FIRST
+    QMutexLocker locker(&mutex);
+    updateLists(index, entries.at(index), false);
+    entries[index].scanned = false;
+    rescanList << index;
+    queueCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::setMissing(int index)
+{
+    QMutexLocker locker(&mutex);
+    Entry entry = emptyEntry();
+    entry.scanned = true;
+    entry.missing = true;
+    replace(index, entry);
+    dirtyFlag = true;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::setHash(int index, quint64 hash)
+{
+    QMutexLocker locker(&mutex);
+    entries[index].hashed = true;
+    entries[index].hash = hash;
+    dirtyFlag = true;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::setDuplicates(QVector<int> representatives)
+{
+    // FILES APPENDED AFTER THIS ARE NEVER TREATED AS DUPLICATES UNTIL THE NEXT CALL
+    QMutexLocker locker(&mutex);
+    duplicateVector = representatives;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::setSkipDuplicates(bool state)
+{
+    QMutexLocker locker(&mutex);
+    skipDuplicatesFlag = state;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::setSuspects(QList<int> suspects)
+{
+    // EACH FILE'S PLACE IN THE LIST, OR -1 IF IT ISN'T ON IT
+    QMutexLocker locker(&mutex);
+    suspectList = suspects;
+    suspectRanks.fill(-1, fileStrings.count());
+    for (int n = 0; n < suspects.count(); n++) {
+        if (suspects.at(n) >= 0 && suspects.at(n) < suspectRanks.count()) {
+            suspectRanks[suspects.at(n)] = n;
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::replace(int index, Entry entry)
+{
+    // CALLER HOLDS THE MUTEX
+    if (entries.at(index).missing != entry.missing) {
+        missingCount += (entry.missing) ? 1 : -1;
+    }
+    intern(&entry);
+    updateLists(index, entries.at(index), false);
+    updateLists(index, entry, true);
+    entries[index] = entry;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::updateLists(int index, const Entry &entry, bool insert)
+{
+    // CALLER HOLDS THE MUTEX, AND ONLY SCANNED FILES THAT ARE STILL ON DISK ARE LISTED
+    if (entry.scanned == false || entry.missing) {
+        return;
+    }
+
+    QList<QVector<int> *> lists;
+    if (entry.labeled == false) {
+        lists << &unlabeledList;
+    } else {
+        if (entry.classIndex >= 0) {
+            lists << &classLists[entry.classIndex];
+        }
+        if (entry.confidence >= 0.0f && entry.confidence < LAUDATASETINDEXLOWCONFIDENCE) {
+            lists << &lowConfidenceList;
+        }
+    }
+
+    for (int n = 0; n < lists.count(); n++) {
+        QVector<int> *list = lists.at(n);
+        QVector<int>::iterator iterator = std::lower_bound(list->begin(), list->end(), index);
+        bool found = (iterator != list->end() && *iterator == index);
+        if (insert && found == false) {
+            list->insert(iterator, index);
+        } else if (insert == false && found) {
+            list->erase(iterator);
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUDatasetIndex::skipped(int index) const
+{
+    // CALLER HOLDS THE MUTEX
+    if (entries.at(index).missing) {
+        return (true);
+    }
+    return (skipDuplicatesFlag && index < duplicateVector.count() && duplicateVector.at(index) != index);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::intern(Entry *entry)
+{
+    // CALLER HOLDS THE MUTEX
+    if (entry->nameList.isEmpty()) {
+        return;
+    }
+
+    QString key = entry->nameList.join(QChar('\n'));
+    QHash<QString, QStringList>::const_iterator iterator = nameHash.constFind(key);
+    if (iterator == nameHash.constEnd()) {
+        nameHash.insert(key, entry->nameList);
+    } else {
+        entry->nameList = iterator.value();
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUDatasetIndex::matches(int index, Filter filter, int classIndex)
+{
+    // FILES THAT WERE DELETED UNDER US NEVER PASS, NOR DO NEAR DUPLICATES ONCE WE ARE ASKED TO SKIP THEM
+    QMutexLocker locker(&mutex);
+    if (skipped(index)) {
+        return (false);
+    }
+
+    const Entry &entry = entries.at(index);
+    switch (filter) {
+        case FilterAll:
+            return (true);
+        case FilterSuspect:
+            return (index < suspectRanks.count() && suspectRanks.at(index) >= 0);
+        case FilterUnlabeled:
+            return (entry.scanned && entry.labeled == false);
+        case FilterClass:
+            return (entry.scanned && entry.labeled && entry.classIndex == classIndex);
+        case FilterLowConfidence:
+            return (entry.scanned && entry.labeled && entry.confidence >= 0.0f && entry.confidence < LAUDATASETINDEXLOWCONFIDENCE);
+        default:
+            return (true);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUDatasetIndex::next(int index, int step, Filter filter, int classIndex)
+{
+    QMutexLocker locker(&mutex);
+    if (filter == FilterSuspect) {
+        // SUSPECTS ARE WALKED WORST FIRST, AND FROM A FILE THAT ISN'T ONE WE START AT WHICHEVER END STEP POINTS AWAY FROM
+        int count = suspectList.count();
+        int rank = (index >= 0 && index < suspectRanks.count()) ? suspectRanks.at(index) : -1;
+        if (rank < 0) {
+            rank = (step > 0) ? -1 : count;
+        }
+        for (int n = 1; n <= count; n++) {
+            int candidate = suspectList.at((((rank + step * n) % count) + count) % count);
+            if (skipped(candidate) == false) {
+                return (candidate);
+            }
+        }
+        return (-1);
+    } else if (filter == FilterAll) {
+        // ONLY DELETED FILES AND SKIPPED DUPLICATES ARE STEPPED OVER, AND NEITHER NEEDS THE DISK
+        int count = entries.count();
+        for (int n = 1; n <= count; n++) {
+            int candidate = (((index + step * n) % count) + count) % count;
+            if (skipped(candidate) == false) {
+                return (candidate);
+            }
+        }
+        return (-1);
+    }
+
+    QVector<int> list;
+    if (filter == FilterUnlabeled) {
+        list = unlabeledList;
+    } else if (filter == FilterClass) {
+        list = classLists.value(classIndex);
+    } else if (filter == FilterLowConfidence) {
+        list = lowConfidenceList;
+    }
+
+    // FIND WHERE INDEX WOULD SIT IN THE LIST AND STEP OUT FROM THERE, WRAPPING AROUND
+    int count = list.count();
+    int position = 0;
+    if (step > 0) {
+        position = (int)(std::upper_bound(list.constBegin(), list.constEnd(), index) - list.constBegin()) - 1;
+    } else {
+        position = (int)(std::lower_bound(list.constBegin(), list.constEnd(), index) - list.constBegin());
+    }
+    for (int n = 1; n <= count; n++) {
+        int candidate = list.at((((position + step * n) % count) + count) % count);
+        if (skipped(candidate) == false) {
+            return (candidate);
+        }
+    }
+    return (-1);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDatasetIndex::Entry LAUDatasetIndex::parse(QByteArray xml)
+{
+    Entry entry = emptyEntry();
+    entry.scanned = true;
+    entry.labeled = (xml.isEmpty() == false);
+
+    QXmlStreamReader reader(xml);
+    while (!reader.atEnd()) {
+        if (reader.readNext()) {
+            QString name = reader.name().toString();
+            if (name == "label") {
+                // THE LIST OF CLASSES FOLLOWED BY THE ONE THIS IMAGE BELONGS TO
+                QStringList labelStrings = reader.readElementText().split(",");
+                if (labelStrings.count() > 1) {
+                    QString string = labelStrings.takeLast().simplified();
+                    for (int n = 0; n < labelStrings.count(); n++) {
+                        if (labelStrings.at(n).simplified() == string) {
+                            entry.classIndex = n;
+                            break;
+                        }
+                    }
+                }
+            } else if (name == "confidence") {
+                entry.confidence = reader.readElementText().toFloat();
+            } else if (name == "fiducial") {
+                // EACH FIDUCIAL IS STORED AS "NAME",VISIBLE,X,Y, AND THE NAME IS WHAT SAYS WHICH FIDUCIAL IT IS
+                QString string = reader.readElementText();
+                int indexA = string.indexOf("\"") + 1;
+                int indexB = string.lastIndexOf("\"");
+                QStringList strings = string.mid(indexB + 2).split(",");
+                if (indexA > 0 && indexB >= indexA && strings.count() == 3) {
+                    entry.nameList << string.mid(indexA, indexB - indexA);
+                    entry.zVector << (unsigned char)(strings.at(0).toInt() != 0);
+                    entry.xVector << strings.at(1).toInt();
+                    entry.yVector << strings.at(2).toInt();
+                }
+            }
+        }
+    }
+    reader.clear();
+
+    return (entry);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDatasetIndex::Entry LAUDatasetIndex::arrange(const Entry &entry, QStringList names)
+{
+    Entry arranged = entry;
+    arranged.nameList = QStringList();
+    arranged.xVector.fill(0, names.count());
+    arranged.yVector.fill(0, names.count());
+    arranged.zVector.fill(0, names.count());
+
+    for (int n = 0; n < names.count(); n++) {
+        int index = entry.nameList.indexOf(names.at(n));
+        if (index >= 0 && index < entry.xVector.count() && index < entry.yVector.count() && index < entry.zVector.count()) {
+            arranged.nameList << names.at(n);
+            arranged.xVector[n] = entry.xVector.at(index);
+            arranged.yVector[n] = entry.yVector.at(index);
+            arranged.zVector[n] = entry.zVector.at(index);
+        } else {
+            arranged.nameList << QString();
+        }
+    }
+    return (arranged);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::run()
+{
+    // KEEP UP WITH FILES AS THEY ARE APPENDED UNTIL WE ARE TOLD TO QUIT
+    threadPool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+
+    int n = 0;
+    forever {
+        mutex.lock();
+        while (n >= fileStrings.count() && rescanList.isEmpty() && quitFlag == false) {
+            queueCondition.wait(&mutex);
+        }
+        bool quit = quitFlag;
+        int count = fileStrings.count();
+        QList<int> rescans = rescanList;
+        rescanList.clear();
+        mutex.unlock();
+
+        if (quit) {
+            break;
+        }
+
+        // FILES CHANGED ON DISK COME IN A FEW AT A TIME, SO READ THEM HERE
+        for (int m = 0; m < rescans.count(); m++) {
+            entry(rescans.at(m));
+        }
+
+        // HAND OUT EVERYTHING WE HAVE IN BLOCKS AND WAIT FOR THE WORKERS TO FINISH THEM
+        for (; n < count; n += LAUDATASETINDEXBLOCKSIZE) {
+            threadPool.start(new LAUDatasetIndexTask(this, n, qMin(n + LAUDATASETINDEXBLOCKSIZE, count)));
+        }
+        n = count;
+        threadPool.waitForDone();
+
+        // ONCE WE HAVE CAUGHT UP WITH THE WALKER, WRITE THE TABLE DOWN SO A CRASH DOESN'T COST US THE SCAN
+        mutex.lock();
+        bool idle = (n >= fileStrings.count());
+        mutex.unlock();
+        if (idle) {
+            save();
+        }
+    }
+
+    threadPool.clear();
+    threadPool.waitForDone();
+    save();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::load()
+{
+    if (indexFilename.isEmpty()) {
+        return;
+    }
+
+    QFile file(indexFilename);
+    if (file.open(QIODevice::ReadOnly) == false) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != LAUDATASETINDEXMAGIC || version != LAUDATASETINDEXVERSION || count < 0) {
+        return;
+    }
+
+    // A SHORT OR CORRUPT FILE JUST MEANS WE RE-READ SOME HEADERS
+    QHash<QString, Entry> hash;
+    for (int n = 0; n < count && stream.status() == QDataStream::Ok; n++) {
+        QString string;
+        Entry entry = emptyEntry();
+        qint32 width, height, classIndex;
+        stream >> string >> entry.bytes >> entry.modified >> width >> height >> classIndex >> entry.confidence >> entry.labeled;
+        stream >> entry.nameList >> entry.xVector >> entry.yVector >> entry.zVector;
+        stream >> entry.hashed >> entry.hash;
+        if (stream.status() == QDataStream::Ok) {
+            entry.scanned = true;
+            entry.width = width;
+            entry.height = height;
+            entry.classIndex = classIndex;
+            hash[string] = entry;
+        }
+    }
+    file.close();
+
+    QMutexLocker locker(&mutex);
+    for (QHash<QString, Entry>::iterator iterator = hash.begin(); iterator != hash.end(); iterator++) {
+        intern(&iterator.value());
+    }
+    storedEntries = hash;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetIndex::save()
+{
+    // ONLY SCANNED ENTRIES ARE WRITTEN, UNSCANNED FILES KEEP WHATEVER WE READ BACK FOR THEM
+    mutex.lock();
+    if (indexFilename.isEmpty() || dirtyFlag == false) {
+        mutex.unlock();
+        return;
+    }
+    QStringList strings = fileStrings;
+    QVector<Entry> table = entries;
+    for (int n = 0; n < table.count(); n++) {
+        if (table.at(n).scanned == false) {
+            table[n] = storedEntries.value(strings.at(n), table.at(n));
+        }
+    }
+    dirtyFlag = false;
+    mutex.unlock();
+
+    if (QDir().mkpath(QFileInfo(indexFilename).absolutePath()) == false) {
+        return;
+    }
+
+    // QSAVEFILE WRITES TO A TEMPORARY FILE AND RENAMES IT SO A CRASH NEVER LEAVES HALF AN INDEX
+    QSaveFile file(indexFilename);
+    if (file.open(QIODevice::WriteOnly) == false) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    qint32 count = 0;
+    for (int n = 0; n < table.count(); n++) {
+        if (table.at(n).scanned && table.at(n).missing == false) {
+            count++;
+        }
+    }
+    stream << (quint32)LAUDATASETINDEXMAGIC << (qint32)LAUDATASETINDEXVERSION << count;
+
+    for (int n = 0; n < table.count(); n++) {
+        const Entry &entry = table.at(n);
+        if (entry.scanned && entry.missing == false) {
+            stream << strings.at(n) << entry.bytes << entry.modified << (qint32)entry.width << (qint32)entry.height << (qint32)entry.classIndex << entry.confidence << entry.labeled;
+            stream << entry.nameList << entry.xVector << entry.yVector << entry.zVector;
+            stream << entry.hashed << entry.hash;
+        }
+    }
+    file.commit();
+}
@@ -0,0 +1,196 @@
+#ifndef LAUDATASETINDEX_H
+#define LAUDATASETINDEX_H
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QObject>
+#include <QVector>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QStringList>
+
+#include "lauimage.h"
+
+#define LAUDATASETINDEXLOWCONFIDENCE    0.80f
+#define LAUDATASETINDEXBLOCKSIZE        64
+#define LAUDATASETINDEXMAGIC            0x4C415549
+#define LAUDATASETINDEXVERSION          3
+
+class LAUDatasetIndex;
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUDatasetIndexTask : public QRunnable
+{
+public:
+    LAUDatasetIndexTask(LAUDatasetIndex *obj, int frst, int lst) : object(obj), first(frst), last(lst) { ; }
+
+protected:
+    void run();
+
+private:
+    LAUDatasetIndex *object;
+    int first, last;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUDatasetIndex : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum Filter { FilterAll, FilterUnlabeled, FilterClass, FilterLowConfidence, FilterSuspect };
+
+    typedef struct {
+        bool scanned;
+        bool missing;
+        bool labeled;
+        int classIndex;
+        float confidence;
+
+        // SIZE AND TIME STAMP OF THE FILE WHEN IT WAS SCANNED, SO WE KNOW WHEN A STORED ENTRY IS STALE
+        qint64 bytes;
+        qint64 modified;
+        int width;
+        int height;
+
+        // FIDUCIALS IN THE ORDER THEY APPEAR IN THE XML PACKET, WHICH FOR OLDER FILES IS A ROTATION OF THE PALETTE'S ORDER
+        QStringList nameList;
+        QVector<int> xVector;
+        QVector<int> yVector;
+        QVector<unsigned char> zVector;
+
+        // PERCEPTUAL HASH OF THE PIXELS, WHICH IS ONLY WORKED OUT WHEN SOMEONE GOES LOOKING FOR DUPLICATES
+        bool hashed;
+        quint64 hash;
+    } Entry;
+
+    // THE FILENAME IS WHERE THE TABLE IS KEPT BETWEEN SESSIONS, LEAVE IT EMPTY TO KEEP NOTHING
+    explicit LAUDatasetIndex(QStringList strings = QStringList(), QString filename = QString(), QObject *parent = nullptr);
+    ~LAUDatasetIndex();
+
+    // ONE INDEX FILE PER SET OF DATASET ROOT DIRECTORIES
+    static QString defaultFilename(QStringList directories);
+
+    // FILES ARE ONLY EVER ADDED TO THE END, SO AN INDEX STAYS VALID ONCE HANDED OUT
+    void append(QStringList strings);
+
+    int count() const
+    {
+        QMutexLocker locker(&mutex);
+        return (fileStrings.count());
+    }
+
+    QString filename(int index) const
+    {
+        QMutexLocker locker(&mutex);
+        return (fileStrings.at(index));
+    }
+
+    int indexOf(QString filename) const
+    {
+        QMutexLocker locker(&mutex);
+        return (indexHash.value(filename, -1));
+    }
+
+    // READS THE FILE'S HEADER RIGHT AWAY IF THE BACKGROUND SCAN HASN'T GOTTEN TO IT YET
+    Entry entry(int index);
+
+    // NEVER TOUCHES THE DISK, SO THE ENTRY MAY NOT BE SCANNED YET
+    Entry peek(int index) const
+    {
+        QMutexLocker locker(&mutex);
+        return (entries.at(index));
+    }
+
+    // CALL WHENEVER NEW LABELS ARE SAVED SO THE TABLE NEVER HAS TO GO BACK TO DISK
+    void update(int index, QByteArray xml);
+
+    // SOMETHING OTHER THAN US CHANGED OR DELETED THE FILE, DELETED FILES KEEP THEIR INDEX BUT ARE NEVER VISITED
+    void rescan(int index);
+    void setMissing(int index);
+
+    void setHash(int index, quint64 hash);
+
+    // FOR EACH FILE THE FILE WHOSE NEAR DUPLICATE IT IS, OR ITSELF, SO NAVIGATION CAN STEP OVER ALL BUT ONE OF A RUN
+    void setDuplicates(QVector<int> representatives);
+    void setSkipDuplicates(bool state);
+
+    // IMAGES THE ANNOTATION CHECKER WANTS A PERSON TO LOOK AT AGAIN, MOST SUSPICIOUS FIRST, AND FILTERSUSPECT VISITS THEM IN THAT ORDER
+    void setSuspects(QList<int> suspects);
+
+    bool isDuplicate(int index) const
+    {
+        QMutexLocker locker(&mutex);
+        return (index < duplicateVector.count() && duplicateVector.at(index) != index);
+    }
+
+    int missing() const
+    {
+        QMutexLocker locker(&mutex);
+        return (missingCount);
+    }
+
+    // WALK FROM INDEX IN STEPS OF +1 OR -1, WRAPPING AROUND, TO THE NEXT FILE THAT PASSES THE FILTER, NEITHER EVER READS
+    // A HEADER SO A FILE THE SCAN HASN'T REACHED YET IS SKIPPED UNTIL IT HAS
+    bool matches(int index, Filter filter, int classIndex = 0);
+    int next(int index, int step, Filter filter, int classIndex = 0);
+
+    static Entry parse(QByteArray xml);
+
+    // PUTS THE FIDUCIALS IN THE ORDER OF NAMES, A NAME THE PACKET DOESN'T HAVE COMES BACK EMPTY AND HIDDEN AT THE ORIGIN
+    static Entry arrange(const Entry &entry, QStringList names);
+
+    // THIS METHOD IS CALLED FROM THE WORKER THREADS
+    void scan(int first, int last);
+
+protected:
+    void run();
+
+private:
+    QString indexFilename;
+    QStringList fileStrings;
+    QHash<QString, int> indexHash;
+
+    mutable QMutex mutex;
+    QWaitCondition queueCondition;
+    QVector<Entry> entries;
+    QList<int> rescanList;
+    QVector<int> duplicateVector;
+    // FILES THAT PASS EACH FILTER IN INDEX ORDER, KEPT UP TO DATE AS ENTRIES CHANGE SO NEXT() IS A BINARY SEARCH
+    QVector<int> unlabeledList;
+    QVector<int> lowConfidenceList;
+    QHash<int, QVector<int> > classLists;
+
+    QList<int> suspectList;
+    QVector<int> suspectRanks;
+    bool skipDuplicatesFlag;
+    int missingCount;
+    bool quitFlag;
+    bool dirtyFlag;
+
+    // EVERY FILE LABELED WITH THE SAME PALETTE SHARES ONE COPY OF ITS FIDUCIAL NAMES
+    QHash<QString, QStringList> nameHash;
+
+    // ENTRIES READ BACK FROM THE INDEX FILE, TRUSTED ONLY WHILE THE FILE'S SIZE AND TIME STAMP MATCH
+    QHash<QString, Entry> storedEntries;
+
+    // HEADERS ARE READ BY SEVERAL THREADS AT ONCE SINCE MOST OF THE TIME IS SPENT WAITING ON THE DISK
+    QThreadPool threadPool;
+
+    static Entry emptyEntry();
+    void replace(int index, Entry entry);
+    void intern(Entry *entry);
+    void updateLists(int index, const Entry &entry, bool insert);
+    bool skipped(int index) const;
+    void load();
+    void save();
+};
+
+#endif // LAUDATASETINDEX_H
@@ -0,0 +1,288 @@
+#include "laudatasetreport.h"
+
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QtMath>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <climits>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetReportTask::run()
+{
+    // EACH TASK OWNS ITS OWN ACCUMULATOR SO THE WORKERS NEVER CONTEND, THEY ARE MERGED ONCE EVERYONE IS DONE
+    for (int n = first; n < last; n++) {
+        if (cancelFlag->loadAcquire()) {
+            return;
+        }
+        report->accumulate(datasetIndex->entry(n));
+        doneCount->fetchAndAddRelaxed(1);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDatasetReport::LAUDatasetReport(QStringList fiducials) : fiducialStrings(fiducials), imageCount(0), labeledCount(0), missingCount(0), unknownClassCount(0), boxCount(0)
+{
+    widthHistogram.fill(0, LAUDATASETREPORTHISTOGRAMBINS);
+    heightHistogram.fill(0, LAUDATASETREPORTHISTOGRAMBINS);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetReport::resizeFiducials(int count)
+{
+    while (visibleVector.count() < count) {
+        visibleVector << 0;
+        totalVector << 0;
+        heatmapVector << QVector<quint32>(LAUDATASETREPORTHEATMAPSIZE * LAUDATASETREPORTHEATMAPSIZE, 0);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetReport::accumulate(LAUDatasetIndex::Entry entry)
+{
+    imageCount++;
+    if (entry.missing) {
+        missingCount++;
+        return;
+    } else if (entry.labeled == false) {
+        return;
+    }
+    labeledCount++;
+
+    if (entry.classIndex < 0) {
+        unknownClassCount++;
+    } else {
+        while (classVector.count() <= entry.classIndex) {
+            classVector << 0;
+        }
+        classVector[entry.classIndex]++;
+    }
+
+    // OLDER FILES STORE THEIR FIDUCIALS IN A ROTATED ORDER, SO LINE THEM UP BY NAME BEFORE COUNTING
+    if (fiducialStrings.isEmpty() == false) {
+        entry = LAUDatasetIndex::arrange(entry, fiducialStrings);
+    }
+    int fiducials = qMin(entry.xVector.count(), qMin(entry.yVector.count(), entry.zVector.count()));
+    resizeFiducials(fiducials);
+
+    int xMin = INT_MAX, xMax = INT_MIN;
+    int yMin = INT_MAX, yMax = INT_MIN;
+    int placed = 0;
+    for (int n = 0; n < fiducials; n++) {
+        if (fiducialStrings.isEmpty() == false && entry.nameList.at(n).isEmpty()) {
+            continue;
+        }
+        placed++;
+
+        int x = entry.xVector.at(n);
+        int y = entry.yVector.at(n);
+        totalVector[n]++;
+
+        xMin = qMin(xMin, x);
+        xMax = qMax(xMax, x);
+        yMin = qMin(yMin, y);
+        yMax = qMax(yMax, y);
+
+        // HIDDEN FIDUCIALS STILL HAVE A POSITION, BUT IT IS A GUESS SO IT STAYS OUT OF THE HEATMAP
+        if (entry.zVector.at(n) != 0) {
+            visibleVector[n]++;
+            if (entry.width > 0 && entry.height > 0) {
+                int col = qBound(0, x * LAUDATASETREPORTHEATMAPSIZE / entry.width, LAUDATASETREPORTHEATMAPSIZE - 1);
+                int row = qBound(0, y * LAUDATASETREPORTHEATMAPSIZE / entry.height, LAUDATASETREPORTHEATMAPSIZE - 1);
+                heatmapVector[n][row * LAUDATASETREPORTHEATMAPSIZE + col]++;
+            }
+        }
+    }
+
+    if (placed > 0 && entry.width > 0 && entry.height > 0) {
+        double width = (double)(xMax - xMin + LAUDATASETREPORTPADDING) / (double)entry.width;
+        double height = (double)(yMax - yMin + LAUDATASETREPORTPADDING) / (double)entry.height;
+        widthHistogram[qBound(0, (int)(width * LAUDATASETREPORTHISTOGRAMBINS), LAUDATASETREPORTHISTOGRAMBINS - 1)]++;
+        heightHistogram[qBound(0, (int)(height * LAUDATASETREPORTHISTOGRAMBINS), LAUDATASETREPORTHISTOGRAMBINS - 1)]++;
+        boxCount++;
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDatasetReport::merge(const LAUDatasetReport &other)
+{
+    imageCount += other.imageCount;
+    labeledCount += other.labeledCount;
+    missingCount += other.missingCount;
+    unknownClassCount += other.unknownClassCount;
+    boxCount += other.boxCount;
+
+    while (classVector.count() < other.classVector.count()) {
+        classVector << 0;
+    }
+    for (int n = 0; n < other.classVector.count(); n++) {
+        classVector[n] += other.classVector.at(n);
+    }
+
+    resizeFiducials(other.visibleVector.count());
+    for (int n = 0; n < other.visibleVector.count(); n++) {
+        visibleVector[n] += other.visibleVector.at(n);
+        totalVector[n] += other.totalVector.at(n);
+        for (int m = 0; m < LAUDATASETREPORTHEATMAPSIZE * LAUDATASETREPORTHEATMAPSIZE; m++) {
+            heatmapVector[n][m] += other.heatmapVector.at(n).at(m);
+        }
+    }
+
+    for (int n = 0; n < LAUDATASETREPORTHISTOGRAMBINS; n++) {
+        widthHistogram[n] += other.widthHistogram.at(n);
+        heightHistogram[n] += other.heightHistogram.at(n);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImage LAUDatasetReport::heatmap(int fiducial) const
+{
+    LAUImage image(LAUDATASETREPORTHEATMAPSIZE, LAUDATASETREPORTHEATMAPSIZE, 1, sizeof(unsigned char));
+
+    quint32 maximum = 0;
+    const QVector<quint32> &counts = heatmapVector.at(fiducial);
+    for (int n = 0; n < counts.count(); n++) {
+        maximum = qMax(maximum, counts.at(n));
+    }
+
+    // LOG SCALE SO A FEW CELLS EVERY IMAGE LANDS IN DON'T WASH OUT EVERYTHING ELSE
+    double scale = (maximum > 0) ? 255.0 / qLn(1.0 + (double)maximum) : 0.0;
+    for (int row = 0; row < LAUDATASETREPORTHEATMAPSIZE; row++) {
+        unsigned char *buffer = image.scanLine(row);
+        for (int col = 0; col < LAUDATASETREPORTHEATMAPSIZE; col++) {
+            buffer[col] = (unsigned char)qRound(scale * qLn(1.0 + (double)counts.at(row * LAUDATASETREPORTHEATMAPSIZE + col)));
+        }
+    }
+    return (image);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUDatasetReport::saveCsv(QString filename, QStringList labels, QStringList fiducials) const
+{
+    QSaveFile file(filename);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text) == false) {
+        return (false);
+    }
+
+    // ONE LONG TABLE SO IT DROPS STRAIGHT INTO A SPREADSHEET OR PANDAS
+    QTextStream stream(&file);
+    stream << "section,name,count,fraction\n";
+    stream << "images,total," << imageCount << ",1\n";
+    stream << "images,labeled," << labeledCount << "," << (double)labeledCount / (double)qMax(imageCount, (qint64)1) << "\n";
+    stream << "images,missing," << missingCount << "," << (double)missingCount / (double)qMax(imageCount, (qint64)1) << "\n";
+
+    for (int n = 0; n < classVector.count(); n++) {
+        QString name = (n < labels.count()) ? labels.at(n) : QString("class %1").arg(n);
+        stream << "class,\"" << name << "\"," << classVector.at(n) << "," << (double)classVector.at(n) / (double)qMax(labeledCount, (qint64)1) << "\n";
+    }
+    stream << "class,unknown," << unknownClassCount << "," << (double)unknownClassCount / (double)qMax(labeledCount, (qint64)1) << "\n";
+
+    for (int n = 0; n < visibleVector.count(); n++) {
+        QString name = (n < fiducials.count()) ? fiducials.at(n) : QString("fiducial %1").arg(n);
+        stream << "visible,\"" << name << "\"," << visibleVector.at(n) << "," << (double)visibleVector.at(n) / (double)qMax(totalVector.at(n), (qint64)1) << "\n";
+    }
+
+    for (int n = 0; n < LAUDATASETREPORTHISTOGRAMBINS; n++) {
+        QString name = QString("%1-%2").arg((double)n / LAUDATASETREPORTHISTOGRAMBINS).arg((double)(n + 1) / LAUDATASETREPORTHISTOGRAMBINS);
+        stream << "boxwidth," << name << "," << widthHistogram.at(n) << "," << (double)widthHistogram.at(n) / (double)qMax(boxCount, (qint64)1) << "\n";
+    }
+    for (int n = 0; n < LAUDATASETREPORTHISTOGRAMBINS; n++) {
+        QString name = QString("%1-%2").arg((double)n / LAUDATASETREPORTHISTOGRAMBINS).arg((double)(n + 1) / LAUDATASETREPORTHISTOGRAMBINS);
+        stream << "boxheight," << name << "," << heightHistogram.at(n) << "," << (double)heightHistogram.at(n) / (double)qMax(boxCount, (qint64)1) << "\n";
+    }
+    stream.flush();
+
+    return (file.commit());
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUDatasetReport::save(QString filename, QStringList labels, QStringList fiducials) const
+{
+    QFileInfo fileInfo(filename);
+    QString baseString = QString("%1/%2").arg(fileInfo.absolutePath()).arg(fileInfo.completeBaseName());
+    QString csvString = QString("%1.csv").arg(baseString);
+    if (saveCsv(csvString, labels, fiducials) == false) {
+        return (false);
+    }
+
+    // HEATMAPS GO IN A FOLDER NAMED AFTER THE PAGE, THE WAY A BROWSER SAVES ONE
+    QDir heatmapDir(QString("%1_files").arg(baseString));
+    if (heatmapDir.exists() == false && heatmapDir.mkpath(heatmapDir.absolutePath()) == false) {
+        return (false);
+    }
+
+    QSaveFile file(filename);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text) == false) {
+        return (false);
+    }
+
+    QTextStream stream(&file);
+    stream << "<html>\n<head>\n<meta charset=\"utf-8\">\n<title>Dataset Report</title>\n";
+    stream << "<style>body { font-family: sans-serif; } td, th { padding: 2px 8px; text-align: left; } .bar { background: #4682b4; height: 10px; } img { image-rendering: pixelated; background: black; }</style>\n";
+    stream << "</head>\n<body>\n";
+    stream << QString("<h1>Dataset Report</h1>\n<p>%1 images, %2 labeled, %3 missing. <a href=\"%4\">CSV</a></p>\n").arg(imageCount).arg(labeledCount).arg(missingCount).arg(QFileInfo(csvString).fileName());
+
+    // CLASS BALANCE
+    stream << "<h2>Classes</h2>\n<table>\n<tr><th>Class</th><th>Images</th><th>Fraction</th><th></th></tr>\n";
+    for (int n = 0; n <= classVector.count(); n++) {
+        qint64 count = (n < classVector.count()) ? classVector.at(n) : unknownClassCount;
+        QString name = (n < classVector.count()) ? ((n < labels.count()) ? labels.at(n) : QString("class %1").arg(n)) : QString("unknown");
+        double fraction = (double)count / (double)qMax(labeledCount, (qint64)1);
+        stream << QString("<tr><td>%1</td><td>%2</td><td>%3%</td><td><div class=\"bar\" style=\"width: %4px\"></div></td></tr>\n").arg(name.toHtmlEscaped()).arg(count).arg(100.0 * fraction, 0, 'f', 1).arg(qRound(300.0 * fraction));
+    }
+    stream << "</table>\n";
+
+    // VISIBILITY AND WHERE EACH FIDUCIAL TENDS TO LAND
+    stream << "<h2>Fiducials</h2>\n<table>\n<tr><th>Fiducial</th><th>Visible</th><th>Rate</th><th>Heatmap</th></tr>\n";
+    for (int n = 0; n < visibleVector.count(); n++) {
+        QString name = (n < fiducials.count()) ? fiducials.at(n) : QString("fiducial %1").arg(n);
+        QString heatmapString = QString("fiducial%1.png").arg(n, 3, 10, QChar('0'));
+
+        LAUImage image = heatmap(n);
+        QImage pngImage(image.width(), image.height(), QImage::Format_Grayscale8);
+        for (unsigned int row = 0; row < image.height(); row++) {
+            memcpy(pngImage.scanLine(row), image.constScanLine(row), image.width());
+        }
+        pngImage.save(heatmapDir.absoluteFilePath(heatmapString));
+
+        double rate = (double)visibleVector.at(n) / (double)qMax(totalVector.at(n), (qint64)1);
+        stream << QString("<tr><td>%1</td><td>%2</td><td>%3%</td><td><img src=\"%4/%5\" width=\"128\" height=\"128\"></td></tr>\n").arg(name.toHtmlEscaped()).arg(visibleVector.at(n)).arg(100.0 * rate, 0, 'f', 1).arg(heatmapDir.dirName()).arg(heatmapString);
+    }
+    stream << "</table>\n";
+
+    // BOUNDING BOX SIZES
+    stream << "<h2>Bounding Boxes</h2>\n<table>\n<tr><th>Fraction of Image</th><th>Width</th><th></th><th>Height</th><th></th></tr>\n";
+    qint64 maximum = 1;
+    for (int n = 0; n < LAUDATASETREPORTHISTOGRAMBINS; n++) {
+        maximum = qMax(maximum, qMax(widthHistogram.at(n), heightHistogram.at(n)));
+    }
+    for (int n = 0; n < LAUDATASETREPORTHISTOGRAMBINS; n++) {
+        stream << QString("<tr><td>%1 - %2</td><td>%3</td><td><div class=\"bar\" style=\"width: %4px\"></div></td><td>%5</td><td><div class=\"bar\" style=\"width: %6px\"></div></td></tr>\n")
+                  .arg((double)n / LAUDATASETREPORTHISTOGRAMBINS, 0, 'f', 2).arg((double)(n + 1) / LAUDATASETREPORTHISTOGRAMBINS, 0, 'f', 2)
+                  .arg(widthHistogram.at(n)).arg(qRound(200.0 * widthHistogram.at(n) / maximum))
+                  .arg(heightHistogram.at(n)).arg(qRound(200.0 * heightHistogram.at(n) / maximum));
+    }
+    stream << "</table>\n</body>\n</html>\n";
+    stream.flush();
+
+    return (file.commit());
+}
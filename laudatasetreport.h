@@ -0,0 +1,77 @@
+#ifndef LAUDATASETREPORT_H
+#define LAUDATASETREPORT_H
+
+#include <QVector>
+#include <QString>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QStringList>
+
+#include "lauimage.h"
+#include "laudatasetindex.h"
+
+#define LAUDATASETREPORTHEATMAPSIZE     64
+#define LAUDATASETREPORTHISTOGRAMBINS   20
+#define LAUDATASETREPORTPADDING         40
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUDatasetReport
+{
+public:
+    // FIDUCIALS ARE COUNTED UNDER THESE NAMES, WHATEVER ORDER A FILE STORES THEM IN
+    explicit LAUDatasetReport(QStringList fiducials = QStringList());
+
+    // EVERY ACCUMULATOR IS A FIXED SIZE TABLE OF COUNTS, SO MEMORY DOESN'T GROW WITH THE NUMBER OF IMAGES
+    void accumulate(LAUDatasetIndex::Entry entry);
+    void merge(const LAUDatasetReport &other);
+
+    // WHERE THE VISIBLE INSTANCES OF A FIDUCIAL LAND, AS A FRACTION OF THE IMAGE, LOG SCALED TO 8 BITS
+    LAUImage heatmap(int fiducial) const;
+
+    // THE HTML PAGE LINKS TO THE CSV AND HEATMAPS, WHICH ARE WRITTEN NEXT TO IT
+    bool save(QString filename, QStringList labels, QStringList fiducials) const;
+
+private:
+    QStringList fiducialStrings;
+
+    qint64 imageCount;
+    qint64 labeledCount;
+    qint64 missingCount;
+    qint64 unknownClassCount;
+    qint64 boxCount;
+
+    QVector<qint64> classVector;
+    QVector<qint64> visibleVector;
+    QVector<qint64> totalVector;
+    QVector<QVector<quint32> > heatmapVector;
+
+    // SIZE OF THE BOX AROUND ALL FIDUCIALS, PADDED THE SAME WAY THE YOLO EXPORT PADS IT, AS A FRACTION OF THE IMAGE
+    QVector<qint64> widthHistogram;
+    QVector<qint64> heightHistogram;
+
+    void resizeFiducials(int count);
+    bool saveCsv(QString filename, QStringList labels, QStringList fiducials) const;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUDatasetReportTask : public QRunnable
+{
+public:
+    LAUDatasetReportTask(LAUDatasetIndex *index, int frst, int lst, LAUDatasetReport *rprt, QAtomicInt *cancel, QAtomicInt *done) : datasetIndex(index), first(frst), last(lst), report(rprt), cancelFlag(cancel), doneCount(done) { ; }
+
+protected:
+    void run();
+
+private:
+    LAUDatasetIndex *datasetIndex;
+    int first, last;
+    LAUDatasetReport *report;
+    QAtomicInt *cancelFlag;
+    QAtomicInt *doneCount;
+};
+
+#endif // LAUDATASETREPORT_H
@@ -102,6 +102,11 @@ public:
         numClasses = val;
     }
 
+    int classes() const
+    {
+        return(numClasses);
+    }
+
     void setNumberOfFiducials(int val)
     {
         numFiducials = val;
@@ -0,0 +1,237 @@
+#include "laudirectorywalker.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWalkerTask::run()
+{
+    object->list(sequence, directoryString);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDirectoryWalker::LAUDirectoryWalker(QStringList directories, QStringList filters, QObject *parent) : QThread(parent), directoryStrings(directories), datasetIndex(nullptr), queueFlag(false)
+{
+    initialize(filters);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDirectoryWalker::LAUDirectoryWalker(QStringList directories, QStringList filters, LAUDatasetIndex *index, QObject *parent) : QThread(parent), directoryStrings(directories), datasetIndex(index), queueFlag(true)
+{
+    initialize(filters);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDirectoryWalker::~LAUDirectoryWalker()
+{
+    mutex.lock();
+    quitFlag = true;
+    listingCondition.wakeAll();
+    queueCondition.wakeAll();
+    spaceCondition.wakeAll();
+    mutex.unlock();
+
+    wait();
+
+    // THE LISTING TASKS HOLD A POINTER TO US
+    threadPool.clear();
+    threadPool.waitForDone();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWalker::initialize(QStringList filters)
+{
+    foundCount = 0;
+    completeFlag = false;
+    quitFlag = false;
+
+    // MATCH ON THE EXTENSION IGNORING CASE, SO *.TIF AND *.tif BOTH COUNT
+    for (int n = 0; n < filters.count(); n++) {
+        QString string = filters.at(n).toLower();
+        if (string.startsWith("*")) {
+            string.remove(0, 1);
+        }
+        suffixStrings << string;
+    }
+
+    // NETWORK SHARES SPEND MOST OF THEIR TIME WAITING ON ROUND TRIPS, SO KEEP SEVERAL LISTINGS IN FLIGHT
+    threadPool.setMaxThreadCount(qMax(4, QThread::idealThreadCount()));
+
+    start(QThread::LowPriority);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUDirectoryWalker::isCancelled()
+{
+    QMutexLocker locker(&mutex);
+    return (quitFlag);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUDirectoryWalker::next(QString *string)
+{
+    QMutexLocker locker(&mutex);
+    while (queue.isEmpty() && completeFlag == false && quitFlag == false) {
+        queueCondition.wait(&mutex);
+    }
+    if (queue.isEmpty()) {
+        return (false);
+    }
+
+    *string = queue.dequeue();
+    spaceCondition.wakeAll();
+    return (true);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUDirectoryWalker::count() const
+{
+    QMutexLocker locker(&mutex);
+    return (foundCount);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWalker::list(int sequence, QString directory)
+{
+    Listing listing;
+    if (isCancelled() == false) {
+        // ONE PASS OVER THE ENTRIES, THE ITERATOR TAKES THE TYPE FROM THE DIRECTORY ENTRY SO NOTHING IS STAT'ED TWICE
+        QDirIterator iterator(directory, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+        while (iterator.hasNext()) {
+            QString string = iterator.next();
+            if (iterator.fileInfo().isDir()) {
+                listing.directories << string;
+            } else {
+                QString name = iterator.fileName().toLower();
+                for (int n = 0; n < suffixStrings.count(); n++) {
+                    if (name.endsWith(suffixStrings.at(n))) {
+                        listing.files << string;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // SAME ORDER THE OLD NAME SORTED entryList() CALLS GAVE US
+        listing.files.sort(Qt::CaseInsensitive);
+        listing.directories.sort(Qt::CaseInsensitive);
+    }
+
+    QMutexLocker locker(&mutex);
+    listings[sequence] = listing;
+    listingCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWalker::run()
+{
+    QStringList batch;
+    bool sentFlag = false;
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList directoryList;
+    for (int n = 0; n < directoryStrings.count(); n++) {
+        directoryList << QDir(directoryStrings.at(n)).absolutePath();
+    }
+
+    // BREADTH FIRST, WITH A FEW DIRECTORIES BEING LISTED AHEAD OF THE ONE WE ARE HANDING OUT
+    int dispatched = 0;
+    int delivered = 0;
+    int window = 2 * threadPool.maxThreadCount();
+    forever {
+        while (dispatched - delivered < window && directoryList.isEmpty() == false) {
+            threadPool.start(new LAUDirectoryWalkerTask(this, dispatched++, directoryList.takeFirst()));
+        }
+        if (delivered == dispatched) {
+            break;
+        }
+
+        mutex.lock();
+        while (listings.contains(delivered) == false && quitFlag == false) {
+            listingCondition.wait(&mutex);
+        }
+        if (quitFlag) {
+            mutex.unlock();
+            break;
+        }
+        Listing listing = listings.take(delivered++);
+        mutex.unlock();
+
+        // SUBDIRECTORIES JOIN THE BACK OF THE LINE IN THE ORDER THEIR PARENTS ARE HANDED OUT
+        directoryList << listing.directories;
+
+        if (queueFlag) {
+            if (listing.files.isEmpty()) {
+                continue;
+            }
+
+            // THE INDEX GETS THE FILES FIRST SO THE CALLER'S N-TH FILE IS ALWAYS THE INDEX'S N-TH ENTRY
+            if (datasetIndex) {
+                datasetIndex->append(listing.files);
+            }
+
+            // DON'T RUN TOO FAR AHEAD OF WHOEVER IS CONSUMING THE FILES
+            QMutexLocker locker(&mutex);
+            while (queue.count() >= LAUDIRECTORYWALKERQUEUESIZE && quitFlag == false) {
+                spaceCondition.wait(&mutex);
+            }
+            for (int n = 0; n < listing.files.count(); n++) {
+                queue.enqueue(listing.files.at(n));
+            }
+            foundCount += listing.files.count();
+            queueCondition.wakeAll();
+        } else {
+            for (int n = 0; n < listing.files.count(); n++) {
+                batch << listing.files.at(n);
+
+                // THE VERY FIRST FILE GOES OUT ALONE SO THE VIEWER CAN START DRAWING, AFTER THAT SEND BATCHES
+                if (sentFlag == false || batch.count() >= LAUDIRECTORYWALKERBATCHSIZE || timer.elapsed() > LAUDIRECTORYWALKERBATCHMSEC) {
+                    QMetaObject::invokeMethod(this, "onFilesFound", Qt::QueuedConnection, Q_ARG(QStringList, batch));
+                    batch.clear();
+                    timer.restart();
+                    sentFlag = true;
+                }
+            }
+            mutex.lock();
+            foundCount += listing.files.count();
+            mutex.unlock();
+        }
+    }
+
+    // LET ANY CALLER BLOCKED IN next() KNOW NOTHING ELSE IS COMING
+    mutex.lock();
+    completeFlag = true;
+    queueCondition.wakeAll();
+    mutex.unlock();
+
+    if (queueFlag == false) {
+        if (batch.isEmpty() == false) {
+            QMetaObject::invokeMethod(this, "onFilesFound", Qt::QueuedConnection, Q_ARG(QStringList, batch));
+        }
+        QMetaObject::invokeMethod(this, "onWalkComplete", Qt::QueuedConnection);
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef LAUDIRECTORYWALKER_H
+#define LAUDIRECTORYWALKER_H
+
+#include <QHash>
+#include <QQueue>
+#include <QMutex>
+#include <QThread>
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QStringList>
+#include <QWaitCondition>
+
+#include "laudatasetindex.h"
+
+#define LAUDIRECTORYWALKERBATCHSIZE     512
+#define LAUDIRECTORYWALKERBATCHMSEC     100
+#define LAUDIRECTORYWALKERQUEUESIZE     8192
+
+class LAUDirectoryWalker;
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUDirectoryWalkerTask : public QRunnable
+{
+public:
+    LAUDirectoryWalkerTask(LAUDirectoryWalker *obj, int seq, QString directory) : object(obj), sequence(seq), directoryString(directory) { ; }
+
+protected:
+    void run();
+
+private:
+    LAUDirectoryWalker *object;
+    int sequence;
+    QString directoryString;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUDirectoryWalker : public QThread
+{
+    Q_OBJECT
+
+public:
+    // FILES ARE SENT TO THE GUI THREAD IN BATCHES THROUGH emitFilesFound()
+    explicit LAUDirectoryWalker(QStringList directories, QStringList filters = imageFilters(), QObject *parent = nullptr);
+
+    // FILES ARE HELD IN A BOUNDED QUEUE FOR next() INSTEAD, AND APPENDED TO THE INDEX AS FOUND SO ITS HEADER SCAN RUNS AHEAD OF THE CALLER
+    LAUDirectoryWalker(QStringList directories, QStringList filters, LAUDatasetIndex *index, QObject *parent = nullptr);
+    ~LAUDirectoryWalker();
+
+    // THE FILE TYPES THE LABELER KNOWS HOW TO OPEN
+    static QStringList imageFilters()
+    {
+        return (QStringList() << "*.tif" << "*.tiff" << "*.jpg");
+    }
+
+    // BLOCKS UNTIL THE NEXT FILE TURNS UP, RETURNS FALSE ONCE THE WALK IS DONE AND EVERY FILE HAS BEEN TAKEN
+    bool next(QString *string);
+
+    // FILES FOUND SO FAR, WHICH ONLY STOPS GROWING ONCE THE WALK IS DONE
+    int count() const;
+
+    // THIS METHOD IS CALLED FROM THE WORKER THREADS
+    void list(int sequence, QString directory);
+
+public slots:
+    void onFilesFound(QStringList strings)
+    {
+        emit emitFilesFound(strings);
+    }
+
+    void onWalkComplete()
+    {
+        emit emitWalkComplete();
+    }
+
+protected:
+    void run();
+
+private:
+    typedef struct {
+        QStringList files;
+        QStringList directories;
+    } Listing;
+
+    QStringList directoryStrings;
+    QStringList suffixStrings;
+    LAUDatasetIndex *datasetIndex;
+    bool queueFlag;
+
+    // DIRECTORIES ARE LISTED IN PARALLEL BUT HANDED OUT IN THE ORDER A SINGLE THREADED WALK WOULD VISIT THEM
+    QThreadPool threadPool;
+    QHash<int, Listing> listings;
+
+    mutable QMutex mutex;
+    QWaitCondition listingCondition;
+    QWaitCondition queueCondition;
+    QWaitCondition spaceCondition;
+    QQueue<QString> queue;
+    int foundCount;
+    bool completeFlag;
+    bool quitFlag;
+
+    void initialize(QStringList filters);
+    bool isCancelled();
+
+signals:
+    void emitFilesFound(QStringList strings);
+    void emitWalkComplete();
+};
+
+#endif // LAUDIRECTORYWALKER_H
@@ -0,0 +1,259 @@
+#include "laudirectorywatcher.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDirectoryWatcher::LAUDirectoryWatcher(LAUDatasetIndex *index, QStringList directories, QStringList filters, QObject *parent) : QThread(parent), datasetIndex(index), directoryStrings(directories), filterStrings(filters), quitFlag(false)
+{
+    watcher = new QFileSystemWatcher(this);
+    connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(onDirectoryChanged(QString)));
+
+    // A COPY OF THOUSANDS OF FILES FIRES THOUSANDS OF SIGNALS, SO WAIT FOR THINGS TO SETTLE BEFORE LOOKING
+    debounceTimer = new QTimer(this);
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(LAUDIRECTORYWATCHERDEBOUNCEMSEC);
+    connect(debounceTimer, SIGNAL(timeout()), this, SLOT(onDebounceTimeout()));
+
+    start(QThread::LowPriority);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDirectoryWatcher::~LAUDirectoryWatcher()
+{
+    mutex.lock();
+    quitFlag = true;
+    queueCondition.wakeAll();
+    mutex.unlock();
+
+    wait();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWatcher::onDirectoryChanged(QString string)
+{
+    changedDirectories.insert(string);
+
+    // RESTART THE QUIET PERIOD WITH EVERY CHANGE, BUT DON'T LET A STEADY TRICKLE HOLD US OFF FOREVER
+    if (burstTimer.isValid() == false) {
+        burstTimer.start();
+    }
+
+    if (burstTimer.elapsed() >= LAUDIRECTORYWATCHERMAXIMUMMSEC) {
+        onDebounceTimeout();
+    } else {
+        debounceTimer->start();
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWatcher::onDebounceTimeout()
+{
+    debounceTimer->stop();
+    burstTimer.invalidate();
+
+    QMutexLocker locker(&mutex);
+    QList<QString> strings = changedDirectories.values();
+    for (int n = 0; n < strings.count(); n++) {
+        if (queue.contains(strings.at(n)) == false) {
+            queue << strings.at(n);
+        }
+    }
+    changedDirectories.clear();
+    queueCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWatcher::onDirectoriesFound(QStringList strings)
+{
+    if (strings.isEmpty() == false) {
+        watcher->addPaths(strings);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWatcher::onDirectoriesLost(QStringList strings)
+{
+    QStringList watched = watcher->directories();
+    for (int n = 0; n < strings.count(); n++) {
+        if (watched.contains(strings.at(n))) {
+            watcher->removePath(strings.at(n));
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWatcher::send(const char *method, QStringList strings)
+{
+    // SAME BATCH SIZE AS THE WALKER SO A BURST NEVER FLOODS THE GUI THREAD WITH ONE HUGE LIST
+    for (int n = 0; n < strings.count(); n += LAUDIRECTORYWALKERBATCHSIZE) {
+        QMetaObject::invokeMethod(this, method, Qt::QueuedConnection, Q_ARG(QStringList, strings.mid(n, LAUDIRECTORYWALKERBATCHSIZE)));
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWatcher::snapshot(QString directory, QStringList *added, QStringList *directories)
+{
+    QDir dir(directory);
+
+    // ANY FILE THE INDEX DOESN'T KNOW ABOUT YET IS NEW
+    QHash<QString, Stamp> hash;
+    QFileInfoList files = dir.entryInfoList(filterStrings, QDir::Files | QDir::NoDotAndDotDot, QDir::Name);
+    for (int n = 0; n < files.count(); n++) {
+        QString string = files.at(n).absoluteFilePath();
+        Stamp stamp = { files.at(n).size(), files.at(n).lastModified().toMSecsSinceEpoch() };
+        hash[string] = stamp;
+        if (datasetIndex->indexOf(string) < 0) {
+            *added << string;
+        }
+    }
+    snapshots[directory] = hash;
+
+    QStringList folders = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (int n = 0; n < folders.count(); n++) {
+        *directories << dir.absoluteFilePath(folders.at(n));
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWatcher::compare(QString directory, QStringList *added, QStringList *changed, QStringList *removed, QStringList *directories, QStringList *lost)
+{
+    QDir dir(directory);
+
+    // A DIRECTORY THAT WENT AWAY TAKES EVERYTHING BENEATH IT ALONG
+    QStringList keys = snapshots.keys();
+    for (int n = 0; n < keys.count(); n++) {
+        QString key = keys.at(n);
+        bool below = (key == directory || key.startsWith(directory + "/"));
+        if (below && QDir(key).exists() == false) {
+            *removed << snapshots.value(key).keys();
+            *lost << key;
+            snapshots.remove(key);
+        }
+    }
+    if (snapshots.contains(directory) == false) {
+        return;
+    }
+
+    QHash<QString, Stamp> before = snapshots.value(directory);
+    QHash<QString, Stamp> after;
+
+    QFileInfoList files = dir.entryInfoList(filterStrings, QDir::Files | QDir::NoDotAndDotDot, QDir::Name);
+    for (int n = 0; n < files.count(); n++) {
+        QString string = files.at(n).absoluteFilePath();
+        Stamp stamp = { files.at(n).size(), files.at(n).lastModified().toMSecsSinceEpoch() };
+        after[string] = stamp;
+
+        if (before.contains(string) == false) {
+            // A FILE DELETED AND PUT BACK IS ALREADY IN THE INDEX, SO IT ONLY NEEDS ITS HEADER READ AGAIN
+            if (datasetIndex->indexOf(string) < 0) {
+                *added << string;
+            } else {
+                *changed << string;
+            }
+        } else if (before.value(string).bytes != stamp.bytes || before.value(string).modified != stamp.modified) {
+            *changed << string;
+        }
+    }
+
+    QList<QString> strings = before.keys();
+    for (int n = 0; n < strings.count(); n++) {
+        if (after.contains(strings.at(n)) == false) {
+            *removed << strings.at(n);
+        }
+    }
+    snapshots[directory] = after;
+
+    // NEW SUBDIRECTORIES STILL NEED TO BE LOOKED AT AND WATCHED
+    QStringList folders = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (int n = 0; n < folders.count(); n++) {
+        QString string = dir.absoluteFilePath(folders.at(n));
+        if (snapshots.contains(string) == false) {
+            *directories << string;
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUDirectoryWatcher::run()
+{
+    // FIRST LOOK AT EVERY DIRECTORY UNDER THE ROOTS, WHICH ALSO CATCHES FILES THAT LANDED WHILE THE WALKER WAS BUSY
+    QStringList added, watched;
+    QStringList directoryList;
+    for (int n = 0; n < directoryStrings.count(); n++) {
+        directoryList << QDir(directoryStrings.at(n)).absolutePath();
+    }
+
+    forever {
+        mutex.lock();
+        bool quit = quitFlag;
+        mutex.unlock();
+        if (quit || directoryList.isEmpty()) {
+            break;
+        }
+
+        QString directory = directoryList.takeFirst();
+        snapshot(directory, &added, &directoryList);
+        watched << directory;
+    }
+    send("onDirectoriesFound", watched);
+    send("onFilesAdded", added);
+
+    // THEN WAIT FOR THE GUI THREAD TO TELL US WHICH DIRECTORIES HAVE SETTLED AFTER A CHANGE
+    forever {
+        mutex.lock();
+        while (queue.isEmpty() && quitFlag == false) {
+            queueCondition.wait(&mutex);
+        }
+        if (quitFlag) {
+            mutex.unlock();
+            return;
+        }
+        QStringList strings = queue;
+        queue.clear();
+        mutex.unlock();
+
+        QStringList changed, removed, lost, pending;
+        added.clear();
+        watched.clear();
+        for (int n = 0; n < strings.count(); n++) {
+            compare(strings.at(n), &added, &changed, &removed, &pending, &lost);
+        }
+
+        // EVERY FILE IN A NEW DIRECTORY IS NEW
+        while (pending.isEmpty() == false) {
+            QString directory = pending.takeFirst();
+            if (snapshots.contains(directory) == false) {
+                snapshot(directory, &added, &pending);
+                watched << directory;
+            }
+        }
+
+        send("onDirectoriesLost", lost);
+        send("onDirectoriesFound", watched);
+        send("onFilesRemoved", removed);
+        send("onFilesChanged", changed);
+        send("onFilesAdded", added);
+    }
+}
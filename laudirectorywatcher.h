@@ -0,0 +1,85 @@
+#ifndef LAUDIRECTORYWATCHER_H
+#define LAUDIRECTORYWATCHER_H
+
+#include <QSet>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include <QThread>
+#include <QObject>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QWaitCondition>
+#include <QFileSystemWatcher>
+
+#include "laudatasetindex.h"
+#include "laudirectorywalker.h"
+
+#define LAUDIRECTORYWATCHERDEBOUNCEMSEC     500
+#define LAUDIRECTORYWATCHERMAXIMUMMSEC      2000
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUDirectoryWatcher : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit LAUDirectoryWatcher(LAUDatasetIndex *index, QStringList directories, QStringList filters = LAUDirectoryWalker::imageFilters(), QObject *parent = nullptr);
+    ~LAUDirectoryWatcher();
+
+public slots:
+    void onDirectoryChanged(QString string);
+    void onDebounceTimeout();
+    void onDirectoriesFound(QStringList strings);
+    void onDirectoriesLost(QStringList strings);
+
+    void onFilesAdded(QStringList strings)
+    {
+        emit emitFilesAdded(strings);
+    }
+
+    void onFilesChanged(QStringList strings)
+    {
+        emit emitFilesChanged(strings);
+    }
+
+    void onFilesRemoved(QStringList strings)
+    {
+        emit emitFilesRemoved(strings);
+    }
+
+protected:
+    void run();
+
+private:
+    LAUDatasetIndex *datasetIndex;
+    QStringList directoryStrings;
+    QStringList filterStrings;
+
+    // THE WATCHER AND TIMERS BELONG TO THE GUI THREAD
+    QFileSystemWatcher *watcher;
+    QTimer *debounceTimer;
+    QElapsedTimer burstTimer;
+    QSet<QString> changedDirectories;
+
+    // DIRECTORIES WAITING FOR THE WORKER THREAD TO LOOK AT THEM
+    QMutex mutex;
+    QWaitCondition queueCondition;
+    QStringList queue;
+    bool quitFlag;
+
+    // WHAT EACH WATCHED DIRECTORY HELD LAST TIME WE LOOKED, ONLY TOUCHED BY THE WORKER THREAD
+    typedef struct {
+        qint64 bytes;
+        qint64 modified;
+    } Stamp;
+    QHash<QString, QHash<QString, Stamp> > snapshots;
+
+    void snapshot(QString directory, QStringList *added, QStringList *directories);
+    void compare(QString directory, QStringList *added, QStringList *changed, QStringList *removed, QStringList *directories, QStringList *lost);
+    void send(const char *method, QStringList strings);
+};
+
+#endif // LAUDIRECTORYWATCHER_H
@@ -1,6 +1,7 @@
 #include "lauimage.h"
 
 #include <QScreen>
+#include <QImageReader>
 
 using namespace libtiff;
 
@@ -50,6 +51,7 @@ LAUImageData::LAUImageData()
     numProfileBytes = 0;
     fileString = QString();
     xmlByteArray.clear();
+    rgbaFlag = false;
 }
 
 /****************************************************************************/
@@ -69,6 +71,10 @@ LAUImageData::LAUImageData(const LAUImageData &other)
     yResolution = other.yResolution;
 
     xmlByteArray = other.xmlByteArray;
+    parentName = other.parentName;
+    pendingString = other.pendingString;
+    rgbaFlag = other.rgbaFlag;
+    buffer = nullptr;
 
     qDebug() << QString("Performing deep copy on %1").arg(fileString);
     if (other.pProfile) {
@@ -79,9 +85,13 @@ LAUImageData::LAUImageData(const LAUImageData &other)
         pProfile = nullptr;
         numProfileBytes = 0;
     }
-    allocateBuffer();
-    if (other.buffer != nullptr) {
-        memcpy(buffer, other.buffer, stepBytes * numRows);
+
+    // A METADATA ONLY COPY STAYS THAT WAY, IT WILL DECODE ITS OWN PIXELS WHEN TOUCHED
+    if (pendingString.isEmpty()) {
+        allocateBuffer();
+        if (other.buffer != nullptr) {
+            memcpy(buffer, other.buffer, stepBytes * numRows);
+        }
     }
 }
 
@@ -211,7 +221,7 @@ LAUImage::LAUImage(unsigned int rows, unsigned int cols, unsigned int chns, unsi
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
-LAUImage::LAUImage(QString filename)
+LAUImage::LAUImage(QString filename, LoadMode mode)
 {
     // IF WE HAVE A VALID TIFF FILE, LOAD FROM DISK
     // OTHERWISE TRY TO CONNECT TO SCANNER
@@ -235,15 +245,18 @@ LAUImage::LAUImage(QString filename)
             if (!inTiff) {
                 return;
             }
-            load(inTiff);
+            if (mode == LoadMetadata) {
+                loadHeader(inTiff);
+                data->pendingString = filename;
+            } else {
+                load(inTiff);
+            }
             TIFFClose(inTiff);
         } else {
-            // MAKE SURE WE HAVE A 24-BIT RGB IMAGE
-            QImage image = QImage(filename).convertToFormat(QImage::Format_RGB888);
-
-            data = new LAUImageData();
-            data->numRows = image.height();
-            data->numCols = image.width();
+            // THE IMAGE READER ONLY PARSES THE HEADER TO GET THE SIZE, PIXELS ARE ALWAYS 24-BIT RGB
+            QSize size = QImageReader(filename).size();
+            data->numRows = qMax(0, size.height());
+            data->numCols = qMax(0, size.width());
             data->numChns = 3;
             data->numByts = sizeof(unsigned char);
             data->photometric = PHOTOMETRIC_RGB;
@@ -255,24 +268,62 @@ LAUImage::LAUImage(QString filename)
             data->setProfile(rgbProfile);
             cmsCloseProfile(rgbProfile);
 
-            // ALLOCATE SPACE FOR HOLDING PIXEL DATA
-            data->allocateBuffer();
-
-            // COPY PIXELS OVER FROM SUPPLIED QIMAGE
-            for (unsigned int row = 0; row < height(); row++) {
-                unsigned char *buffer = (unsigned char *)scanLine(row);
-                for (unsigned int col = 0; col < width(); col++) {
-                    QColor pixel(image.pixel(col, row));
-                    buffer[3 * col + 0] = pixel.red();
-                    buffer[3 * col + 1] = pixel.green();
-                    buffer[3 * col + 2] = pixel.blue();
-                }
+            data->pendingString = filename;
+            if (mode == LoadAll) {
+                loadPixels();
             }
         }
     }
     data->fileString = filename;
 }
 
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImage::loadPixels()
+{
+    if (isMetadataOnly() == false) {
+        return (isNull() == false);
+    }
+
+    // CLEAR THE PENDING FILE FIRST SO THE SCAN LINE CALLS BELOW DON'T COME BACK HERE
+    QString filename = data->pendingString;
+    data->pendingString.clear();
+
+    if (filename.toLower().endsWith(".tif") || filename.toLower().endsWith(".tiff")) {
+        TIFF *inTiff = TIFFOpen(filename.toLatin1(), "r");
+        if (!inTiff) {
+            return (false);
+        }
+        bool flag = loadPixels(inTiff);
+        TIFFClose(inTiff);
+        return (flag);
+    }
+
+    // MAKE SURE WE HAVE A 24-BIT RGB IMAGE
+    QImage image = QImage(filename).convertToFormat(QImage::Format_RGB888);
+    if (image.isNull()) {
+        return (false);
+    }
+    data->numRows = image.height();
+    data->numCols = image.width();
+
+    // ALLOCATE SPACE FOR HOLDING PIXEL DATA
+    data->allocateBuffer();
+
+    // COPY PIXELS OVER FROM SUPPLIED QIMAGE
+    for (unsigned int row = 0; row < height(); row++) {
+        unsigned char *buffer = (unsigned char *)scanLine(row);
+        for (unsigned int col = 0; col < width(); col++) {
+            QColor pixel(image.pixel(col, row));
+            buffer[3 * col + 0] = pixel.red();
+            buffer[3 * col + 1] = pixel.green();
+            buffer[3 * col + 2] = pixel.blue();
+        }
+    }
+    return (true);
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
@@ -368,10 +419,38 @@ bool LAUImage::save(QString filename)
     return (true);
 }
 
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImage::save(QString filename, QByteArray xml) const
+{
+    // OPEN TIFF FILE FOR SAVING THE IMAGE
+    TIFF *outputTiff = TIFFOpen(filename.toLatin1(), "w");
+    if (!outputTiff) {
+        return (false);
+    }
+
+    // WRITE IMAGE TO CURRENT DIRECTORY, LEAVING OUR OWN FILENAME AND XML ALONE
+    bool flag = save(outputTiff, xml);
+
+    // CLOSE TIFF FILE
+    TIFFClose(outputTiff);
+
+    return (flag);
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
 bool LAUImage::save(TIFF *currentTiffDirectory)
+{
+    return (save(currentTiffDirectory, xmlData()));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImage::save(TIFF *currentTiffDirectory, QByteArray xmlByteArray) const
 {
     // WRITE FORMAT PARAMETERS TO CURRENT TIFF DIRECTORY
     TIFFSetField(currentTiffDirectory, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
@@ -423,7 +502,6 @@ bool LAUImage::save(TIFF *currentTiffDirectory)
     }
 
     // WRITE XML DATA IF IT EXISTS
-    QByteArray xmlByteArray = xmlData();
     if (xmlByteArray.length() > 0) {
         TIFFSetField(currentTiffDirectory, TIFFTAG_XMLPACKET, xmlByteArray.length(), xmlByteArray.data());
     }
@@ -446,23 +524,201 @@ bool LAUImage::save(TIFF *currentTiffDirectory)
     return (true);
 }
 
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QByteArray LAUImage::readXmlPacket(QString filename, QSize *size)
+{
+    // ONLY TIFF FILES HAVE AN XML PACKET TO READ
+    if (!filename.toLower().endsWith(".tif") && !filename.toLower().endsWith(".tiff")) {
+        if (size) {
+            // THE IMAGE READER ONLY PARSES THE HEADER TO ANSWER THIS
+            *size = QImageReader(filename).size();
+        }
+        return (QByteArray());
+    }
+
+    // OPENING THE FILE ONLY READS THE FIRST DIRECTORY, NOT THE PIXEL STRIPS
+    TIFF *inTiff = TIFFOpen(filename.toLatin1(), "r");
+    if (!inTiff) {
+        return (QByteArray());
+    }
+
+    if (size) {
+        unsigned int cols = 0, rows = 0;
+        TIFFGetField(inTiff, TIFFTAG_IMAGEWIDTH, &cols);
+        TIFFGetField(inTiff, TIFFTAG_IMAGELENGTH, &rows);
+        *size = QSize((int)cols, (int)rows);
+    }
+
+    QByteArray xml;
+    int dataLength = 0;
+    char *dataString = nullptr;
+    if (TIFFGetField(inTiff, TIFFTAG_XMLPACKET, &dataLength, &dataString)) {
+        // TRIM THE PACKET THE SAME WAY load() DOES SO BOTH RETURN THE SAME BYTES
+        QByteArray byteArray(dataString, dataLength);
+        int index = byteArray.lastIndexOf(QByteArray("\n"));
+        if (index > -1) {
+            xml = byteArray.left(index + 1);
+        }
+    }
+    TIFFClose(inTiff);
+
+    return (xml);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImage::updateXmlPacket(QString filename, QByteArray xml)
+{
+    // ONLY TIFF FILES HAVE AN XML PACKET TO REWRITE
+    if (!filename.toLower().endsWith(".tif") && !filename.toLower().endsWith(".tiff")) {
+        return (false);
+    }
+
+    // OPEN THE EXISTING FILE FOR UPDATING, WHICH READS IN THE FIRST DIRECTORY
+    TIFF *inOutTiff = TIFFOpen(filename.toLatin1(), "r+");
+    if (!inOutTiff) {
+        return (false);
+    }
+
+    // REPLACE THE XML PACKET IN THE IN-MEMORY COPY OF THE DIRECTORY
+    bool flag = false;
+    if (xml.length() > 0) {
+        flag = (TIFFSetField(inOutTiff, TIFFTAG_XMLPACKET, xml.length(), xml.data()) == 1);
+    } else {
+        flag = (TIFFUnsetField(inOutTiff, TIFFTAG_XMLPACKET) == 1);
+    }
+
+    // APPEND THE NEW DIRECTORY TO THE END OF THE FILE AND POINT THE HEADER AT IT, THE PIXEL
+    // STRIPS STAY WHERE THEY ARE AND THE OLD DIRECTORY IS LEFT BEHIND AS A FEW UNUSED BYTES
+    if (flag) {
+        flag = (TIFFRewriteDirectory(inOutTiff) == 1);
+    }
+    TIFFClose(inOutTiff);
+
+    return (flag);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImage::copyWithXmlPacket(QString fromString, QString toString, QByteArray xml)
+{
+    // ONLY TIFF FILES HAVE AN XML PACKET TO REWRITE
+    if (!fromString.toLower().endsWith(".tif") && !fromString.toLower().endsWith(".tiff")) {
+        return (false);
+    }
+
+    // COPY THE COMPRESSED BYTES AS IS AND THEN SWAP IN THE NEW XML PACKET
+    if (QFile::exists(toString)) {
+        QFile::remove(toString);
+    }
+    if (QFile::copy(fromString, toString) == false) {
+        return (false);
+    }
+
+    if (updateXmlPacket(toString, xml) == false) {
+        QFile::remove(toString);
+        return (false);
+    }
+    return (true);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImage LAUImage::loadReduced(QString filename, QSize size)
+{
+    // ONLY TIFF FILES ARE READ ONE SCAN LINE AT A TIME
+    if (!filename.toLower().endsWith(".tif") && !filename.toLower().endsWith(".tiff")) {
+        return (LAUImage(filename));
+    }
+
+    TIFF *inTiff = TIFFOpen(filename.toLatin1(), "r");
+    if (!inTiff) {
+        return (LAUImage());
+    }
+
+    LAUImage image;
+    image.loadHeader(inTiff);
+    image.data->fileString = filename;
+
+    unsigned short inChns = 0;
+    unsigned short planar = PLANARCONFIG_CONTIG;
+    TIFFGetField(inTiff, TIFFTAG_SAMPLESPERPIXEL, &inChns);
+    TIFFGetField(inTiff, TIFFTAG_PLANARCONFIG, &planar);
+
+    // KEEP EVERY STEP-TH PIXEL, WHICH LEAVES AT LEAST SIZE PIXELS IN BOTH DIRECTIONS
+    unsigned int step = 1;
+    if (size.width() > 0 && size.height() > 0) {
+        step = qMax(1u, qMin(image.width() / (unsigned int)size.width(), image.height() / (unsigned int)size.height()));
+    }
+
+    // THE ARGB PATH, PLANAR AND TILED FILES, AND SUB-BYTE SAMPLES ALL NEED THE FULL DECODE
+    if (step == 1 || image.data->rgbaFlag || planar != PLANARCONFIG_CONTIG || TIFFIsTiled(inTiff) || image.depth() == 0 || inChns < image.colors()) {
+        if (image.loadPixels(inTiff) == false) {
+            image = LAUImage();
+        }
+        TIFFClose(inTiff);
+        return (image);
+    }
+
+    image.data->numRows = image.height() / step;
+    image.data->numCols = image.width() / step;
+    image.data->allocateBuffer();
+    if (image.data->buffer == nullptr) {
+        TIFFClose(inTiff);
+        return (LAUImage());
+    }
+
+    // THE STRIPS STILL GET DECOMPRESSED, BUT THE SKIPPED ROWS ARE NEVER COPIED OR COLOR TRANSFORMED
+    unsigned int inBytes = inChns * image.depth();
+    unsigned int outBytes = image.colors() * image.depth();
+    unsigned char *tempBuffer = (unsigned char *)_TIFFmalloc(TIFFScanlineSize(inTiff));
+    bool flag = (tempBuffer != nullptr);
+    for (unsigned int row = 0; flag && row < image.height(); row++) {
+        flag = (TIFFReadScanline(inTiff, tempBuffer, row * step) == 1);
+        unsigned char *pBuffer = image.scanLine(row);
+        for (unsigned int col = 0; flag && col < image.width(); col++) {
+            memcpy(pBuffer + col * outBytes, tempBuffer + col * step * inBytes, outBytes);
+        }
+    }
+    if (tempBuffer) {
+        _TIFFfree(tempBuffer);
+    }
+    TIFFClose(inTiff);
+
+    if (flag == false) {
+        return (LAUImage());
+    }
+    return (image);
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
 bool LAUImage::load(TIFF *inTiff)
+{
+    loadHeader(inTiff);
+    return (loadPixels(inTiff));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImage::loadHeader(TIFF *inTiff)
 {
     // LOAD INPUT TIFF FILE PARAMETERS IMPORTANT TO RESAMPLING THE IMAGE
     unsigned long uLongVariable;
     unsigned short uShortVariable;
-    unsigned short inChns;
 
     // GET THE HEIGHT AND WIDTH OF INPUT IMAGE IN PIXELS
     TIFFGetField(inTiff, TIFFTAG_IMAGEWIDTH, &uLongVariable);
     data->numCols = uLongVariable;
     TIFFGetField(inTiff, TIFFTAG_IMAGELENGTH, &uLongVariable);
     data->numRows = uLongVariable;
-    TIFFGetField(inTiff, TIFFTAG_SAMPLESPERPIXEL, &uShortVariable);
-    inChns = uShortVariable;
     TIFFGetField(inTiff, TIFFTAG_BITSPERSAMPLE, &uShortVariable);
     data->numByts = uShortVariable / 8;
     TIFFGetField(inTiff, TIFFTAG_PHOTOMETRIC, &uShortVariable);
@@ -529,23 +785,47 @@ bool LAUImage::load(TIFF *inTiff)
             if (iccProfile == nullptr) {
                 iccProfile = cmsCreateGrayProfile(cmsD50_xyY(), cmsBuildGamma(0, 1.0));
             }
-        } else {
+        } else if (qobject_cast<QApplication *>(QCoreApplication::instance()) && QThread::currentThread() == qApp->thread()) {
+            // ONLY ASK THE USER FOR A PROFILE IF THERE IS A GUI AND WE AREN'T LOADING ON A WORKER THREAD
             iccProfile = LAUCMSWidget::loadProfileFromDisk(colors(), filename());
         }
     }
 
-    if (iccProfile == nullptr) {
+    data->rgbaFlag = (iccProfile == nullptr);
+    if (data->rgbaFlag) {
         // WITHOUT AN ICC PROFILE, WE NEED TO OPEN THE FILE AS ARGB AND THEN CONVERT TO RGB
         data->numChns = 3;
         data->numByts = 1;
         data->photometric = PHOTOMETRIC_RGB;
 
-        // ALLOCATE SPACE TO HOLD IMAGE DATA
-        data->allocateBuffer();
-
         // CREATE TRANSFORM FROM THIS PROFILE TO RGB, IF IT ISN'T ALREADY IN AN RGB PROFILE
         iccProfile = cmsCreate_sRGBProfile();
+    } else {
+        // LET THE ICC PROFILE DEFINE HOW MANY CHANNELS IN THE OUTPUT IMAGE
+        data->numChns = LAUCMSWidget::howManyColorsDoesThisProfileHave(iccProfile);
+    }
 
+    // SAVE THE ICC PROFILE TO THE DATA OBJECT
+    data->setProfile(iccProfile);
+    cmsCloseProfile(iccProfile);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImage::loadPixels(TIFF *inTiff)
+{
+    // ALLOCATE SPACE TO HOLD IMAGE DATA IN THE COLOR SPACE THE HEADER SETTLED ON
+    data->allocateBuffer();
+    if (data->buffer == nullptr) {
+        return (false);
+    }
+
+    unsigned short uShortVariable = 0;
+    TIFFGetField(inTiff, TIFFTAG_SAMPLESPERPIXEL, &uShortVariable);
+    unsigned short inChns = uShortVariable;
+
+    if (data->rgbaFlag) {
         // READ THE IMAGE INTO MEMORY USING THE ARGB UTILITIES PROVIDED BY LIBTIFF
         int numPixels = data->numCols * data->numRows;
         unsigned char *buffer = (unsigned char *)_TIFFmalloc(numPixels * sizeof(uint32));
@@ -560,12 +840,6 @@ bool LAUImage::load(TIFF *inTiff)
             _TIFFfree(buffer);
         }
     } else {
-        // LET THE ICC PROFILE DEFINE HOW MANY CHANNELS IN THE OUTPUT IMAGE
-        data->numChns = LAUCMSWidget::howManyColorsDoesThisProfileHave(iccProfile);
-
-        // ALLOCATE SPACE TO HOLD IMAGE DATA
-        data->allocateBuffer();
-
         // FIND OUT IF THE IMAGE HAS ALPHA OR SPOT CHANNELS
         bool hasAlphaChannels = (data->numChns != inChns);
 
@@ -657,10 +931,6 @@ bool LAUImage::load(TIFF *inTiff)
         }
     }
 
-    // SAVE THE ICC PROFILE TO THE DATA OBJECT
-    data->setProfile(iccProfile);
-    cmsCloseProfile(iccProfile);
-
     return (true); //wasNotCancelledFlag);
 }
 
@@ -680,6 +950,216 @@ void LAUImage::replace(const LAUImage &other)
     data = other.data;
 }
 
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImage::fill(double value)
+{
+    IppiSize roi = {(int)(width() * colors()), (int)height()};
+    if (depth() == sizeof(unsigned char)) {
+        ippiSet_8u_C1R((Ipp8u)qBound(0.0, value, 255.0), (Ipp8u *)scanLine(0), step(), roi);
+    } else if (depth() == sizeof(unsigned short)) {
+        ippiSet_16u_C1R((Ipp16u)qBound(0.0, value, 65535.0), (Ipp16u *)scanLine(0), step(), roi);
+    } else if (depth() == sizeof(float)) {
+        ippiSet_32f_C1R((Ipp32f)value, (Ipp32f *)scanLine(0), step(), roi);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImage::rescaleInto(QRect rect, LAUImage *image, IppiInterpolationType interpolation, double border)
+{
+    // THE DESTINATION HAS TO LOOK JUST LIKE US APART FROM ITS SIZE, SINCE NOTHING HERE CONVERTS PIXELS
+    if (image == nullptr || image == this || image->isNull() || isNull() || rect.isEmpty()) {
+        return (false);
+    } else if (image->depth() != depth() || image->colors() != colors()) {
+        return (false);
+    } else if (colors() != 1 && colors() != 3 && colors() != 4) {
+        return (false);
+    } else if (interpolation != ippNearest && interpolation != ippLinear) {
+        return (false);
+    }
+
+    IppiSize srcSize = {rect.width(), rect.height()};
+    IppiSize dstSize = image->size();
+    unsigned int bytesPerPixel = depth() * colors();
+
+    // THE PART OF RECT THAT IS ACTUALLY ON THIS IMAGE, WHICH IS ALL OF IT IN THE USUAL CASE
+    QRect inside = rect.intersected(QRect(0, 0, (int)width(), (int)height()));
+
+    // ONLY THE DESTINATION PIXELS THAT SAMPLE FROM INSIDE ARE RESAMPLED, AS A TILE OF THE FULL RESIZE
+    IppiPoint dstOffset = {0, 0};
+    IppiSize tileSize = dstSize;
+    if (inside != rect) {
+        image->fill(border);
+        if (inside.isEmpty()) {
+            return (true);
+        }
+
+        if (interpolation != ippNearest) {
+            // LINEAR READS NEIGHBORS THAT MAY NOT EXIST, SO PAD THE ROI OUT TO A SCRATCH IMAGE IN THIS RARE CASE
+            LAUImage scratch(rect.height(), rect.width(), colors(), depth());
+            scratch.fill(border);
+            for (int r = inside.top(); r <= inside.bottom(); r++) {
+                memcpy(scratch.scanLine(r - rect.top()) + (inside.left() - rect.left()) * bytesPerPixel, constScanLine(r) + inside.left() * bytesPerPixel, inside.width() * bytesPerPixel);
+            }
+            return (scratch.rescaleInto(QRect(0, 0, rect.width(), rect.height()), image, interpolation, border));
+        }
+
+        // KEEP TO DESTINATION PIXELS WHOSE NEAREST SOURCE PIXEL IS SURELY INSIDE, IN COORDINATES RELATIVE TO RECT
+        double xScale = (double)dstSize.width / (double)srcSize.width;
+        double yScale = (double)dstSize.height / (double)srcSize.height;
+        int left = qBound(0, (int)qCeil((inside.left() - rect.left() + 0.5) * xScale - 0.5), dstSize.width);
+        int right = qBound(0, (int)qFloor((inside.right() + 1 - rect.left() - 0.5) * xScale - 0.5) + 1, dstSize.width);
+        int top = qBound(0, (int)qCeil((inside.top() - rect.top() + 0.5) * yScale - 0.5), dstSize.height);
+        int bottom = qBound(0, (int)qFloor((inside.bottom() + 1 - rect.top() - 0.5) * yScale - 0.5) + 1, dstSize.height);
+        if (right <= left || bottom <= top) {
+            return (true);
+        }
+        dstOffset.x = left;
+        dstOffset.y = top;
+        tileSize.width = right - left;
+        tileSize.height = bottom - top;
+    }
+
+    // DECLARE VARIABLES FOR INTEL'S RESIZING FUNCTIONS
+    IppiResizeSpec_32f *pSpec = nullptr;
+    int specSize = 0, initSize = 0, bufSize = 0;
+    Ipp8u *pBuffer = nullptr;
+    IppiPoint srcOffset = {0, 0};
+    IppStatus status = ippStsErr;
+
+    if (depth() == sizeof(unsigned char)) {
+        status = ippiResizeGetSize_8u(srcSize, dstSize, interpolation, 0, &specSize, &initSize);
+    } else if (depth() == sizeof(unsigned short)) {
+        status = ippiResizeGetSize_16u(srcSize, dstSize, interpolation, 0, &specSize, &initSize);
+    } else if (depth() == sizeof(float)) {
+        status = ippiResizeGetSize_32f(srcSize, dstSize, interpolation, 0, &specSize, &initSize);
+    }
+    if (status != ippStsNoErr) {
+        return (false);
+    }
+
+    pSpec = (IppiResizeSpec_32f *)ippsMalloc_8u(specSize);
+    if (pSpec == nullptr) {
+        return (false);
+    }
+
+    if (depth() == sizeof(unsigned char)) {
+        status = (interpolation == ippNearest) ? ippiResizeNearestInit_8u(srcSize, dstSize, pSpec) : ippiResizeLinearInit_8u(srcSize, dstSize, pSpec);
+        if (status == ippStsNoErr) {
+            status = ippiResizeGetSrcOffset_8u(pSpec, dstOffset, &srcOffset);
+        }
+    } else if (depth() == sizeof(unsigned short)) {
+        status = (interpolation == ippNearest) ? ippiResizeNearestInit_16u(srcSize, dstSize, pSpec) : ippiResizeLinearInit_16u(srcSize, dstSize, pSpec);
+        if (status == ippStsNoErr) {
+            status = ippiResizeGetSrcOffset_16u(pSpec, dstOffset, &srcOffset);
+        }
+    } else {
+        status = (interpolation == ippNearest) ? ippiResizeNearestInit_32f(srcSize, dstSize, pSpec) : ippiResizeLinearInit_32f(srcSize, dstSize, pSpec);
+        if (status == ippStsNoErr) {
+            status = ippiResizeGetSrcOffset_32f(pSpec, dstOffset, &srcOffset);
+        }
+    }
+
+    if (status == ippStsNoErr && ippiResizeGetBufferSize_8u(pSpec, tileSize, colors(), &bufSize) == ippStsNoErr) {
+        pBuffer = (Ipp8u *)ippsMalloc_8u(bufSize);
+    }
+
+    if (pBuffer) {
+        // POINT STRAIGHT AT THE SOURCE PIXELS UNDER THE TILE, NO COPY OF THE ROI IS EVER MADE
+        const unsigned char *fromBuffer = constScanLine(rect.top() + srcOffset.y) + (rect.left() + srcOffset.x) * bytesPerPixel;
+        unsigned char *toBuffer = image->scanLine(dstOffset.y) + dstOffset.x * bytesPerPixel;
+
+        if (depth() == sizeof(unsigned char)) {
+            if (interpolation == ippNearest) {
+                switch (colors()) {
+                    case 1:
+                        status = ippiResizeNearest_8u_C1R((const Ipp8u *)fromBuffer, step(), (Ipp8u *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                    case 3:
+                        status = ippiResizeNearest_8u_C3R((const Ipp8u *)fromBuffer, step(), (Ipp8u *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                    case 4:
+                        status = ippiResizeNearest_8u_C4R((const Ipp8u *)fromBuffer, step(), (Ipp8u *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                }
+            } else {
+                switch (colors()) {
+                    case 1:
+                        status = ippiResizeLinear_8u_C1R((const Ipp8u *)fromBuffer, step(), (Ipp8u *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                    case 3:
+                        status = ippiResizeLinear_8u_C3R((const Ipp8u *)fromBuffer, step(), (Ipp8u *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                    case 4:
+                        status = ippiResizeLinear_8u_C4R((const Ipp8u *)fromBuffer, step(), (Ipp8u *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                }
+            }
+        } else if (depth() == sizeof(unsigned short)) {
+            if (interpolation == ippNearest) {
+                switch (colors()) {
+                    case 1:
+                        status = ippiResizeNearest_16u_C1R((const Ipp16u *)fromBuffer, step(), (Ipp16u *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                    case 3:
+                        status = ippiResizeNearest_16u_C3R((const Ipp16u *)fromBuffer, step(), (Ipp16u *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                    case 4:
+                        status = ippiResizeNearest_16u_C4R((const Ipp16u *)fromBuffer, step(), (Ipp16u *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                }
+            } else {
+                switch (colors()) {
+                    case 1:
+                        status = ippiResizeLinear_16u_C1R((const Ipp16u *)fromBuffer, step(), (Ipp16u *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                    case 3:
+                        status = ippiResizeLinear_16u_C3R((const Ipp16u *)fromBuffer, step(), (Ipp16u *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                    case 4:
+                        status = ippiResizeLinear_16u_C4R((const Ipp16u *)fromBuffer, step(), (Ipp16u *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                }
+            }
+        } else {
+            if (interpolation == ippNearest) {
+                switch (colors()) {
+                    case 1:
+                        status = ippiResizeNearest_32f_C1R((const Ipp32f *)fromBuffer, step(), (Ipp32f *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                    case 3:
+                        status = ippiResizeNearest_32f_C3R((const Ipp32f *)fromBuffer, step(), (Ipp32f *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                    case 4:
+                        status = ippiResizeNearest_32f_C4R((const Ipp32f *)fromBuffer, step(), (Ipp32f *)toBuffer, image->step(), dstOffset, tileSize, pSpec, pBuffer);
+                        break;
+                }
+            } else {
+                switch (colors()) {
+                    case 1:
+                        status = ippiResizeLinear_32f_C1R((const Ipp32f *)fromBuffer, step(), (Ipp32f *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                    case 3:
+                        status = ippiResizeLinear_32f_C3R((const Ipp32f *)fromBuffer, step(), (Ipp32f *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                    case 4:
+                        status = ippiResizeLinear_32f_C4R((const Ipp32f *)fromBuffer, step(), (Ipp32f *)toBuffer, image->step(), dstOffset, tileSize, ippBorderRepl, 0, pSpec, pBuffer);
+                        break;
+                }
+            }
+        }
+        ippsFree(pBuffer);
+    } else {
+        status = ippStsNoMemErr;
+    }
+    ippsFree(pSpec);
+
+    return (status == ippStsNoErr);
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
@@ -691,6 +1171,34 @@ cmsHPROFILE LAUImage::profile()
     return (nullptr);
 }
 
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImage::copyProfile(const LAUImage &other)
+{
+    // NOTHING TO DO IF WE ALREADY CARRY THE SAME BYTES, WHICH IS THE USUAL CASE FOR FRAMES FROM ONE CAMERA
+    if (numProfileBytes() == other.numProfileBytes() && (numProfileBytes() == 0 || memcmp(pProfile(), other.pProfile(), numProfileBytes()) == 0)) {
+        data->photometric = other.data->photometric;
+        return (true);
+    }
+
+    if (data->pProfile) {
+        free(data->pProfile);
+        data->pProfile = nullptr;
+        data->numProfileBytes = 0;
+    }
+    if (other.pProfile()) {
+        data->pProfile = (unsigned char *)malloc(other.numProfileBytes());
+        if (data->pProfile == nullptr) {
+            return (false);
+        }
+        memcpy(data->pProfile, other.pProfile(), other.numProfileBytes());
+        data->numProfileBytes = other.numProfileBytes();
+    }
+    data->photometric = other.data->photometric;
+    return (true);
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
@@ -1492,7 +2000,8 @@ LAUImage LAUImage::convertToBinary(QString method)
 /****************************************************************************/
 LAUImage LAUImage::crop(unsigned int x, unsigned int y, unsigned int w, unsigned int h)
 {
-    LAUImage image(h, w, depth(), profile(), data->xResolution, data->yResolution);
+    // STICK TO CONST ACCESSORS SO CROPPING AN IMPLICITLY SHARED IMAGE DOESN'T DETACH IT
+    LAUImage image(h, w, depth(), profile(), xRes(), yRes());
     image.setParentName(parentName());
     image.setXmlData(xmlData());
 
@@ -2132,7 +2641,6 @@ bool LAUImage::rescaleToDisk(QString fileString, unsigned int rows, unsigned int
     }
 
     // WRITE XML DATA IF IT EXISTS
-    QByteArray xmlByteArray = xmlData();
     if (xmlByteArray.length() > 0) {
         TIFFSetField(outputTiff, TIFFTAG_XMLPACKET, xmlByteArray.length(), xmlByteArray.data());
     }
@@ -68,6 +68,10 @@ public:
     QByteArray parentName;
     void *buffer;
 
+    // FILE TO DECODE THE PIXELS FROM WHEN A METADATA ONLY IMAGE IS FIRST TOUCHED
+    QString pendingString;
+    bool rgbaFlag;
+
     static int instanceCounter;
 
     void allocateBuffer();
@@ -81,7 +85,10 @@ class LAUImage : public QObject
 public:
     explicit LAUImage(unsigned int rows, unsigned int cols, unsigned int dpth, cmsHPROFILE iccProfile, float xRes = 72.0, float yRes = 72.0);
     explicit LAUImage(unsigned int rows = 0, unsigned int cols = 0, unsigned int chns = 0, unsigned int dpth = 0, float xRes = 72.0, float yRes = 72.0);
-    explicit LAUImage(const QString filename);
+    // METADATA ONLY IMAGES PARSE THE HEADER NOW AND DECODE THEIR PIXELS THE FIRST TIME A SCAN LINE IS ASKED FOR
+    enum LoadMode { LoadAll, LoadMetadata };
+
+    explicit LAUImage(const QString filename, LoadMode mode = LoadAll);
     ~LAUImage();
 
     LAUImage(libtiff::TIFF *currentTiffDirectory);
@@ -103,8 +110,33 @@ public:
 
     bool save(QString fileName = QString());
     bool save(libtiff::TIFF *currentTiffDirectory);
+
+    // WRITE THE PIXELS WITH ANOTHER XML PACKET, WITHOUT DETACHING FROM THE IMAGES THAT SHARE THEM
+    bool save(QString fileName, QByteArray xml) const;
+    bool save(libtiff::TIFF *currentTiffDirectory, QByteArray xml) const;
     bool load(libtiff::TIFF *inTiff);
 
+    // READ JUST THE XML PACKET OF A TIFF FILE ON DISK WITHOUT DECODING ITS PIXELS, AND ITS DIMENSIONS IF ASKED
+    static QByteArray readXmlPacket(QString filename, QSize *size = nullptr);
+
+    // REWRITE JUST THE XML PACKET OF A TIFF FILE ON DISK WITHOUT TOUCHING ITS PIXELS, WHICH BRIEFLY LEAVES THE FILE
+    // WITHOUT A DIRECTORY, SO ONLY EVER DO IT TO A COPY THE WAY COPYWITHXMLPACKET DOES
+    static bool updateXmlPacket(QString filename, QByteArray xml);
+    static bool copyWithXmlPacket(QString fromString, QString toString, QByteArray xml);
+
+    // DECODE ONLY EVERY FEW ROWS AND COLUMNS OF A TIFF FILE SO THE RESULT IS NO SMALLER THAN SIZE, FOR
+    // THUMBNAILS, AND FALL BACK TO A FULL DECODE FOR FILES THAT CAN'T BE READ ONE SCAN LINE AT A TIME
+    static LAUImage loadReduced(QString filename, QSize size);
+
+    // DECODE THE PIXELS OF A METADATA ONLY IMAGE NOW INSTEAD OF ON FIRST ACCESS, COPIES MADE BEFORE THIS DECODE THEIR OWN
+    bool loadPixels();
+
+    // NOT SAFE TO SHARE ACROSS THREADS UNTIL THIS RETURNS FALSE, SINCE THE FIRST READER DECODES THE PIXELS
+    inline bool isMetadataOnly() const
+    {
+        return (data->pendingString.isEmpty() == false);
+    }
+
     bool loadInto(QString filename, cmsHPROFILE inProfile);
     bool loadInto(libtiff::TIFF *inTiff, cmsHPROFILE inProfile);
 
@@ -115,7 +147,7 @@ public:
 
     inline bool isNull() const
     {
-        return (data->buffer == nullptr);
+        return (data->buffer == nullptr && data->pendingString.isEmpty());
     }
 
     inline void setFilename(const QString string)
@@ -211,13 +243,22 @@ public:
         return (data->setProfile(iccProfile));
     }
 
+    // TAKE THE ICC PROFILE BYTES OF ANOTHER IMAGE AS THEY ARE, WITHOUT OPENING THEM AS A PROFILE
+    bool copyProfile(const LAUImage &other);
+
     inline unsigned char *scanLine(unsigned int row)
     {
+        if (isMetadataOnly()) {
+            loadPixels();
+        }
         return (&(((unsigned char *)(data->buffer))[row * step()]));
     }
 
     inline unsigned char *constScanLine(unsigned int row) const
     {
+        if (isMetadataOnly()) {
+            const_cast<LAUImage *>(this)->loadPixels();
+        }
         return (&(((unsigned char *)(data->buffer))[row * step()]));
     }
 
@@ -250,6 +291,10 @@ public:
     LAUImage zeroPad(int left, int top, int right, int bottom);
     LAUImage extractChannel(unsigned int channel);
     LAUImage rescale(unsigned int rows, unsigned int cols, Qt::AspectRatioMode aspectRatioMode = Qt::IgnoreAspectRatio, IppiInterpolationType interpolation = ippNearest);
+
+    // CROP AND RESCALE IN ONE PASS, RESAMPLING RECT STRAIGHT INTO AN IMAGE THE CALLER ALLOCATED WITH THE SAME DEPTH AND COLORS,
+    // WITH ANY PART OF RECT OFF THE EDGE OF THIS IMAGE FILLED WITH BORDER, ONLY NEAREST AND LINEAR INTERPOLATION ARE SUPPORTED
+    bool rescaleInto(QRect rect, LAUImage *image, IppiInterpolationType interpolation = ippNearest, double border = 0.0);
     LAUImage stretch(unsigned int rows, double cols);
     bool rescaleToDisk(QString fileString, unsigned int rows, unsigned int cols, IppiInterpolationType interpolation = ippNearest, QWidget *parent = nullptr);
 
@@ -262,6 +307,13 @@ private:
     QImage previewImage;
     QSharedDataPointer<LAUImageData> data;
 
+    // LOAD IS SPLIT SO THE TAGS AND COLOR SPACE CAN BE READ WITHOUT TOUCHING THE STRIPS
+    void loadHeader(libtiff::TIFF *inTiff);
+    bool loadPixels(libtiff::TIFF *inTiff);
+
+    // SET EVERY PIXEL OF EVERY CHANNEL TO VALUE
+    void fill(double value);
+
     inline unsigned char *pProfile() const
     {
         return (data->pProfile);
@@ -280,4 +332,6 @@ private:
     }
 };
 
+Q_DECLARE_METATYPE(LAUImage);
+
 #endif // LAUIMAGE_H
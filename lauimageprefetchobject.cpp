@@ -0,0 +1,232 @@
+#include "lauimageprefetchobject.h"
+
+#include <QMutexLocker>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePrefetchTask::run()
+{
+    // DON'T BOTHER DECODING IF THE CURSOR MOVED AWAY WHILE WE WERE QUEUED
+    if (object->isWanted(fileString, ticket) == false) {
+        QMetaObject::invokeMethod(object, "onTaskComplete", Qt::QueuedConnection, Q_ARG(QString, fileString), Q_ARG(unsigned int, ticket), Q_ARG(LAUImage, LAUImage()), Q_ARG(QImage, QImage()));
+        return;
+    }
+
+    // DECODE THE IMAGE FROM DISK
+    LAUImage image(fileString);
+
+    // CHECK AGAIN BEFORE SPENDING TIME ON THE COLOR MANAGED PREVIEW
+    QImage preview;
+    if (image.isValid() && object->isWanted(fileString, ticket)) {
+        preview = LAUImagePrefetchObject::preview(image);
+    }
+
+    // HAND THE RESULTS BACK TO THE GUI THREAD
+    QMetaObject::invokeMethod(object, "onTaskComplete", Qt::QueuedConnection, Q_ARG(QString, fileString), Q_ARG(unsigned int, ticket), Q_ARG(LAUImage, image), Q_ARG(QImage, preview));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImagePrefetchObject::LAUImagePrefetchObject(qint64 bytes, QObject *parent) : QObject(parent), maxBytes(bytes), numBytes(0), ticketCounter(0)
+{
+    qRegisterMetaType<LAUImage>("LAUImage");
+
+    // LEAVE HALF THE CORES FOR THE GUI AND WHATEVER ELSE IS RUNNING
+    threadPool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImagePrefetchObject::~LAUImagePrefetchObject()
+{
+    // CANCEL EVERYTHING AND WAIT FOR THE RUNNING TASKS SINCE THEY HOLD A POINTER TO US
+    mutex.lock();
+    tickets.clear();
+    mutex.unlock();
+
+    threadPool.clear();
+    threadPool.waitForDone();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePrefetchObject::setMaximumBytes(qint64 bytes)
+{
+    maxBytes = bytes;
+    evict();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePrefetchObject::setCursor(QStringList strings)
+{
+    cursorStrings = strings;
+
+    // RELEASE MEMORY HELD BY IMAGES THAT ARE NOW OUTSIDE THE WINDOW
+    evict();
+
+    // ESTIMATE THE COST OF A NEW IMAGE FROM THE ONES WE ALREADY HOLD
+    qint64 estimate = packets.isEmpty() ? 0 : numBytes / packets.count();
+    qint64 budget = numBytes;
+
+    QStringList newStrings;
+    QList<unsigned int> newTickets;
+    mutex.lock();
+
+    // DROP ANY PENDING TASKS THAT FELL OUT OF THE WINDOW SO THE WORKERS SKIP THEM
+    QStringList pendingStrings = tickets.keys();
+    for (int n = 0; n < pendingStrings.count(); n++) {
+        if (cursorStrings.contains(pendingStrings.at(n)) == false) {
+            tickets.remove(pendingStrings.at(n));
+        }
+    }
+
+    // ISSUE NEW TASKS IN ORDER OF PRIORITY UNTIL WE RUN OUT OF MEMORY BUDGET
+    for (int n = 0; n < cursorStrings.count(); n++) {
+        QString string = cursorStrings.at(n);
+        if (packets.contains(string)) {
+            continue;
+        }
+        budget += estimate;
+        if (n > 0 && budget > maxBytes) {
+            tickets.remove(string);
+        } else if (tickets.contains(string) == false) {
+            tickets[string] = ++ticketCounter;
+            newStrings << string;
+            newTickets << ticketCounter;
+        }
+    }
+    mutex.unlock();
+
+    // HIGHER PRIORITY FOR FILES CLOSER TO THE FRONT OF THE CURSOR LIST
+    for (int n = 0; n < newStrings.count(); n++) {
+        int priority = cursorStrings.count() - cursorStrings.indexOf(newStrings.at(n));
+        threadPool.start(new LAUImagePrefetchTask(newStrings.at(n), newTickets.at(n), this), priority);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImagePrefetchObject::isWanted(QString filename, unsigned int ticket) const
+{
+    QMutexLocker locker(&mutex);
+    return (tickets.value(filename, 0) == ticket);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImagePrefetchObject::image(QString filename, LAUImage *image, QPixmap *pixmap) const
+{
+    if (packets.contains(filename)) {
+        const Packet &packet = packets[filename];
+        *image = packet.image;
+        *pixmap = packet.pixmap;
+        return (true);
+    }
+    return (false);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePrefetchObject::insert(QString filename, LAUImage image, QPixmap pixmap)
+{
+    // ANY PENDING TASK FOR THIS FILE IS NOW REDUNDANT
+    mutex.lock();
+    tickets.remove(filename);
+    mutex.unlock();
+
+    remove(filename);
+
+    Packet packet;
+    packet.image = image;
+    packet.pixmap = pixmap;
+    packet.bytes  = (qint64)image.height() * (qint64)image.step();
+    packet.bytes += (qint64)pixmap.width() * (qint64)pixmap.height() * (qint64)(pixmap.depth() / 8);
+
+    packets[filename] = packet;
+    numBytes += packet.bytes;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePrefetchObject::remove(QString filename)
+{
+    // INVALIDATE ANY TASK IN FLIGHT SO IT DOESN'T PUT BACK A STALE COPY
+    mutex.lock();
+    tickets.remove(filename);
+    mutex.unlock();
+
+    if (packets.contains(filename)) {
+        numBytes -= packets.take(filename).bytes;
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePrefetchObject::clear()
+{
+    mutex.lock();
+    tickets.clear();
+    mutex.unlock();
+
+    cursorStrings.clear();
+    packets.clear();
+    numBytes = 0;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePrefetchObject::onTaskComplete(QString filename, unsigned int ticket, LAUImage image, QImage preview)
+{
+    // THROW AWAY RESULTS FOR TASKS THAT WERE CANCELLED WHILE THEY RAN
+    mutex.lock();
+    bool flag = (tickets.value(filename, 0) == ticket);
+    if (flag) {
+        tickets.remove(filename);
+    }
+    mutex.unlock();
+
+    if (flag == false || image.isNull() || preview.isNull()) {
+        return;
+    }
+
+    // PIXMAPS CAN ONLY BE CREATED ON THE GUI THREAD
+    insert(filename, image, QPixmap::fromImage(preview));
+    evict();
+
+    if (packets.contains(filename)) {
+        emit emitImageReady(filename);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePrefetchObject::evict()
+{
+    // FIRST RELEASE EVERYTHING THAT IS NO LONGER AROUND THE CURSOR
+    QStringList strings = packets.keys();
+    for (int n = 0; n < strings.count(); n++) {
+        if (cursorStrings.contains(strings.at(n)) == false) {
+            numBytes -= packets.take(strings.at(n)).bytes;
+        }
+    }
+
+    // THEN RELEASE THE LOWEST PRIORITY IMAGES, BUT NEVER THE CURRENT ONE
+    for (int n = cursorStrings.count() - 1; n > 0 && numBytes > maxBytes; n--) {
+        if (packets.contains(cursorStrings.at(n))) {
+            numBytes -= packets.take(cursorStrings.at(n)).bytes;
+        }
+    }
+}
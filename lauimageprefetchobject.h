@@ -0,0 +1,109 @@
+#ifndef LAUIMAGEPREFETCHOBJECT_H
+#define LAUIMAGEPREFETCHOBJECT_H
+
+#include <QHash>
+#include <QMutex>
+#include <QImage>
+#include <QPixmap>
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QStringList>
+
+#include "lauimage.h"
+#include "lauimagepreviewcache.h"
+
+#define LAUIMAGEPREFETCHAHEAD           4
+#define LAUIMAGEPREFETCHBEHIND          4
+#define LAUIMAGEPREFETCHMEGABYTES       2048
+#define LAUIMAGEPREFETCHPREVIEWSIZE     LAUIMAGEPREVIEWCACHELARGE
+
+class LAUImagePrefetchObject;
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUImagePrefetchTask : public QRunnable
+{
+public:
+    LAUImagePrefetchTask(QString filename, unsigned int tckt, LAUImagePrefetchObject *obj) : fileString(filename), ticket(tckt), object(obj) { ; }
+
+    QString filename() const
+    {
+        return (fileString);
+    }
+
+protected:
+    void run();
+
+private:
+    QString fileString;
+    unsigned int ticket;
+    LAUImagePrefetchObject *object;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUImagePrefetchObject : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LAUImagePrefetchObject(qint64 bytes = (qint64)LAUIMAGEPREFETCHMEGABYTES * 1024 * 1024, QObject *parent = nullptr);
+    ~LAUImagePrefetchObject();
+
+    // SET THE UPPER LIMIT ON THE MEMORY HELD BY DECODED IMAGES AND THEIR PIXMAPS
+    void setMaximumBytes(qint64 bytes);
+    qint64 maximumBytes() const
+    {
+        return (maxBytes);
+    }
+
+    // LIST OF FILES AROUND THE CURSOR IN ORDER OF PRIORITY, CURRENT IMAGE FIRST
+    void setCursor(QStringList strings);
+
+    // THESE METHODS ARE CALLED FROM THE GUI THREAD ONLY
+    bool image(QString filename, LAUImage *image, QPixmap *pixmap) const;
+    void insert(QString filename, LAUImage image, QPixmap pixmap);
+    void remove(QString filename);
+    void clear();
+
+    // THIS METHOD IS CALLED FROM THE WORKER THREADS
+    bool isWanted(QString filename, unsigned int ticket) const;
+
+    // THIS IS THE OVERVIEW EVERY DISPLAYED IMAGE IS DRAWN FROM, THE VIEWER ADDS TILES WHEN IT NEEDS MORE DETAIL
+    static QImage preview(LAUImage image)
+    {
+        return (LAUImagePreviewCache::preview(image, LAUIMAGEPREFETCHPREVIEWSIZE));
+    }
+
+public slots:
+    void onTaskComplete(QString filename, unsigned int ticket, LAUImage image, QImage preview);
+
+private:
+    typedef struct {
+        LAUImage image;
+        QPixmap pixmap;
+        qint64 bytes;
+    } Packet;
+
+    qint64 maxBytes;
+    qint64 numBytes;
+    unsigned int ticketCounter;
+
+    QThreadPool threadPool;
+    QStringList cursorStrings;
+    QHash<QString, Packet> packets;
+
+    // TICKETS OF PENDING TASKS ARE SHARED WITH THE WORKER THREADS
+    mutable QMutex mutex;
+    QHash<QString, unsigned int> tickets;
+
+    void evict();
+
+signals:
+    void emitImageReady(QString filename);
+};
+
+#endif // LAUIMAGEPREFETCHOBJECT_H
@@ -0,0 +1,182 @@
+#include "lauimagepreviewcache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+QMutex LAUImagePreviewCache::mutex;
+qint64 LAUImagePreviewCache::maxBytes = (qint64)LAUIMAGEPREVIEWCACHEMEGABYTES * 1024 * 1024;
+qint64 LAUImagePreviewCache::numBytes = -1;
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QImage LAUImagePreviewCache::preview(LAUImage image, int size)
+{
+    // WORK OUT THE SIZE THE PREVIEW SHOULD BE, NEVER BIGGER THAN THE IMAGE ITSELF
+    QSize previewSize(image.width(), image.height());
+    if ((int)image.width() > size || (int)image.height() > size) {
+        previewSize.scale(size, size, Qt::KeepAspectRatio);
+    }
+
+    // ONLY TRUST A CACHED PREVIEW IF IT HAS THE SHAPE WE EXPECT FOR THIS IMAGE
+    QImage preview = lookup(image.filename(), size);
+    if (preview.isNull() == false && qAbs(preview.width() - previewSize.width()) <= 1 && qAbs(preview.height() - previewSize.height()) <= 1) {
+        return (preview);
+    }
+
+    preview = image.preview(previewSize, Qt::KeepAspectRatio);
+    insert(image.filename(), size, preview);
+
+    return (preview);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QImage LAUImagePreviewCache::lookup(QString filename, int size)
+{
+    QFileInfo fileInfo(filename);
+    if (filename.isEmpty() || fileInfo.exists() == false) {
+        return (QImage());
+    }
+
+    QString cacheString = cacheFilename(fileInfo.absoluteFilePath(), fileInfo.size(), fileInfo.lastModified(), size);
+
+    QImage image;
+    if (image.load(cacheString, "JPG") == false) {
+        return (QImage());
+    }
+
+    // TOUCH THE FILE SO EVICTION SEES IT AS RECENTLY USED
+    QFile file(cacheString);
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        file.close();
+    }
+
+    return (image.convertToFormat(QImage::Format_RGB888));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePreviewCache::insert(QString filename, int size, QImage image)
+{
+    QFileInfo fileInfo(filename);
+    if (filename.isEmpty() || fileInfo.exists() == false || image.isNull()) {
+        return;
+    }
+
+    QString directoryString = directory();
+    if (QDir().mkpath(directoryString) == false) {
+        return;
+    }
+
+    // QSAVEFILE WRITES TO A TEMPORARY FILE AND RENAMES IT SO OTHER THREADS NEVER READ HALF A PREVIEW
+    QSaveFile file(cacheFilename(fileInfo.absoluteFilePath(), fileInfo.size(), fileInfo.lastModified(), size));
+    if (file.open(QIODevice::WriteOnly) == false) {
+        return;
+    }
+    if (image.save(&file, "JPG", LAUIMAGEPREVIEWCACHEQUALITY) == false || file.commit() == false) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    if (numBytes < 0) {
+        evict();
+    } else {
+        numBytes += QFileInfo(file.fileName()).size();
+        if (numBytes > maxBytes) {
+            evict();
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePreviewCache::carryForward(QString filename, qint64 oldBytes, QDateTime oldTime)
+{
+    QFileInfo fileInfo(filename);
+    if (fileInfo.exists() == false) {
+        return;
+    }
+
+    // RENAME THE PREVIEWS FILED UNDER THE OLD SIZE AND TIME TO THE NEW ONES
+    QList<int> sizes = standardSizes();
+    for (int n = 0; n < sizes.count(); n++) {
+        QString fromString = cacheFilename(fileInfo.absoluteFilePath(), oldBytes, oldTime, sizes.at(n));
+        QString toString = cacheFilename(fileInfo.absoluteFilePath(), fileInfo.size(), fileInfo.lastModified(), sizes.at(n));
+        if (QFile::exists(fromString)) {
+            QFile::remove(toString);
+            QFile::rename(fromString, toString);
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePreviewCache::setMaximumBytes(qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    maxBytes = bytes;
+    evict();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+qint64 LAUImagePreviewCache::maximumBytes()
+{
+    QMutexLocker locker(&mutex);
+    return (maxBytes);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QString LAUImagePreviewCache::directory()
+{
+    return (QString("%1/previews").arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QString LAUImagePreviewCache::cacheFilename(QString filename, qint64 bytes, QDateTime time, int size)
+{
+    // A CHANGE TO THE FILE'S SIZE OR TIME STAMP GIVES IT A NEW NAME, SO STALE PREVIEWS ARE NEVER FOUND AND JUST AGE OUT
+    QString string = QString("%1|%2|%3|%4").arg(filename).arg(bytes).arg(time.toMSecsSinceEpoch()).arg(size);
+    QByteArray hash = QCryptographicHash::hash(string.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return (QString("%1/%2.jpg").arg(directory()).arg(QString(hash)));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePreviewCache::evict()
+{
+    // OLDEST FILES FIRST, WHICH ARE THE LEAST RECENTLY USED SINCE LOOKUPS TOUCH THEM
+    QDir dir(directory());
+    QFileInfoList fileInfos = dir.entryInfoList(QStringList() << "*.jpg", QDir::Files, QDir::Time | QDir::Reversed);
+
+    numBytes = 0;
+    for (int n = 0; n < fileInfos.count(); n++) {
+        numBytes += fileInfos.at(n).size();
+    }
+
+    // TRIM TO NINETY PERCENT OF THE LIMIT SO WE AREN'T BACK HERE ON THE VERY NEXT INSERT
+    if (numBytes > maxBytes) {
+        for (int n = 0; n < fileInfos.count() && numBytes > maxBytes * 9 / 10; n++) {
+            if (QFile::remove(fileInfos.at(n).absoluteFilePath())) {
+                numBytes -= fileInfos.at(n).size();
+            }
+        }
+    }
+}
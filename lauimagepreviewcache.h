@@ -0,0 +1,51 @@
+#ifndef LAUIMAGEPREVIEWCACHE_H
+#define LAUIMAGEPREVIEWCACHE_H
+
+#include <QList>
+#include <QMutex>
+#include <QImage>
+#include <QString>
+#include <QDateTime>
+
+#include "lauimage.h"
+
+#define LAUIMAGEPREVIEWCACHESMALL       256
+#define LAUIMAGEPREVIEWCACHELARGE       1920
+#define LAUIMAGEPREVIEWCACHEMEGABYTES   1024
+#define LAUIMAGEPREVIEWCACHEQUALITY     90
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUImagePreviewCache
+{
+public:
+    // RETURNS THE PREVIEW FROM DISK IF WE HAVE ONE FOR THE IMAGE'S FILE AS IT IS NOW, OTHERWISE MAKES AND STORES IT
+    static QImage preview(LAUImage image, int size);
+
+    // THESE METHODS ARE SAFE TO CALL FROM ANY THREAD
+    static QImage lookup(QString filename, int size);
+    static void insert(QString filename, int size, QImage image);
+
+    // CALL AFTER CHANGING A FILE'S METADATA BUT NOT ITS PIXELS SO ITS PREVIEWS STAY VALID
+    static void carryForward(QString filename, qint64 oldBytes, QDateTime oldTime);
+
+    static void setMaximumBytes(qint64 bytes);
+    static qint64 maximumBytes();
+    static QString directory();
+
+    static QList<int> standardSizes()
+    {
+        return (QList<int>() << LAUIMAGEPREVIEWCACHESMALL << LAUIMAGEPREVIEWCACHELARGE);
+    }
+
+private:
+    static QMutex mutex;
+    static qint64 maxBytes;
+    static qint64 numBytes;
+
+    static QString cacheFilename(QString filename, qint64 bytes, QDateTime time, int size);
+    static void evict();
+};
+
+#endif // LAUIMAGEPREVIEWCACHE_H
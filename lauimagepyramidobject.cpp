@@ -0,0 +1,232 @@
+#include "lauimagepyramidobject.h"
+
+#include <QMutexLocker>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePyramidTask::run()
+{
+    // RENDER RETURNS A NULL IMAGE IF THE TILE SCROLLED OUT OF VIEW WHILE WE WERE QUEUED
+    QImage image = object->render(key, ticket);
+
+    // HAND THE RESULTS BACK TO THE GUI THREAD
+    QMetaObject::invokeMethod(object, "onTaskComplete", Qt::QueuedConnection, Q_ARG(quint64, key), Q_ARG(unsigned int, ticket), Q_ARG(QImage, image));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImagePyramidObject::LAUImagePyramidObject(QObject *parent) : QObject(parent), numLevels(0), ticketCounter(0)
+{
+    // TILE COSTS ARE IN KILOBYTES
+    tiles.setMaxCost(LAUIMAGEPYRAMIDMEGABYTES * 1024);
+
+    // LEAVE HALF THE CORES FOR THE GUI AND WHATEVER ELSE IS RUNNING
+    threadPool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImagePyramidObject::~LAUImagePyramidObject()
+{
+    // CANCEL EVERYTHING AND WAIT FOR THE RUNNING TASKS SINCE THEY HOLD A POINTER TO US
+    mutex.lock();
+    tickets.clear();
+    mutex.unlock();
+
+    threadPool.clear();
+    threadPool.waitForDone();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePyramidObject::setImage(LAUImage image)
+{
+    // DROPPING THE TICKETS TELLS ANY TASK STILL WORKING ON THE OLD IMAGE TO THROW ITS RESULTS AWAY
+    mutex.lock();
+    sourceImage = image;
+    levelImages.clear();
+    tickets.clear();
+    mutex.unlock();
+
+    tiles.clear();
+
+    // KEEP ADDING LEVELS UNTIL THE WHOLE IMAGE FITS INSIDE A SINGLE TILE
+    imageSize = QSize(image.width(), image.height());
+    numLevels = 0;
+    if (image.isValid()) {
+        numLevels = 1;
+        while (levelSize(numLevels - 1).width() > LAUIMAGEPYRAMIDTILESIZE || levelSize(numLevels - 1).height() > LAUIMAGEPYRAMIDTILESIZE) {
+            numLevels++;
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QSize LAUImagePyramidObject::levelSize(int level) const
+{
+    // THIS HAS TO MATCH THE ROUNDING USED WHEN HALVING THE LEVELS IN level()
+    QSize size = imageSize;
+    for (int n = 0; n < level; n++) {
+        size = QSize(qMax(1, size.width() / 2), qMax(1, size.height() / 2));
+    }
+    return (size);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QPixmap LAUImagePyramidObject::tile(int level, int col, int row) const
+{
+    QPixmap *pixmap = tiles.object(key(level, col, row));
+    if (pixmap) {
+        return (*pixmap);
+    }
+    return (QPixmap());
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePyramidObject::request(QList<quint64> keys)
+{
+    QList<quint64> newKeys;
+    QList<unsigned int> newTickets;
+    mutex.lock();
+
+    // DROP ANY PENDING TILES THAT SCROLLED OUT OF VIEW SO THE WORKERS SKIP THEM
+    QList<quint64> pendingKeys = tickets.keys();
+    for (int n = 0; n < pendingKeys.count(); n++) {
+        if (keys.contains(pendingKeys.at(n)) == false) {
+            tickets.remove(pendingKeys.at(n));
+        }
+    }
+
+    // ISSUE TASKS FOR THE VISIBLE TILES THAT AREN'T ALREADY ON THEIR WAY
+    for (int n = 0; n < keys.count(); n++) {
+        if (tickets.contains(keys.at(n)) == false) {
+            tickets[keys.at(n)] = ++ticketCounter;
+            newKeys << keys.at(n);
+            newTickets << ticketCounter;
+        }
+    }
+    mutex.unlock();
+
+    // HIGHER PRIORITY FOR TILES CLOSER TO THE FRONT OF THE LIST
+    for (int n = 0; n < newKeys.count(); n++) {
+        threadPool.start(new LAUImagePyramidTask(newKeys.at(n), newTickets.at(n), this), keys.count() - keys.indexOf(newKeys.at(n)));
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImagePyramidObject::isWanted(quint64 key, unsigned int ticket) const
+{
+    QMutexLocker locker(&mutex);
+    return (tickets.value(key, 0) == ticket);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QImage LAUImagePyramidObject::render(quint64 key, unsigned int ticket)
+{
+    int lvl = (int)(key >> 48);
+    int row = (int)((key >> 24) & 0xFFFFFF);
+    int col = (int)(key & 0xFFFFFF);
+
+    LAUImage image = level(lvl, key, ticket);
+    if (image.isNull()) {
+        return (QImage());
+    }
+
+    QRect rect = QRect(col * LAUIMAGEPYRAMIDTILESIZE, row * LAUIMAGEPYRAMIDTILESIZE, LAUIMAGEPYRAMIDTILESIZE, LAUIMAGEPYRAMIDTILESIZE).intersected(QRect(0, 0, image.width(), image.height()));
+    if (rect.isEmpty()) {
+        return (QImage());
+    }
+
+    // CHECK AGAIN BEFORE SPENDING TIME ON THE COLOR MANAGED PREVIEW
+    if (isWanted(key, ticket) == false) {
+        return (QImage());
+    }
+
+    LAUImage tileImage = image.crop(rect.x(), rect.y(), rect.width(), rect.height());
+    return (tileImage.preview(QSize(tileImage.width(), tileImage.height())));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImage LAUImagePyramidObject::level(int lvl, quint64 key, unsigned int ticket)
+{
+    mutex.lock();
+    if (tickets.value(key, 0) != ticket) {
+        mutex.unlock();
+        return (LAUImage());
+    }
+    LAUImage image = (lvl == 0) ? sourceImage : levelImages.value(lvl);
+    mutex.unlock();
+
+    if (image.isValid()) {
+        return (image);
+    }
+
+    // ONLY ONE THREAD HALVES IMAGES AT A TIME SO NO LEVEL EVER GETS BUILT TWICE
+    QMutexLocker builder(&buildMutex);
+
+    // START FROM THE CLOSEST FINER LEVEL WE HAVE, WHICH ANOTHER THREAD MAY HAVE JUST BUILT
+    mutex.lock();
+    if (tickets.value(key, 0) != ticket) {
+        mutex.unlock();
+        return (LAUImage());
+    }
+    int n = lvl;
+    while (n > 0 && levelImages.contains(n) == false) {
+        n--;
+    }
+    image = (n == 0) ? sourceImage : levelImages.value(n);
+    mutex.unlock();
+
+    while (n < lvl) {
+        image = image.rescale(qMax(1u, image.height() / 2), qMax(1u, image.width() / 2), Qt::IgnoreAspectRatio, ippSuper);
+        n++;
+
+        // DON'T STORE LEVELS OF AN IMAGE THAT WAS REPLACED WHILE WE WERE HALVING IT
+        QMutexLocker locker(&mutex);
+        if (tickets.value(key, 0) != ticket) {
+            return (LAUImage());
+        }
+        levelImages[n] = image;
+    }
+    return (image);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImagePyramidObject::onTaskComplete(quint64 key, unsigned int ticket, QImage image)
+{
+    // THROW AWAY RESULTS FOR TILES THAT WERE CANCELLED WHILE THEY RENDERED
+    mutex.lock();
+    bool flag = (tickets.value(key, 0) == ticket);
+    if (flag) {
+        tickets.remove(key);
+    }
+    mutex.unlock();
+
+    if (flag == false || image.isNull()) {
+        return;
+    }
+
+    // PIXMAPS CAN ONLY BE CREATED ON THE GUI THREAD
+    QPixmap *pixmap = new QPixmap(QPixmap::fromImage(image));
+    tiles.insert(key, pixmap, qMax(1, pixmap->width() * pixmap->height() * pixmap->depth() / 8 / 1024));
+
+    emit emitTileReady();
+}
@@ -0,0 +1,93 @@
+#ifndef LAUIMAGEPYRAMIDOBJECT_H
+#define LAUIMAGEPYRAMIDOBJECT_H
+
+#include <QHash>
+#include <QMutex>
+#include <QImage>
+#include <QCache>
+#include <QPixmap>
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include "lauimage.h"
+
+#define LAUIMAGEPYRAMIDTILESIZE         256
+#define LAUIMAGEPYRAMIDMEGABYTES        256
+
+class LAUImagePyramidObject;
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUImagePyramidTask : public QRunnable
+{
+public:
+    LAUImagePyramidTask(quint64 ky, unsigned int tckt, LAUImagePyramidObject *obj) : key(ky), ticket(tckt), object(obj) { ; }
+
+protected:
+    void run();
+
+private:
+    quint64 key;
+    unsigned int ticket;
+    LAUImagePyramidObject *object;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUImagePyramidObject : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LAUImagePyramidObject(QObject *parent = nullptr);
+    ~LAUImagePyramidObject();
+
+    // LEVEL ZERO IS THE SOURCE IMAGE AND EACH LEVEL AFTER THAT IS HALF THE SIZE OF THE ONE BEFORE IT
+    void setImage(LAUImage image);
+    int levels() const
+    {
+        return (numLevels);
+    }
+    QSize levelSize(int level) const;
+
+    // THESE METHODS ARE CALLED FROM THE GUI THREAD ONLY
+    QPixmap tile(int level, int col, int row) const;
+    void request(QList<quint64> keys);
+
+    // THESE METHODS ARE CALLED FROM THE WORKER THREADS
+    bool isWanted(quint64 key, unsigned int ticket) const;
+    QImage render(quint64 key, unsigned int ticket);
+
+    static quint64 key(int level, int col, int row)
+    {
+        return (((quint64)level << 48) | ((quint64)row << 24) | (quint64)col);
+    }
+
+public slots:
+    void onTaskComplete(quint64 key, unsigned int ticket, QImage image);
+
+private:
+    QSize imageSize;
+    int numLevels;
+    unsigned int ticketCounter;
+
+    QThreadPool threadPool;
+    QCache<quint64, QPixmap> tiles;
+
+    // THE SOURCE, THE LEVELS BUILT SO FAR, AND THE TICKETS OF PENDING TILES ARE SHARED WITH THE WORKER THREADS
+    mutable QMutex mutex;
+    QMutex buildMutex;
+    LAUImage sourceImage;
+    QHash<int, LAUImage> levelImages;
+    QHash<quint64, unsigned int> tickets;
+
+    LAUImage level(int level, quint64 key, unsigned int ticket);
+
+signals:
+    void emitTileReady();
+};
+
+#endif // LAUIMAGEPYRAMIDOBJECT_H
@@ -0,0 +1,186 @@
+#include "lauimagewriterobject.h"
+#include "lauimagepreviewcache.h"
+
+#include <QMutexLocker>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImageWriterObject::LAUImageWriterObject(QObject *parent) : QThread(parent), quitFlag(false), busyFlag(false), ticketCounter(0)
+{
+    start(QThread::LowPriority);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImageWriterObject::~LAUImageWriterObject()
+{
+    // NEVER LOSE A SAVE, SO DRAIN THE QUEUE BEFORE TELLING THE THREAD TO QUIT
+    flush();
+
+    mutex.lock();
+    quitFlag = true;
+    queueCondition.wakeAll();
+    mutex.unlock();
+
+    wait();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImageWriterObject::enqueue(QString filename, LAUImage image, QByteArray xml)
+{
+    QMutexLocker locker(&mutex);
+
+    Packet packet;
+    packet.image = image;
+    packet.xml = xml;
+    packet.ticket = ++ticketCounter;
+
+    // COALESCE WITH A SAVE OF THE SAME FILE THAT HASN'T STARTED YET
+    if (packets.contains(filename) == false) {
+        queue.append(filename);
+    }
+    packets[filename] = packet;
+
+    xmlHash[filename] = xml;
+    ticketHash[filename] = packet.ticket;
+
+    queueCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImageWriterObject::pendingXmlData(QString filename, QByteArray *xml) const
+{
+    if (xmlHash.contains(filename)) {
+        *xml = xmlHash.value(filename);
+        return (true);
+    }
+    return (false);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImageWriterObject::flush()
+{
+    QMutexLocker locker(&mutex);
+    while (queue.isEmpty() == false || busyFlag) {
+        drainCondition.wait(&mutex);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImageWriterObject::onWriteComplete(QString filename, unsigned int ticket, bool flag)
+{
+    // ONLY FORGET THE XML IF NO NEWER SAVE OF THE SAME FILE CAME IN AFTER THIS ONE
+    if (ticketHash.value(filename, 0) == ticket) {
+        xmlHash.remove(filename);
+        ticketHash.remove(filename);
+    }
+    emit emitSaveComplete(filename, flag);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUImageWriterObject::run()
+{
+    forever {
+        // WAIT FOR THE NEXT FILE IN THE QUEUE
+        mutex.lock();
+        busyFlag = false;
+        drainCondition.wakeAll();
+        while (queue.isEmpty() && quitFlag == false) {
+            queueCondition.wait(&mutex);
+        }
+        if (queue.isEmpty()) {
+            mutex.unlock();
+            return;
+        }
+        QString filename = queue.takeFirst();
+        Packet packet = packets.take(filename);
+        busyFlag = true;
+        mutex.unlock();
+
+        // ONLY THE LABELS CHANGED, SO COPY THE COMPRESSED STRIPS TO A TEMPORARY FILE WITH THE NEW XML PACKET
+        // AND SWAP IT IN, A CRASH PART WAY THROUGH A DIRECTORY REWRITE THEN NEVER TOUCHES THE ORIGINAL
+        // THE PREVIEW CACHE KNOWS THE FILE BY ITS SIZE AND TIME STAMP BEFORE THIS SAVE, SO READ THEM NOW
+        QFileInfo fileInfo(filename);
+        qint64 bytes = fileInfo.size();
+        QDateTime time = fileInfo.lastModified();
+        QString tempString = temporaryFilename(filename);
+        bool flag = LAUImage::copyWithXmlPacket(filename, tempString, packet.xml);
+        if (flag) {
+            flag = replaceFile(tempString, filename);
+            if (flag == false) {
+                QFile::remove(tempString);
+            }
+        }
+        if (flag) {
+            // THE PIXELS DIDN'T CHANGE SO NEITHER DID THE PREVIEWS
+            LAUImagePreviewCache::carryForward(filename, bytes, time);
+        } else {
+            // OTHERWISE WRITE THE WHOLE IMAGE TO A TEMPORARY FILE NEXT TO THE ORIGINAL AND
+            // THEN SWAP IT IN SO A CRASH HALFWAY THROUGH NEVER LEAVES A TRUNCATED IMAGE BEHIND
+            if (packet.image.isNull()) {
+                // LABELS REPLAYED FROM THE JOURNAL COME WITHOUT PIXELS, SO READ THEM FROM THE FILE
+                packet.image = LAUImage(filename);
+            }
+            // THE PIXELS ARE STILL SHARED WITH THE GUI'S COPY, SO HAND THE XML TO THE ENCODER INSTEAD OF SETTING IT
+            flag = packet.image.save(tempString, packet.xml);
+            if (flag) {
+                flag = replaceFile(tempString, filename);
+            }
+            if (flag == false) {
+                QFile::remove(tempString);
+            }
+        }
+
+        // RELEASE OUR REFERENCE TO THE PIXELS BEFORE WAITING FOR THE NEXT FILE
+        packet.image = LAUImage();
+
+        QMetaObject::invokeMethod(this, "onWriteComplete", Qt::QueuedConnection, Q_ARG(QString, filename), Q_ARG(unsigned int, packet.ticket), Q_ARG(bool, flag));
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QString LAUImageWriterObject::temporaryFilename(QString filename)
+{
+    // LEADING PERIOD HIDES THE FILE FROM OUR DIRECTORY SCANS
+    QFileInfo fileInfo(filename);
+    return (QString("%1/.%2.tmp").arg(fileInfo.absolutePath()).arg(fileInfo.fileName()));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUImageWriterObject::replaceFile(QString fromString, QString toString)
+{
+#if defined(Q_OS_WIN)
+    // WINDOWS REFUSES TO REPLACE A FILE THAT SOMEONE ELSE HAS OPEN, SO GIVE READERS A MOMENT TO LET GO
+    for (int n = 0; n < 20; n++) {
+        if (MoveFileExW((LPCWSTR)fromString.utf16(), (LPCWSTR)toString.utf16(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            return (true);
+        }
+        QThread::msleep(50);
+    }
+    return (false);
+#else
+    return (::rename(QFile::encodeName(fromString).constData(), QFile::encodeName(toString).constData()) == 0);
+#endif
+}
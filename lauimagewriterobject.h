@@ -0,0 +1,73 @@
+#ifndef LAUIMAGEWRITEROBJECT_H
+#define LAUIMAGEWRITEROBJECT_H
+
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QObject>
+#include <QStringList>
+#include <QWaitCondition>
+
+#include "lauimage.h"
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUImageWriterObject : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit LAUImageWriterObject(QObject *parent = nullptr);
+    ~LAUImageWriterObject();
+
+    // QUEUE AN IMAGE FOR SAVING WITH NEW XML DATA, REPLACING ANY SAVE STILL WAITING FOR THE SAME FILE
+    void enqueue(QString filename, LAUImage image, QByteArray xml);
+
+    // RETURNS THE XML OF A SAVE THAT HASN'T BEEN ACKNOWLEDGED ON THE GUI THREAD YET
+    bool pendingXmlData(QString filename, QByteArray *xml) const;
+
+    // BLOCK UNTIL EVERY QUEUED SAVE HAS BEEN WRITTEN TO DISK
+    void flush();
+
+    int pending() const
+    {
+        QMutexLocker locker(&mutex);
+        return (queue.count() + (busyFlag ? 1 : 0));
+    }
+
+    static bool replaceFile(QString fromString, QString toString);
+    static QString temporaryFilename(QString filename);
+
+public slots:
+    void onWriteComplete(QString filename, unsigned int ticket, bool flag);
+
+protected:
+    void run();
+
+private:
+    typedef struct {
+        LAUImage image;
+        QByteArray xml;
+        unsigned int ticket;
+    } Packet;
+
+    bool quitFlag;
+    bool busyFlag;
+    unsigned int ticketCounter;
+
+    mutable QMutex mutex;
+    QWaitCondition queueCondition;
+    QWaitCondition drainCondition;
+    QStringList queue;
+    QHash<QString, Packet> packets;
+
+    // XML OF SAVES THAT ARE QUEUED OR WRITTEN BUT NOT YET ACKNOWLEDGED, GUI THREAD ONLY
+    QHash<QString, QByteArray> xmlHash;
+    QHash<QString, unsigned int> ticketHash;
+
+signals:
+    void emitSaveComplete(QString filename, bool flag);
+};
+
+#endif // LAUIMAGEWRITEROBJECT_H
@@ -0,0 +1,113 @@
+#include "lauperceptualhash.h"
+#include "lauthumbnailbrowser.h"
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+quint64 LAUPerceptualHash::hash(QImage image)
+{
+    if (image.isNull()) {
+        return (0);
+    }
+
+    // THE SMOOTH SCALER AVERAGES OVER EACH CELL, WHICH IS WHAT KEEPS SENSOR NOISE OUT OF THE HASH
+    QImage grayImage = image.scaled(9, 8, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(QImage::Format_Grayscale8);
+
+    quint64 hash = 0;
+    for (int row = 0; row < 8; row++) {
+        const unsigned char *buffer = grayImage.constScanLine(row);
+        for (int col = 0; col < 8; col++) {
+            hash = (hash << 1) | (quint64)(buffer[col] < buffer[col + 1]);
+        }
+    }
+    return (hash);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUPerceptualHash::hash(QString filename, quint64 *hash)
+{
+    QImage image = LAUThumbnailTask::thumbnail(filename);
+    if (image.isNull()) {
+        return (false);
+    }
+    *hash = LAUPerceptualHash::hash(image);
+    return (true);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPerceptualHashTask::run()
+{
+    for (int n = first; n < last; n++) {
+        if (cancelFlag->loadAcquire()) {
+            return;
+        }
+
+        // THE HEADER HAS TO BE IN THE TABLE FIRST OR THE SCAN WOULD OVERWRITE THE HASH WHEN IT GOT THERE
+        LAUDatasetIndex::Entry entry = datasetIndex->entry(n);
+        if (entry.missing == false && entry.hashed == false) {
+            quint64 hash = 0;
+            if (LAUPerceptualHash::hash(datasetIndex->filename(n), &hash)) {
+                datasetIndex->setHash(n, hash);
+            }
+        }
+        doneCount->fetchAndAddRelaxed(1);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUDuplicateIndex::LAUDuplicateIndex(int distance)
+{
+    // PROBING ONE BIT AROUND EACH BAND IS ONLY EXHAUSTIVE UP TO THIS MANY BITS
+    threshold = qBound(0, distance, 2 * LAUPERCEPTUALHASHBANDS - 1);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUDuplicateIndex::insert(int index, quint64 hash)
+{
+    // TWO HASHES WITHIN THE THRESHOLD CAN'T DIFFER BY TWO OR MORE BITS IN EVERY BAND, SO LOOKING UP EACH
+    // BAND AND ITS SIXTEEN ONE BIT NEIGHBORS FINDS EVERY MATCH WITHOUT COMPARING AGAINST EVERY CLUSTER
+    int best = -1;
+    int bestDistance = threshold + 1;
+    for (int band = 0; band < LAUPERCEPTUALHASHBANDS; band++) {
+        quint16 key = (quint16)(hash >> (16 * band));
+        for (int bit = -1; bit < 16; bit++) {
+            quint16 probe = (bit < 0) ? key : (quint16)(key ^ (1 << bit));
+            QHash<quint16, QVector<int> >::const_iterator iterator = buckets[band].constFind(probe);
+            if (iterator == buckets[band].constEnd()) {
+                continue;
+            }
+
+            const QVector<int> &candidates = iterator.value();
+            for (int n = 0; n < candidates.count(); n++) {
+                int cluster = candidates.at(n);
+                int distance = LAUPerceptualHash::distance(hashVector.at(cluster), hash);
+                if (distance < bestDistance || (distance == bestDistance && cluster < best)) {
+                    best = cluster;
+                    bestDistance = distance;
+                }
+            }
+        }
+    }
+
+    if (best >= 0) {
+        return (indexVector.at(best));
+    }
+
+    // ONLY THE FIRST IMAGE OF A CLUSTER IS EVER COMPARED AGAINST, SO A SLOW DRIFT DOWN A LONG RUN OF FRAMES
+    // STARTS NEW CLUSTERS INSTEAD OF CHAINING THE WHOLE RUN INTO ONE
+    int cluster = indexVector.count();
+    indexVector << index;
+    hashVector << hash;
+    for (int band = 0; band < LAUPERCEPTUALHASHBANDS; band++) {
+        buckets[band][(quint16)(hash >> (16 * band))] << cluster;
+    }
+    return (index);
+}
@@ -0,0 +1,79 @@
+#ifndef LAUPERCEPTUALHASH_H
+#define LAUPERCEPTUALHASH_H
+
+#include <QHash>
+#include <QImage>
+#include <QVector>
+#include <QString>
+#include <QtAlgorithms>
+#include <QRunnable>
+#include <QAtomicInt>
+
+#include "laudatasetindex.h"
+
+#define LAUPERCEPTUALHASHDISTANCE       6
+#define LAUPERCEPTUALHASHBANDS          4
+#define LAUPERCEPTUALHASHBLOCKSIZE      16
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUPerceptualHash
+{
+public:
+    // 64 BIT DIFFERENCE HASH, ONE BIT PER NEIGHBORING PAIR OF PIXELS IN A 9 BY 8 GRAYSCALE COPY OF THE IMAGE
+    static quint64 hash(QImage image);
+
+    // HASHES THE SAME SMALL PREVIEW THE THUMBNAIL GRID USES, SO MOST OF THE TIME NOTHING IS DECODED
+    static bool hash(QString filename, quint64 *hash);
+
+    static int distance(quint64 hashA, quint64 hashB)
+    {
+        return ((int)qPopulationCount(hashA ^ hashB));
+    }
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUPerceptualHashTask : public QRunnable
+{
+public:
+    LAUPerceptualHashTask(LAUDatasetIndex *index, int frst, int lst, QAtomicInt *cancel, QAtomicInt *done) : datasetIndex(index), first(frst), last(lst), cancelFlag(cancel), doneCount(done) { ; }
+
+protected:
+    void run();
+
+private:
+    LAUDatasetIndex *datasetIndex;
+    int first, last;
+    QAtomicInt *cancelFlag;
+    QAtomicInt *doneCount;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUDuplicateIndex
+{
+public:
+    explicit LAUDuplicateIndex(int distance = LAUPERCEPTUALHASHDISTANCE);
+
+    // IMAGES GO IN IN FILE ORDER, RETURNS THE EARLIER IMAGE THIS ONE DUPLICATES OR INDEX ITSELF IF IT STARTS A NEW CLUSTER
+    int insert(int index, quint64 hash);
+
+    int clusters() const
+    {
+        return (indexVector.count());
+    }
+
+private:
+    int threshold;
+
+    // ONLY THE FIRST IMAGE OF EACH CLUSTER IS KEPT, FILED UNDER EACH 16 BIT BAND OF ITS HASH
+    QVector<int> indexVector;
+    QVector<quint64> hashVector;
+    QHash<quint16, QVector<int> > buckets[LAUPERCEPTUALHASHBANDS];
+};
+
+#endif // LAUPERCEPTUALHASH_H
@@ -0,0 +1,246 @@
+#include "lauposeannotation.h"
+
+#include <QList>
+#include <QBuffer>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseAnnotation::LAUPoseAnnotation(QStringList labels, QStringList fiducials) : labelStrings(labels), fiducialStrings(fiducials), imageWidth(0), imageHeight(0)
+{
+    clear();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseAnnotation LAUPoseAnnotation::fromXml(QByteArray xml)
+{
+    QStringList labels;
+    QStringList fiducials;
+
+    QXmlStreamReader reader(xml);
+    while (!reader.atEnd()) {
+        if (reader.readNext()) {
+            QString name = reader.name().toString();
+            if (name == "label") {
+                // THE LIST OF CLASSES IS FOLLOWED BY THE ONE THIS IMAGE BELONGS TO
+                labels = reader.readElementText().split(",");
+                if (labels.count() > 0) {
+                    labels.removeLast();
+                }
+            } else if (name == "fiducial") {
+                QString string = reader.readElementText();
+                int indexA = string.indexOf("\"") + 1;
+                int indexB = string.lastIndexOf("\"");
+                if (indexA > 0 && indexB >= indexA) {
+                    fiducials << string.mid(indexA, indexB - indexA);
+                }
+            }
+        }
+    }
+    reader.clear();
+
+    return (LAUPoseAnnotation(labels, fiducials));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseAnnotation::clear()
+{
+    classNumber = 0;
+    confidenceLevel = -1.0f;
+    originString.clear();
+
+    xVector.fill(0, fiducialStrings.count());
+    yVector.fill(0, fiducialStrings.count());
+    zVector.fill(1, fiducialStrings.count());
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseAnnotation::setXml(QByteArray xml)
+{
+    // NOTHING CARRIES OVER FROM WHATEVER IMAGE WE HELD BEFORE
+    clear();
+    if (xml.isEmpty()) {
+        return;
+    }
+
+    QXmlStreamReader reader(xml);
+    while (!reader.atEnd()) {
+        if (reader.readNext()) {
+            QString name = reader.name().toString();
+            if (name == "label") {
+                QStringList strings = reader.readElementText().split(",");
+                if (strings.count() > 0) {
+                    int index = labelStrings.indexOf(strings.last().simplified());
+                    if (index >= 0) {
+                        classNumber = index;
+                    }
+                }
+            } else if (name == "fiducial") {
+                // EACH FIDUCIAL IS STORED AS "NAME",VISIBLE,X,Y
+                QString string = reader.readElementText();
+                int indexA = string.indexOf("\"") + 1;
+                int indexB = string.lastIndexOf("\"");
+                if (indexA > 0 && indexB >= indexA) {
+                    int index = fiducialStrings.indexOf(string.mid(indexA, indexB - indexA));
+                    QStringList strings = string.mid(indexB + 2).split(",");
+                    if (index >= 0 && strings.count() == 3) {
+                        zVector[index] = (strings.at(0).toInt() != 0);
+                        xVector[index] = strings.at(1).toInt();
+                        yVector[index] = strings.at(2).toInt();
+                    }
+                }
+            } else if (name == "origin") {
+                originString = reader.readElementText();
+            } else if (name == "confidence") {
+                confidenceLevel = reader.readElementText().toFloat();
+            }
+        }
+    }
+    reader.clear();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QByteArray LAUPoseAnnotation::xml(QRect roi, double scale, bool flag) const
+{
+    // CREATE THE XML DATA PACKET USING QT'S XML STREAM OBJECTS
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    QXmlStreamWriter writer(&buffer);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeStartElement("LAUYoloPoseFiducials");
+
+    // WRITE THE LIST OF CLASSES FOLLOWED BY THE ONE THIS IMAGE BELONGS TO
+    QString labelString;
+    for (int n = 0; n < labelStrings.count(); n++) {
+        labelString.append(QString("%1,").arg(labelStrings.at(n)));
+    }
+    labelString.append(labelStrings.value(classNumber));
+    writer.writeTextElement("label", labelString);
+
+    // SAVE THE FILENAME STRING IF AVAILABLE
+    if (originString.isEmpty() == false) {
+        writer.writeTextElement("origin", originString);
+    }
+
+    // SAVE THE CONFIDENCE IF THE FIDUCIALS CAME FROM A MODEL
+    if (confidenceLevel >= 0.0f) {
+        writer.writeTextElement("confidence", QString::number(confidenceLevel, 'f', 4));
+    }
+
+    // WRITE THE FIDUCIALS TO XML
+    for (int n = 0; n < fiducialStrings.count(); n++) {
+        if (flag && (n < 6 || n > 11)) {
+            continue;
+        }
+        int x = qRound((xVector.at(n) - roi.left()) * scale);
+        int y = qRound((yVector.at(n) - roi.top()) * scale);
+        int z = (zVector.at(n) != 0);
+        writer.writeTextElement(QString("fiducial"), QString("\"%1\",%2,%3,%4").arg(fiducialStrings.at(n)).arg(z).arg(x).arg(y));
+    }
+
+    // CLOSE OUT THE XML BUFFER
+    writer.writeEndElement();
+    writer.writeEndDocument();
+    buffer.close();
+
+    // EXPORT THE XML BUFFER TO THE XMLPACKET FIELD OF THE TIFF IMAGE
+    return (buffer.buffer());
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QString LAUPoseAnnotation::labelString(QRect *rect, bool flag) const
+{
+    // FLAG LIMITS US TO THE HEAD, FIDUCIALS 6 THROUGH 11
+    int first = (flag) ? 6 : 0;
+    int last = (flag) ? qMin(12, fiducials()) : fiducials();
+
+    if (flag && fiducials() > 6) {
+        // CENTER THE 7TH FIDUCIAL IN THE REGION OF INTEREST
+        rect->moveCenter(QPoint(xVector.at(6), yVector.at(6)));
+    }
+
+    // EXTRACT THE BOUNDING BOX
+    int xMin = 10000;
+    int xMax = -1000;
+    int yMin = 10000;
+    int yMax = -1000;
+
+    for (int n = first; n < last; n++) {
+        xMin = qMin(xMin, xVector.at(n) - 40);
+        xMax = qMax(xMax, xVector.at(n) + 40);
+        yMin = qMin(yMin, yVector.at(n) - 40);
+        yMax = qMax(yMax, yVector.at(n) + 40);
+    }
+
+    // MOVE REGION OF INTEREST TO KEEP ALL FIDUCIALS INSIDE BOX
+    if (xMin < rect->left() || rect->left() < 0) {
+        rect->moveLeft(qMax(0, xMin));
+    } else if (xMax > rect->right() || rect->right() >= imageWidth) {
+        rect->moveRight(qMin(xMax, imageWidth - 1));
+    }
+
+    if (yMin < rect->top() || rect->top() < 0) {
+        rect->moveTop(qMax(0, yMin));
+    } else if (yMax > rect->bottom() || rect->bottom() >= imageHeight) {
+        rect->moveBottom(qMin(yMax, imageHeight - 1));
+    }
+
+    // RECALCULATE LIMITS NOW THAT WE'VE CENTERED THE ROI
+    xMin = 10000;
+    xMax = -1000;
+    yMin = 10000;
+    yMax = -1000;
+
+    for (int n = first; n < last; n++) {
+        xMin = qMin(xMin, xVector.at(n) - rect->left());
+        xMax = qMax(xMax, xVector.at(n) - rect->left());
+        yMin = qMin(yMin, yVector.at(n) - rect->top());
+        yMax = qMax(yMax, yVector.at(n) - rect->top());
+    }
+
+    double xLeft = (double)(xMin - 20) / (double)rect->width();
+    double xWide = (double)(xMax - xMin + 40) / (double)rect->width();
+    double yTop = (double)(yMin - 20) / (double)rect->height();
+    double yTall = (double)(yMax - yMin + 40) / (double)rect->height();
+
+    QList<double> values;
+    values << (xLeft + xWide / 2.0);
+    values << (yTop + yTall / 2.0);
+    values << xWide;
+    values << yTall;
+
+    // EXTRACT THE FIDUCIAL COORDINATES
+    for (int n = first; n < last; n++) {
+        values << (double)(xVector.at(n) - rect->left()) / (double)rect->width();
+        values << (double)(yVector.at(n) - rect->top()) / (double)rect->height();
+        values << ((zVector.at(n) != 0) ? 1.0 : 0.0);
+    }
+
+    // CLAMP ALL COORDINATES TO NOMALIZED IMAGE BOUNDS AND PRINT THEM AFTER THE CLASS INDEX
+    QString string = QString("%1").arg(classNumber);
+    for (int n = 0; n < values.count(); n++) {
+        double value = values.at(n);
+        if (value > 1.0) {
+            value = 0.9999;
+        } else if (value < 0.0) {
+            value = 0.0001;
+        }
+        string.append(QString(" %1").arg(value, 0, 'f', 6));
+    }
+
+    return (string);
+}
@@ -0,0 +1,135 @@
+#ifndef LAUPOSEANNOTATION_H
+#define LAUPOSEANNOTATION_H
+
+#include <QRect>
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUPoseAnnotation
+{
+public:
+    LAUPoseAnnotation(QStringList labels = QStringList(), QStringList fiducials = QStringList());
+
+    // BUILD AN EMPTY ANNOTATION WITH THE CLASSES AND FIDUCIAL NAMES LISTED IN AN XML PACKET
+    static LAUPoseAnnotation fromXml(QByteArray xml);
+
+    // RESET EVERYTHING BUT THE CLASS AND FIDUCIAL NAMES, THEN READ THE VALUES FROM AN XML PACKET
+    void clear();
+    void setXml(QByteArray xml);
+
+    // ROI AND SCALE MAP THE FIDUCIALS INTO A CROPPED AND RESIZED COPY OF THE IMAGE, FLAG KEEPS JUST THE HEAD
+    QByteArray xml(QRect roi = QRect(0,0,0,0), double scale = 1.0, bool flag = false) const;
+
+    // ONE LINE OF A YOLO POSE LABEL FILE, MOVING RECT AS NEEDED TO KEEP ALL FIDUCIALS INSIDE IT
+    QString labelString(QRect *rect, bool flag = false) const;
+
+    QStringList labels() const
+    {
+        return (labelStrings);
+    }
+
+    QStringList fiducialNames() const
+    {
+        return (fiducialStrings);
+    }
+
+    int fiducials() const
+    {
+        return (fiducialStrings.count());
+    }
+
+    int classIndex() const
+    {
+        return (classNumber);
+    }
+
+    void setClassIndex(int index)
+    {
+        classNumber = index;
+    }
+
+    // CONFIDENCE OF THE MODEL THAT PLACED THE FIDUCIALS, NEGATIVE MEANS A PERSON PLACED OR CHECKED THEM
+    float confidence() const
+    {
+        return (confidenceLevel);
+    }
+
+    void setConfidence(float value)
+    {
+        confidenceLevel = value;
+    }
+
+    QString origin() const
+    {
+        return (originString);
+    }
+
+    void setOrigin(QString string)
+    {
+        originString = string;
+    }
+
+    int width() const
+    {
+        return (imageWidth);
+    }
+
+    int height() const
+    {
+        return (imageHeight);
+    }
+
+    void setImageSize(int x, int y)
+    {
+        imageWidth = x;
+        imageHeight = y;
+    }
+
+    int x(int index) const
+    {
+        return (xVector.at(index));
+    }
+
+    int y(int index) const
+    {
+        return (yVector.at(index));
+    }
+
+    bool isVisible(int index) const
+    {
+        return (zVector.at(index) != 0);
+    }
+
+    void setFiducial(int index, int x, int y, bool z)
+    {
+        xVector[index] = x;
+        yVector[index] = y;
+        zVector[index] = z;
+    }
+
+    void setVisible(int index, bool z)
+    {
+        zVector[index] = z;
+    }
+
+private:
+    QStringList labelStrings;
+    QStringList fiducialStrings;
+
+    int classNumber;
+    float confidenceLevel;
+    QString originString;
+    int imageWidth, imageHeight;
+
+    // ONE ENTRY PER FIDUCIAL IN THE ORDER THEY WERE NAMED
+    QVector<int> xVector;
+    QVector<int> yVector;
+    QVector<unsigned char> zVector;
+};
+
+#endif // LAUPOSEANNOTATION_H
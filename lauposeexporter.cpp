@@ -0,0 +1,523 @@
+#include "lauposeexporter.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QTextStream>
+#include <QMutexLocker>
+#include <QCryptographicHash>
+
+#include "lauimage.h"
+#include "laudirectorywalker.h"
+#include "lauperceptualhash.h"
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseExportTask::run()
+{
+    object->exportImage(fileString, number, trainFlag);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseExporter::LAUPoseExporter(QString input, QString output, LAUPoseAnnotation annotation, int images, bool skipDuplicates, ExportMode mode, QObject *parent) : QThread(parent), inputDirectoryString(input), outputDirectoryString(output), poseAnnotation(annotation), numImages(qMax(1, images)), skipDuplicatesFlag(skipDuplicates), exportMode(mode), foundCount(0), doneCount(0), exportedCount(0), failedCount(0), unchangedCount(0), removedCount(0), quitFlag(0), okayFlag(0)
+{
+    // ANYTHING THAT CHANGES WHAT AN OUTPUT LOOKS LIKE, OTHER THAN THE SOURCE ITSELF, INVALIDATES THE WHOLE MANIFEST
+#ifdef ZOOMINTOHEAD
+    QString geometryString("head 640x640");
+#else
+    QString geometryString("center 1000x1000 to 640x640, black border");
+#endif
+    parameterString = QString("%1|%2|%3|%4|%5").arg((int)exportMode).arg(numImages).arg(geometryString).arg(poseAnnotation.labels().join(",")).arg(poseAnnotation.fiducialNames().join(","));
+
+    // EACH WORKER DECODES A FULL FRAME, SO ONLY LET A FEW OF THEM PER THREAD BE WAITING AT ONCE
+    threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+    slotSemaphore.release(LAUPOSEEXPORTERWINDOW * threadPool.maxThreadCount());
+    start(QThread::LowPriority);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseExporter::~LAUPoseExporter()
+{
+    cancel();
+    wait();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUPoseExporter::makeDirectories()
+{
+    QDir imageDir(QString("%1/%2").arg(outputDirectoryString).arg("images"));
+    QDir labelDir(QString("%1/%2").arg(outputDirectoryString).arg("labels"));
+    imageTrainDir = QDir(QString("%1/%2").arg(imageDir.absolutePath()).arg("train"));
+    imageValidDir = QDir(QString("%1/%2").arg(imageDir.absolutePath()).arg("val"));
+    labelTrainDir = QDir(QString("%1/%2").arg(labelDir.absolutePath()).arg("train"));
+    labelValidDir = QDir(QString("%1/%2").arg(labelDir.absolutePath()).arg("val"));
+
+    QList<QDir> dirs = QList<QDir>() << imageTrainDir << imageValidDir;
+    if (exportMode == ExportClassify) {
+        // ONE FOLDER PER CLASS UNDER TRAIN AND VAL, THE LAYOUT THE YOLO CLASSIFIER EXPECTS
+        QStringList labels = poseAnnotation.labels();
+        for (int n = 0; n < labels.count(); n++) {
+            classTrainDirs << QDir(QString("%1/%2").arg(imageTrainDir.absolutePath()).arg(labels.at(n)));
+            classValidDirs << QDir(QString("%1/%2").arg(imageValidDir.absolutePath()).arg(labels.at(n)));
+        }
+        dirs << classTrainDirs << classValidDirs;
+    } else {
+        dirs << labelTrainDir << labelValidDir;
+    }
+    for (int n = 0; n < dirs.count(); n++) {
+        if (dirs.at(n).exists() == false && dirs.at(n).mkpath(dirs.at(n).absolutePath()) == false) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseExporter::exportImage(QString filename, int number, bool train)
+{
+    // THE SLOT IS GIVEN BACK HOWEVER WE LEAVE, SO THE DISPATCHER CAN HAND OUT THE NEXT IMAGE
+    bool tried = (quitFlag.loadAcquire() == 0);
+    bool okay = false;
+    if (tried) {
+        LAUImage image(filename, LAUImage::LoadMetadata);
+        if (image.xmlData().isEmpty() == false && image.loadPixels()) {
+            LAUPoseAnnotation annotation = poseAnnotation;
+            annotation.setXml(image.xmlData());
+            annotation.setOrigin(filename);
+            annotation.setImageSize(image.width(), image.height());
+
+            QByteArray xml;
+#ifdef ZOOMINTOHEAD
+            int left = (image.width() - 640)/2;
+            int top = (image.height() - 640)/2;
+            QRect rect(left, top, 640, 640);
+
+            // GET STRING THAT WE CAN WRITE TO LABELS FILE
+            QString labelString = annotation.labelString(&rect, true);
+
+            // CROP AND RESCALE IMAGE FOR TRAINING
+            image = image.crop(rect.left(), rect.top(), rect.width(), rect.height());
+            xml = annotation.xml(rect, 1.0, true);
+#else
+            int left = (image.width() - 1000)/2;
+            int top = (image.height() - 1000)/2;
+            QRect rect(left, top, 1000, 1000);
+
+            // GET STRING THAT WE CAN WRITE TO LABELS FILE
+            QString labelString = annotation.labelString(&rect, false);
+
+            // CROP AND RESCALE IMAGE FOR TRAINING IN ONE PASS, WITH BLACK WHERE THE BOX HANGS OFF A SMALL FRAME
+            LAUImage scaled = takeDestination(image);
+            if (image.rescaleInto(rect, &scaled)) {
+                image = scaled;
+            } else {
+                image = image.crop(rect.left(), rect.top(), rect.width(), rect.height()).rescale(640,640);
+            }
+            xml = annotation.xml(rect, 0.640);
+#endif
+            // THE LABEL FILE, IF THERE IS ONE, FOLLOWS THE IMAGE IN THE LIST, AND THE XML GOES STRAIGHT
+            // INTO THE FILE SO THE DESTINATION IS NEVER DETACHED TO HOLD IT
+            QStringList outputs = outputFiles(number, train, annotation.classIndex());
+            if (outputs.isEmpty() == false && image.save(outputs.first(), xml)) {
+                okay = true;
+                if (outputs.count() > 1) {
+                    QFile file(outputs.at(1));
+                    if (file.open(QIODevice::WriteOnly)) {
+                        file.write(labelString.toLatin1());
+                        file.close();
+                    } else {
+                        okay = false;
+                    }
+                }
+            }
+#ifndef ZOOMINTOHEAD
+            // LET GO OF OUR REFERENCE FIRST SO THE NEXT WORKER WRITES INTO THE DESTINATION WITHOUT COPYING IT
+            image = LAUImage();
+            giveDestination(scaled);
+#endif
+        }
+    }
+
+    // A SUCCESSFUL EXPORT REPLACES THE MANIFEST ENTRY, OTHERWISE A SOURCE EXPORTED BEFORE KEEPS ITS OLD ENTRY, AND SO ITS
+    // NUMBER, SO THE NEXT RUN OVERWRITES ITS OUTPUTS INSTEAD OF ADDING A SECOND COPY UNDER A NEW NUMBER
+    manifestMutex.lock();
+    ManifestEntry manifestEntry = pendingManifest.take(number);
+    bool previous = previousManifest.contains(number);
+    ManifestEntry previousEntry = previousManifest.take(number);
+    if (okay) {
+        newManifest[filename] = manifestEntry;
+    } else if (previous) {
+        newManifest[filename] = previousEntry;
+    }
+    manifestMutex.unlock();
+
+    if (okay) {
+        exportedCount.fetchAndAddRelaxed(1);
+    } else if (tried) {
+        // WHATEVER WE MANAGED TO WRITE IS INCOMPLETE, AND WITHOUT IT THE NEXT RUN SEES THE OUTPUTS AS MISSING
+        removeOutputs(manifestEntry);
+        failedCount.fetchAndAddRelaxed(1);
+    }
+    slotSemaphore.release();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUImage LAUPoseExporter::takeDestination(const LAUImage &source)
+{
+    LAUImage image;
+    destinationMutex.lock();
+    if (destinationList.isEmpty() == false) {
+        image = destinationList.takeLast();
+    }
+    destinationMutex.unlock();
+
+    // ONLY A FRAME OF ANOTHER PIXEL FORMAT NEEDS A NEW DESTINATION, OTHERWISE JUST THE PROFILE AND RESOLUTION FOLLOW THE SOURCE
+    if (image.isNull() || image.depth() != source.depth() || image.colors() != source.colors()) {
+        image = LAUImage(640, 640, source.colors(), source.depth(), source.xRes(), source.yRes());
+    }
+    image.copyProfile(source);
+    image.setResolution(source.xRes(), source.yRes());
+    return (image);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseExporter::giveDestination(const LAUImage &image)
+{
+    if (image.isNull()) {
+        return;
+    }
+
+    // THERE ARE NEVER MORE IN USE AT ONCE THAN THERE ARE WORKERS
+    QMutexLocker locker(&destinationMutex);
+    if (destinationList.count() < threadPool.maxThreadCount()) {
+        destinationList.append(image);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseExporter::run()
+{
+    if (makeDirectories() == false) {
+        return;
+    }
+
+    // SOURCES WE ALREADY EXPORTED KEEP THEIR NUMBER AND SPLIT, NEW ONES ARE NUMBERED AFTER THE LAST ONE, IN WALK ORDER
+    loadManifest();
+    int validImageCounter = 0;
+    for (QHash<QString, ManifestEntry>::const_iterator it = oldManifest.constBegin(); it != oldManifest.constEnd(); it++) {
+        validImageCounter = qMax(validImageCounter, (int)it.value().number);
+    }
+
+    // FIND IMAGES IN THE BACKGROUND AND START ON THEM AS THEY TURN UP, THE INDEX TELLS US WHICH ARE LABELED SO WE ONLY DECODE THOSE
+    LAUDatasetIndex labelIndex(QStringList(), LAUDatasetIndex::defaultFilename(QStringList() << inputDirectoryString));
+    LAUDirectoryWalker walker(QStringList() << inputDirectoryString, QStringList() << "*.tif" << "*.tiff", &labelIndex);
+
+    QDir outputDir(outputDirectoryString);
+    LAUDuplicateIndex duplicateIndex;
+    QString string;
+    for (int n = 0; walker.next(&string); n++) {
+        foundCount.storeRelease(walker.count());
+        if (quitFlag.loadAcquire()) {
+            break;
+        }
+
+        LAUDatasetIndex::Entry entry = labelIndex.entry(n);
+        if (entry.labeled) {
+            // WHEN THE USER IS SKIPPING NEAR DUPLICATES, ONLY THE FIRST LABELED FRAME OF EACH RUN GOES INTO THE EXPORT
+            bool duplicate = false;
+            if (skipDuplicatesFlag) {
+                quint64 hash = entry.hash;
+                bool hashed = entry.hashed;
+                if (hashed == false && LAUPerceptualHash::hash(string, &hash)) {
+                    labelIndex.setHash(n, hash);
+                    hashed = true;
+                }
+                duplicate = (hashed && duplicateIndex.insert(n, hash) != n);
+            }
+
+            if (duplicate == false) {
+                QString filename = QFileInfo(string).absoluteFilePath();
+                ManifestEntry manifestEntry;
+                manifestEntry.modified = entry.modified;
+                manifestEntry.labelHash = labelHash(entry);
+
+                bool current = false;
+                bool previous = oldManifest.contains(filename);
+                ManifestEntry oldEntry;
+                if (previous) {
+                    oldEntry = oldManifest.take(filename);
+                    manifestEntry.number = oldEntry.number;
+                    manifestEntry.train = oldEntry.train;
+
+                    QStringList outputs = outputFiles(manifestEntry.number, manifestEntry.train, entry.classIndex);
+                    for (int m = 0; m < outputs.count(); m++) {
+                        manifestEntry.outputs << outputDir.relativeFilePath(outputs.at(m));
+                    }
+
+                    // UNTOUCHED SOURCE, SAME LABELS, AND ITS OUTPUTS ARE STILL WHERE WE LEFT THEM
+                    current = (oldEntry.modified == manifestEntry.modified && oldEntry.labelHash == manifestEntry.labelHash && oldEntry.outputs == manifestEntry.outputs);
+                    for (int m = 0; current && m < outputs.count(); m++) {
+                        current = QFile::exists(outputs.at(m));
+                    }
+
+                    // A CLASS CHANGE MOVES A CLASSIFIER OUTPUT TO ANOTHER FOLDER, SO THE OLD COPY HAS TO GO
+                    if (oldEntry.outputs != manifestEntry.outputs) {
+                        removeOutputs(oldEntry);
+                    }
+                } else {
+                    manifestEntry.number = ++validImageCounter;
+                    manifestEntry.train = (manifestEntry.number % numImages) != 0;
+                    QStringList outputs = outputFiles(manifestEntry.number, manifestEntry.train, entry.classIndex);
+                    for (int m = 0; m < outputs.count(); m++) {
+                        manifestEntry.outputs << outputDir.relativeFilePath(outputs.at(m));
+                    }
+                }
+
+                if (current) {
+                    manifestMutex.lock();
+                    newManifest[filename] = manifestEntry;
+                    manifestMutex.unlock();
+                    unchangedCount.fetchAndAddRelaxed(1);
+                } else {
+                    // WAIT FOR A FREE SLOT, BUT DON'T MISS A CANCEL WHILE WE DO
+                    while (slotSemaphore.tryAcquire(1, 100) == false) {
+                        if (quitFlag.loadAcquire()) {
+                            break;
+                        }
+                    }
+                    bool quit = (quitFlag.loadAcquire() != 0);
+                    manifestMutex.lock();
+                    if (quit == false) {
+                        pendingManifest[manifestEntry.number] = manifestEntry;
+                        if (previous) {
+                            previousManifest[manifestEntry.number] = oldEntry;
+                        }
+                    } else if (previous) {
+                        // CANCELED BEFORE THIS SOURCE WENT OUT, SO IT KEEPS WHAT THE MANIFEST SAID ABOUT IT
+                        newManifest[filename] = oldEntry;
+                    }
+                    manifestMutex.unlock();
+                    if (quit) {
+                        break;
+                    }
+                    threadPool.start(new LAUPoseExportTask(this, filename, manifestEntry.number, manifestEntry.train));
+                }
+            }
+        }
+        doneCount.storeRelease(n + 1);
+    }
+    threadPool.waitForDone();
+
+    // A CANCELED RUN NEVER SAW SOME SOURCES, SO THEIR OUTPUTS STAY AND STAY IN THE MANIFEST, OTHERWISE THEY ARE ORPHANS
+    if (quitFlag.loadAcquire()) {
+        for (QHash<QString, ManifestEntry>::const_iterator it = oldManifest.constBegin(); it != oldManifest.constEnd(); it++) {
+            newManifest[it.key()] = it.value();
+        }
+    } else {
+        for (QHash<QString, ManifestEntry>::const_iterator it = oldManifest.constBegin(); it != oldManifest.constEnd(); it++) {
+            removeOutputs(it.value());
+            removedCount.fetchAndAddRelaxed(1);
+        }
+    }
+    oldManifest.clear();
+    saveManifest();
+
+    if (quitFlag.loadAcquire() == 0 && writeYaml()) {
+        okayFlag.storeRelease(1);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QStringList LAUPoseExporter::outputFiles(int number, bool train, int classIndex) const
+{
+    QString newFileString = QString("%1").arg(number);
+    while (newFileString.length() < 9) {
+        newFileString.prepend(QString("0"));
+    }
+
+    QStringList strings;
+    if (exportMode == ExportClassify) {
+        if (classIndex >= 0 && classIndex < classTrainDirs.count()) {
+            QDir classDir = (train) ? classTrainDirs.at(classIndex) : classValidDirs.at(classIndex);
+            strings << QString("%1/%2.tif").arg(classDir.absolutePath()).arg(newFileString);
+        }
+    } else {
+        QDir imageDir = (train) ? imageTrainDir : imageValidDir;
+        QDir labelDir = (train) ? labelTrainDir : labelValidDir;
+        strings << QString("%1/%2.tif").arg(imageDir.absolutePath()).arg(newFileString);
+        strings << QString("%1/%2.txt").arg(labelDir.absolutePath()).arg(newFileString);
+    }
+    return (strings);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QByteArray LAUPoseExporter::labelHash(const LAUDatasetIndex::Entry &entry)
+{
+    // EVERYTHING FROM THE XML PACKET THAT ENDS UP IN AN OUTPUT, TAKEN FROM THE INDEX SO NO HEADER IS READ TWICE
+    QByteArray byteArray;
+    QDataStream stream(&byteArray, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << (qint32)entry.classIndex << entry.confidence << (qint32)entry.width << (qint32)entry.height;
+    stream << entry.xVector << entry.yVector << entry.zVector;
+    return (QCryptographicHash::hash(byteArray, QCryptographicHash::Md5));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseExporter::removeOutputs(const ManifestEntry &entry)
+{
+    QDir outputDir(outputDirectoryString);
+    for (int n = 0; n < entry.outputs.count(); n++) {
+        QFile::remove(outputDir.absoluteFilePath(entry.outputs.at(n)));
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseExporter::loadManifest()
+{
+    QFile file(QString("%1/%2").arg(outputDirectoryString).arg(LAUPOSEEXPORTERMANIFEST));
+    if (file.open(QIODevice::ReadOnly) == false) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    QString parameters;
+    qint32 count = 0;
+    stream >> magic >> version >> parameters >> count;
+    if (magic != LAUPOSEEXPORTERMAGIC || version != LAUPOSEEXPORTERVERSION || count < 0) {
+        return;
+    }
+
+    QHash<QString, ManifestEntry> hash;
+    for (int n = 0; n < count && stream.status() == QDataStream::Ok; n++) {
+        QString string;
+        ManifestEntry entry;
+        stream >> string >> entry.modified >> entry.labelHash >> entry.number >> entry.train >> entry.outputs;
+        if (stream.status() == QDataStream::Ok) {
+            hash[string] = entry;
+        }
+    }
+    file.close();
+
+    // DIFFERENT SETTINGS MEAN EVERY OLD OUTPUT IS WRONG, SO CLEAR THEM OUT AND START NUMBERING FROM ONE
+    if (parameters != parameterString) {
+        for (QHash<QString, ManifestEntry>::const_iterator it = hash.constBegin(); it != hash.constEnd(); it++) {
+            removeOutputs(it.value());
+            removedCount.fetchAndAddRelaxed(1);
+        }
+        return;
+    }
+    oldManifest = hash;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseExporter::saveManifest()
+{
+    // QSAVEFILE WRITES TO A TEMPORARY FILE AND RENAMES IT SO A CRASH NEVER LEAVES HALF A MANIFEST
+    QSaveFile file(QString("%1/%2").arg(outputDirectoryString).arg(LAUPOSEEXPORTERMANIFEST));
+    if (file.open(QIODevice::WriteOnly) == false) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    QMutexLocker locker(&manifestMutex);
+    stream << (quint32)LAUPOSEEXPORTERMAGIC << (qint32)LAUPOSEEXPORTERVERSION << parameterString << (qint32)newManifest.count();
+    for (QHash<QString, ManifestEntry>::const_iterator it = newManifest.constBegin(); it != newManifest.constEnd(); it++) {
+        stream << it.key() << it.value().modified << it.value().labelHash << it.value().number << it.value().train << it.value().outputs;
+    }
+    file.commit();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUPoseExporter::writeYaml()
+{
+    QFile yamlFile(QString("%1/%2.yaml").arg(outputDirectoryString).arg(outputDirectoryString.split("/").last()));
+    if (yamlFile.open(QIODevice::WriteOnly)) {
+        QTextStream stream(&yamlFile);
+        stream << "# Ultralytics YOLO 🚀, AGPL-3.0 license\n";
+        if (exportMode == ExportClassify) {
+            stream << "# COCO8-classifier dataset (first 8 images from COCO train2017) by Ultralytics\n";
+        } else {
+            stream << "# COCO8-pose dataset (first 8 images from COCO train2017) by Ultralytics\n";
+        }
+        stream << "\n";
+        stream << "# Example usage: yolo train data=coco8-pose.yaml\n";
+        stream << "# parent\n";
+        stream << "# ├── ultralytics\n";
+        stream << "# └── datasets\n";
+        stream << "#     └── cowPose  ← downloads here (1 MB)\n";
+        stream << "\n";
+        stream << "# Train/val/test sets as 1) dir: path/to/imgs, 2) file: path/to/imgs.txt, or 3) list: [path/to/imgs1, path/to/imgs2, ..]\n";
+        stream << "path:  " << outputDirectoryString << " # dataset root dir\n";
+        stream << "train: images/train # train images (relative to 'path') 4 images\n";
+        stream << "val:   images/val # val images (relative to 'path') 4 images\n";
+        stream << "\n";
+
+        QStringList labels = poseAnnotation.labels();
+        if (exportMode == ExportClassify) {
+            stream << "# number of classes\n";
+            stream << "nc: " << labels.count() << "\n";
+            stream << "\n";
+            stream << "# Class Names\n";
+            stream << "names: [";
+            for (int n = 0; n < labels.count(); n++) {
+                if (n > 0) {
+                    stream << ",\"" << labels.at(n) << "\"";
+                } else {
+                    stream << "\"" << labels.at(n) << "\"";
+                }
+            }
+            stream << "]\n";
+        } else {
+            stream << "# Keypoints\n";
+#ifdef ZOOMINTOHEAD
+            stream << "kpt_shape: [" << 6 << ", 3]  # number of keypoints, number of dims (3 for x,y,visible)\n";
+#else
+            stream << "kpt_shape: [" << poseAnnotation.fiducials() << ", 3]  # number of keypoints, number of dims (3 for x,y,visible)\n";
+#endif
+            stream << "\n";
+            stream << "# Classes\n";
+            stream << "names:\n";
+            for (int n = 0; n < labels.count(); n++) {
+                stream << "  " << n << ": " << labels.at(n) << "\n";
+            }
+        }
+
+        yamlFile.close();
+        return (true);
+    }
+    return (false);
+}
@@ -0,0 +1,168 @@
+#ifndef LAUPOSEEXPORTER_H
+#define LAUPOSEEXPORTER_H
+
+#include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QStringList>
+
+#include "lauimage.h"
+#include "lauposeannotation.h"
+#include "laudatasetindex.h"
+
+#define LAUPOSEEXPORTERWINDOW       4
+#define LAUPOSEEXPORTERMANIFEST     "export.manifest"
+#define LAUPOSEEXPORTERMAGIC        0x4C415545
+#define LAUPOSEEXPORTERVERSION      1
+
+class LAUPoseExporter;
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUPoseExportTask : public QRunnable
+{
+public:
+    LAUPoseExportTask(LAUPoseExporter *obj, QString string, int num, bool train) : object(obj), fileString(string), number(num), trainFlag(train) { ; }
+
+protected:
+    void run();
+
+private:
+    LAUPoseExporter *object;
+    QString fileString;
+    int number;
+    bool trainFlag;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUPoseExporter : public QThread
+{
+    Q_OBJECT
+
+public:
+    // POSE WRITES AN IMAGE AND A LABEL FILE PER FRAME, CLASSIFY JUST FILES THE IMAGE UNDER ITS CLASS NAME
+    enum ExportMode { ExportPose, ExportClassify };
+
+    // EVERY NUMIMAGES-TH LABELED IMAGE GOES TO VALIDATION, THE REST TO TRAINING
+    explicit LAUPoseExporter(QString input, QString output, LAUPoseAnnotation annotation, int numImages, bool skipDuplicates = false, ExportMode mode = ExportPose, QObject *parent = nullptr);
+    ~LAUPoseExporter();
+
+    // IMAGES THE WALKER HAS FOUND SO FAR, WHICH ONLY STOPS GROWING ONCE THE WALK IS DONE
+    int count() const
+    {
+        return (foundCount.loadAcquire());
+    }
+
+    // IMAGES LOOKED AT SO FAR, LABELED OR NOT
+    int progress() const
+    {
+        return (doneCount.loadAcquire());
+    }
+
+    int exported() const
+    {
+        return (exportedCount.loadAcquire());
+    }
+
+    int failed() const
+    {
+        return (failedCount.loadAcquire());
+    }
+
+    // IMAGES LEFT ALONE BECAUSE THE MANIFEST SAYS THEIR OUTPUTS ARE STILL CURRENT
+    int unchanged() const
+    {
+        return (unchangedCount.loadAcquire());
+    }
+
+    // SOURCES WHOSE OUTPUTS WERE DELETED, BECAUSE THEY ARE GONE, UNLABELED, NOW DUPLICATES, OR THE SETTINGS CHANGED
+    int removed() const
+    {
+        return (removedCount.loadAcquire());
+    }
+
+    // TRUE ONCE EVERY IMAGE HAS BEEN DISPATCHED AND THE YAML FILE IS WRITTEN
+    bool isOkay() const
+    {
+        return (okayFlag.loadAcquire() != 0);
+    }
+
+    void cancel()
+    {
+        quitFlag.storeRelease(1);
+    }
+
+    // THIS METHOD IS CALLED FROM THE WORKER THREADS
+    void exportImage(QString filename, int number, bool train);
+
+protected:
+    void run();
+
+private:
+    // WHAT WE KNEW ABOUT A SOURCE WHEN WE LAST EXPORTED IT, AND WHERE ITS OUTPUTS WENT RELATIVE TO THE OUTPUT DIRECTORY
+    typedef struct {
+        qint64 modified;
+        QByteArray labelHash;
+        qint32 number;
+        bool train;
+        QStringList outputs;
+    } ManifestEntry;
+
+    QString inputDirectoryString;
+    QString outputDirectoryString;
+    LAUPoseAnnotation poseAnnotation;
+    int numImages;
+    bool skipDuplicatesFlag;
+    ExportMode exportMode;
+
+    QDir imageTrainDir, imageValidDir;
+    QDir labelTrainDir, labelValidDir;
+    QList<QDir> classTrainDirs, classValidDirs;
+
+    // OUTPUT NUMBERS ARE HANDED OUT IN WALK ORDER BEFORE DISPATCH, SO THEY DON'T DEPEND ON WHICH WORKER FINISHES FIRST,
+    // AND A SOURCE ALREADY IN THE MANIFEST KEEPS THE NUMBER IT HAD LAST TIME
+    QThreadPool threadPool;
+    QSemaphore slotSemaphore;
+
+    QAtomicInt foundCount;
+    QAtomicInt doneCount;
+    QAtomicInt exportedCount;
+    QAtomicInt failedCount;
+    QAtomicInt unchangedCount;
+    QAtomicInt removedCount;
+    QAtomicInt quitFlag;
+    QAtomicInt okayFlag;
+
+    // KEYED BY SOURCE FILE, THE NEW MANIFEST ONLY GETS AN ENTRY ONCE ITS OUTPUTS ARE SAFELY ON DISK
+    QString parameterString;
+    QHash<QString, ManifestEntry> oldManifest;
+    QHash<QString, ManifestEntry> newManifest;
+    QHash<int, ManifestEntry> pendingManifest;
+    QHash<int, ManifestEntry> previousManifest;
+    QMutex manifestMutex;
+
+    // 640X640 DESTINATIONS HANDED FROM ONE WORKER TO THE NEXT, SO EACH FRAME DOESN'T ALLOCATE ITS OWN
+    QList<LAUImage> destinationList;
+    QMutex destinationMutex;
+    LAUImage takeDestination(const LAUImage &source);
+    void giveDestination(const LAUImage &image);
+
+    bool makeDirectories();
+    bool writeYaml();
+    QStringList outputFiles(int number, bool train, int classIndex) const;
+    static QByteArray labelHash(const LAUDatasetIndex::Entry &entry);
+    void removeOutputs(const ManifestEntry &entry);
+    void loadManifest();
+    void saveManifest();
+};
+
+#endif // LAUPOSEEXPORTER_H
@@ -0,0 +1,259 @@
+#include "lauposeimporter.h"
+#include "lauimage.h"
+#include "lauimagepreviewcache.h"
+#include "lauimagewriterobject.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseImportTask::run()
+{
+    for (int n = 0; n < fileStrings.count(); n++) {
+        if (cancelFlag->loadAcquire()) {
+            return;
+        }
+        object->import(fileStrings.at(n));
+        doneCount->fetchAndAddRelaxed(1);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseImporter::LAUPoseImporter(QStringList labels, QStringList fiducials, bool replace) : labelStrings(labels), fiducialStrings(fiducials), replaceFlag(replace), importedCount(0), skippedCount(0), failedCount(0)
+{
+    ;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUPoseImporter::loadCoco(QString filename, QString *error)
+{
+    QFile file(filename);
+    if (file.open(QIODevice::ReadOnly) == false) {
+        *error = file.errorString();
+        return (false);
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    file.close();
+    if (document.isNull()) {
+        *error = parseError.errorString();
+        return (false);
+    }
+    QJsonObject root = document.object();
+
+    // MATCH CATEGORIES TO OUR CLASSES BY NAME ONLY, AND EACH CATEGORY'S KEYPOINTS TO OUR FIDUCIALS BY NAME IF THEY HAVE THEM, OTHERWISE BY POSITION
+    QHash<int, int> classHash;
+    QHash<int, QVector<int> > keypointHash;
+    QStringList unknownStrings;
+    QJsonArray categories = root.value("categories").toArray();
+    for (int n = 0; n < categories.count(); n++) {
+        QJsonObject category = categories.at(n).toObject();
+        int id = category.value("id").toInt();
+        int index = labelStrings.indexOf(category.value("name").toString());
+        if (index < 0) {
+            // GUESSING BY POSITION WOULD QUIETLY FILE THESE UNDER THE WRONG CLASS, SO THEIR ANNOTATIONS ARE SKIPPED
+            unknownStrings << category.value("name").toString();
+            continue;
+        }
+        classHash[id] = index;
+
+        QJsonArray names = category.value("keypoints").toArray();
+        QVector<int> mapping;
+        bool nameFlag = false;
+        for (int m = 0; m < names.count(); m++) {
+            mapping << fiducialStrings.indexOf(names.at(m).toString());
+            nameFlag = nameFlag || (mapping.last() >= 0);
+        }
+        if (nameFlag == false) {
+            mapping.clear();
+        }
+        keypointHash[id] = mapping;
+    }
+
+    QHash<int, QString> imageHash;
+    QJsonArray images = root.value("images").toArray();
+    for (int n = 0; n < images.count(); n++) {
+        QJsonObject image = images.at(n).toObject();
+        imageHash[image.value("id").toInt()] = QFileInfo(image.value("file_name").toString()).completeBaseName();
+    }
+
+    QJsonArray annotations = root.value("annotations").toArray();
+    for (int n = 0; n < annotations.count(); n++) {
+        QJsonObject annotation = annotations.at(n).toObject();
+        QString string = imageHash.value(annotation.value("image_id").toInt());
+        QJsonArray keypoints = annotation.value("keypoints").toArray();
+        int category = annotation.value("category_id").toInt();
+        if (string.isEmpty() || keypoints.isEmpty() || classHash.contains(category) == false) {
+            continue;
+        }
+
+        Instance instance;
+        instance.classIndex = classHash.value(category);
+        instance.confidence = annotation.contains("score") ? (float)annotation.value("score").toDouble() : -1.0f;
+        instance.area = annotation.value("area").toDouble();
+        if (instance.area <= 0.0) {
+            QJsonArray box = annotation.value("bbox").toArray();
+            instance.area = (box.count() == 4) ? box.at(2).toDouble() * box.at(3).toDouble() : 0.0;
+        }
+
+        // FIDUCIALS THE VENDOR DIDN'T LABEL STAY HIDDEN AT THE ORIGIN
+        instance.xVector.fill(0, fiducialStrings.count());
+        instance.yVector.fill(0, fiducialStrings.count());
+        instance.zVector.fill(0, fiducialStrings.count());
+
+        // COCO KEYPOINTS ARE X,Y,V IN PIXELS WITH V = 2 MEANING VISIBLE, 1 LABELED BUT HIDDEN, AND 0 NOT LABELED
+        QVector<int> mapping = keypointHash.value(category);
+        for (int m = 0; m < keypoints.count() / 3; m++) {
+            int index = (mapping.isEmpty()) ? m : mapping.value(m, -1);
+            if (index >= 0 && index < fiducialStrings.count()) {
+                instance.xVector[index] = qRound(keypoints.at(3 * m + 0).toDouble());
+                instance.yVector[index] = qRound(keypoints.at(3 * m + 1).toDouble());
+                instance.zVector[index] = (keypoints.at(3 * m + 2).toInt() == 2);
+            }
+        }
+
+        // WE HOLD ONE POSE PER IMAGE, SO KEEP THE BIGGEST ONE
+        if (cocoHash.contains(string) == false || cocoHash.value(string).area < instance.area) {
+            cocoHash[string] = instance;
+        }
+    }
+
+    // TELL THE CALLER ABOUT CATEGORIES WE LEFT OUT EVEN WHEN THE REST IMPORTS FINE
+    if (unknownStrings.isEmpty() == false) {
+        *error = QString("Categories that match no class were skipped: %1.").arg(unknownStrings.join(", "));
+    }
+    if (cocoHash.isEmpty()) {
+        *error = QString("No keypoint annotations found. %1").arg(*error).trimmed();
+        return (false);
+    }
+    return (true);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUPoseImporter::readYolo(QString filename, QSize size, Instance *instance) const
+{
+    QFile file(QString("%1/%2.txt").arg(yoloDirectoryString).arg(QFileInfo(filename).completeBaseName()));
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text) == false) {
+        return (false);
+    }
+
+    // EACH LINE IS CLASS, BOX, THEN X,Y[,V] PER KEYPOINT NORMALIZED TO THE FULL IMAGE, WITH A TRAILING CONFIDENCE ON PREDICTIONS
+    int fiducials = fiducialStrings.count();
+    bool foundFlag = false;
+    while (file.atEnd() == false) {
+        QStringList strings = QString(file.readLine()).simplified().split(" ");
+        int rest = strings.count() - 5;
+        if (rest < 0 || fiducials == 0) {
+            continue;
+        }
+
+        int dims = 0;
+        bool confidenceFlag = false;
+        if (rest == 3 * fiducials || rest == 3 * fiducials + 1) {
+            dims = 3;
+            confidenceFlag = (rest == 3 * fiducials + 1);
+        } else if (rest == 2 * fiducials || rest == 2 * fiducials + 1) {
+            dims = 2;
+            confidenceFlag = (rest == 2 * fiducials + 1);
+        } else {
+            continue;
+        }
+
+        int classIndex = strings.at(0).toInt();
+        double area = strings.at(3).toDouble() * strings.at(4).toDouble();
+        if (classIndex < 0 || classIndex >= labelStrings.count() || (foundFlag && area <= instance->area)) {
+            continue;
+        }
+
+        instance->classIndex = classIndex;
+        instance->area = area;
+        instance->confidence = (confidenceFlag) ? strings.last().toFloat() : -1.0f;
+        instance->xVector.resize(fiducials);
+        instance->yVector.resize(fiducials);
+        instance->zVector.resize(fiducials);
+        for (int n = 0; n < fiducials; n++) {
+            instance->xVector[n] = qRound(strings.at(5 + dims * n + 0).toDouble() * size.width());
+            instance->yVector[n] = qRound(strings.at(5 + dims * n + 1).toDouble() * size.height());
+            instance->zVector[n] = (dims == 2) || (strings.at(5 + dims * n + 2).toDouble() >= 0.5);
+        }
+        foundFlag = true;
+    }
+    file.close();
+
+    return (foundFlag);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseImporter::import(QString filename)
+{
+    // THE HEADER GIVES US THE SIZE TO SCALE NORMALIZED COORDINATES BY, AND ANY LABELS ALREADY THERE
+    QSize size;
+    QByteArray xml = LAUImage::readXmlPacket(filename, &size);
+    if (size.isValid() == false) {
+        failedCount.fetchAndAddRelaxed(1);
+        return;
+    }
+    if (xml.isEmpty() == false && replaceFlag == false) {
+        skippedCount.fetchAndAddRelaxed(1);
+        return;
+    }
+
+    Instance instance;
+    bool foundFlag = false;
+    if (yoloDirectoryString.isEmpty()) {
+        QString string = QFileInfo(filename).completeBaseName();
+        foundFlag = cocoHash.contains(string);
+        if (foundFlag) {
+            instance = cocoHash.value(string);
+        }
+    } else {
+        foundFlag = readYolo(filename, size, &instance);
+    }
+    if (foundFlag == false) {
+        skippedCount.fetchAndAddRelaxed(1);
+        return;
+    }
+
+    LAUPoseAnnotation annotation(labelStrings, fiducialStrings);
+    annotation.setClassIndex(instance.classIndex);
+    annotation.setConfidence(instance.confidence);
+    annotation.setImageSize(size.width(), size.height());
+    for (int n = 0; n < fiducialStrings.count(); n++) {
+        annotation.setFiducial(n, instance.xVector.at(n), instance.yVector.at(n), instance.zVector.at(n) != 0);
+    }
+
+    // ONLY THE DIRECTORY IS REWRITTEN, SO THE PIXELS AND THEIR CACHED PREVIEWS ARE UNTOUCHED, AND IT IS
+    // WRITTEN INTO A COPY THAT IS THEN SWAPPED IN SO A CRASH NEVER LEAVES THE ORIGINAL WITHOUT A DIRECTORY
+    QFileInfo fileInfo(filename);
+    qint64 bytes = fileInfo.size();
+    QDateTime time = fileInfo.lastModified();
+    QString tempString = LAUImageWriterObject::temporaryFilename(filename);
+    if (LAUImage::copyWithXmlPacket(filename, tempString, annotation.xml()) == false) {
+        failedCount.fetchAndAddRelaxed(1);
+        return;
+    } else if (LAUImageWriterObject::replaceFile(tempString, filename) == false) {
+        QFile::remove(tempString);
+        failedCount.fetchAndAddRelaxed(1);
+        return;
+    }
+    LAUImagePreviewCache::carryForward(filename, bytes, time);
+    importedCount.fetchAndAddRelaxed(1);
+
+    QMutexLocker locker(&mutex);
+    importedList << filename;
+}
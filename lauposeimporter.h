@@ -0,0 +1,106 @@
+#ifndef LAUPOSEIMPORTER_H
+#define LAUPOSEIMPORTER_H
+
+#include <QHash>
+#include <QSize>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QString>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QStringList>
+
+#include "lauposeannotation.h"
+
+#define LAUPOSEIMPORTERBLOCKSIZE    32
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUPoseImporter
+{
+public:
+    LAUPoseImporter(QStringList labels, QStringList fiducials, bool replace = false);
+
+    // YOLO LABELS ARE READ FROM A TXT FILE WITH THE SAME BASE NAME AS THE IMAGE, ONE FILE AT A TIME IN THE WORKERS
+    void setYoloDirectory(QString directory)
+    {
+        yoloDirectoryString = directory;
+    }
+
+    // COCO LABELS ARE ALL IN ONE FILE, SO IT IS READ ONCE UP FRONT, AND ERROR CAN HOLD A WARNING EVEN WHEN IT SUCCEEDS
+    bool loadCoco(QString filename, QString *error);
+
+    // THIS METHOD IS CALLED FROM THE WORKER THREADS, NEVER DECODES OR RECOMPRESSES PIXELS
+    void import(QString filename);
+
+    int imported() const
+    {
+        return (importedCount.loadAcquire());
+    }
+
+    int skipped() const
+    {
+        return (skippedCount.loadAcquire());
+    }
+
+    int failed() const
+    {
+        return (failedCount.loadAcquire());
+    }
+
+    QStringList importedStrings() const
+    {
+        QMutexLocker locker(&mutex);
+        return (importedList);
+    }
+
+private:
+    typedef struct {
+        int classIndex;
+        float confidence;
+        double area;
+        QVector<int> xVector;
+        QVector<int> yVector;
+        QVector<unsigned char> zVector;
+    } Instance;
+
+    QStringList labelStrings;
+    QStringList fiducialStrings;
+    bool replaceFlag;
+
+    QString yoloDirectoryString;
+
+    // ONE INSTANCE PER IMAGE, THE LARGEST, KEYED BY THE IMAGE'S BASE NAME WITH COORDINATES ALREADY IN PIXELS
+    QHash<QString, Instance> cocoHash;
+
+    QAtomicInt importedCount;
+    QAtomicInt skippedCount;
+    QAtomicInt failedCount;
+
+    mutable QMutex mutex;
+    QStringList importedList;
+
+    bool readYolo(QString filename, QSize size, Instance *instance) const;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUPoseImportTask : public QRunnable
+{
+public:
+    LAUPoseImportTask(LAUPoseImporter *obj, QStringList strings, QAtomicInt *cancel, QAtomicInt *done) : object(obj), fileStrings(strings), cancelFlag(cancel), doneCount(done) { ; }
+
+protected:
+    void run();
+
+private:
+    LAUPoseImporter *object;
+    QStringList fileStrings;
+    QAtomicInt *cancelFlag;
+    QAtomicInt *doneCount;
+};
+
+#endif // LAUPOSEIMPORTER_H
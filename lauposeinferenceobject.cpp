@@ -0,0 +1,193 @@
+#include "lauposeinferenceobject.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseInferenceObject::LAUPoseInferenceObject(QString filename, QObject *parent) : QThread(parent), network(nullptr), quitFlag(false), stampCounter(0)
+{
+    // LOAD THE MODEL HERE SO THE CALLER KNOWS RIGHT AWAY IF IT'S USABLE, BUT ONLY EVER RUN IT ON OUR OWN THREAD
+    network = new LAUYoloPoseObject(filename);
+
+    start(QThread::LowPriority);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseInferenceObject::~LAUPoseInferenceObject()
+{
+    mutex.lock();
+    quitFlag = true;
+    queueCondition.wakeAll();
+    mutex.unlock();
+
+    wait();
+    delete network;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseInferenceObject::setCursor(QStringList strings)
+{
+    QMutexLocker locker(&mutex);
+    cursorStrings = strings;
+
+    // LET GO OF THE PIXELS OF ANY IMAGE THE USER HAS MOVED AWAY FROM
+    QStringList keys = images.keys();
+    for (int n = 0; n < keys.count(); n++) {
+        if (cursorStrings.contains(keys.at(n)) == false) {
+            images.remove(keys.at(n));
+        }
+    }
+    queueCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseInferenceObject::enqueue(QString filename, LAUImage image)
+{
+    QMutexLocker locker(&mutex);
+    if (image.isNull() || cursorStrings.contains(filename) == false || predictions.contains(filename)) {
+        return;
+    }
+    images[filename] = image;
+    queueCondition.wakeAll();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUPoseInferenceObject::prediction(QString filename, Prediction *prediction) const
+{
+    QMutexLocker locker(&mutex);
+    if (predictions.contains(filename)) {
+        *prediction = predictions.value(filename);
+        stamps[filename] = ++stampCounter;
+        return (true);
+    }
+    return (false);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseInferenceObject::onInferenceComplete(QString filename)
+{
+    emit emitPredictionReady(filename);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseInferenceObject::run()
+{
+    if (network->isValid() == false) {
+        return;
+    }
+
+    forever {
+        // WAIT FOR AN IMAGE, ALWAYS TAKING THE ONE CLOSEST TO THE CURSOR FIRST
+        mutex.lock();
+        QString filename;
+        while (quitFlag == false) {
+            for (int n = 0; n < cursorStrings.count(); n++) {
+                if (images.contains(cursorStrings.at(n))) {
+                    filename = cursorStrings.at(n);
+                    break;
+                }
+            }
+            if (filename.isEmpty() == false) {
+                break;
+            }
+            queueCondition.wait(&mutex);
+        }
+        if (quitFlag) {
+            mutex.unlock();
+            return;
+        }
+        LAUImage image = images.take(filename);
+        mutex.unlock();
+
+        Prediction prediction = infer(image);
+        image = LAUImage();
+
+        mutex.lock();
+        if (predictions.count() >= LAUPOSEINFERENCEMAXPREDICTIONS) {
+            evictPredictions();
+        }
+        predictions[filename] = prediction;
+        stamps[filename] = ++stampCounter;
+        mutex.unlock();
+
+        QMetaObject::invokeMethod(this, "onInferenceComplete", Qt::QueuedConnection, Q_ARG(QString, filename));
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUPoseInferenceObject::evictPredictions()
+{
+    // THE CALLER HOLDS THE MUTEX, DROP THE LEAST RECENTLY USED QUARTER AT ONCE SO THIS SORT IS RARE
+    QVector<quint64> values;
+    values.reserve(stamps.count());
+    for (QHash<QString, quint64>::const_iterator it = stamps.constBegin(); it != stamps.constEnd(); it++) {
+        values << it.value();
+    }
+    int count = values.count() / 4;
+    if (count < 1) {
+        return;
+    }
+    std::nth_element(values.begin(), values.begin() + count, values.end());
+    quint64 cutoff = values.at(count);
+
+    // NEVER DROP ANYTHING AROUND THE CURSOR, THE USER IS ABOUT TO LOOK AT IT
+    QHash<QString, quint64>::iterator it = stamps.begin();
+    while (it != stamps.end()) {
+        if (it.value() < cutoff && cursorStrings.contains(it.key()) == false) {
+            predictions.remove(it.key());
+            it = stamps.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUPoseInferenceObject::Prediction LAUPoseInferenceObject::infer(LAUImage image)
+{
+    Prediction prediction;
+    prediction.classIndex = -1;
+    prediction.confidence = 0.0f;
+
+#ifdef USECOWFIDUCIALS
+    QList<LAUMemoryObject> objects = network->process(image.zeroPad(0, 0, 0, 640 - image.height()));
+#else
+    QList<LAUMemoryObject> objects = network->process(image);
+#endif
+    if (objects.isEmpty()) {
+        return (prediction);
+    }
+
+    // KEEP THE CLASS THE MODEL IS MOST SURE OF, SAME AS THE BATCH VALIDATION DOES
+    for (int n = 0; n < qMax(1, network->classes()); n++) {
+        float confidence = LAUPOSEINFERENCETHRESHOLD;
+        QList<QVector3D> points = network->points(n, &confidence);
+        if (points.count() > 2 && confidence > prediction.confidence) {
+            prediction.classIndex = n;
+            prediction.confidence = confidence;
+
+            // DROP THE BOUNDING BOX THAT LEADS THE LIST SO ONLY THE FIDUCIALS ARE LEFT
+            prediction.points = points.mid(2);
+        }
+    }
+    return (prediction);
+}
@@ -0,0 +1,77 @@
+#ifndef LAUPOSEINFERENCEOBJECT_H
+#define LAUPOSEINFERENCEOBJECT_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QObject>
+#include <QVector3D>
+#include <QStringList>
+#include <QWaitCondition>
+
+#include "lauimage.h"
+#include "laudeepnetworkobject.h"
+
+#define LAUPOSEINFERENCETHRESHOLD       0.70f
+#define LAUPOSEINFERENCEMAXPREDICTIONS  65536
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUPoseInferenceObject : public QThread
+{
+    Q_OBJECT
+
+public:
+    typedef struct {
+        int classIndex;
+        float confidence;
+        QList<QVector3D> points;
+    } Prediction;
+
+    explicit LAUPoseInferenceObject(QString filename, QObject *parent = nullptr);
+    ~LAUPoseInferenceObject();
+
+    bool isValid() const
+    {
+        return (network->isValid());
+    }
+
+    // LIST OF FILES AROUND THE CURSOR IN ORDER OF PRIORITY, ANYTHING QUEUED OUTSIDE OF IT IS DROPPED
+    void setCursor(QStringList strings);
+
+    // HAND OVER A DECODED IMAGE, IGNORED IF IT'S OUTSIDE THE CURSOR OR ALREADY PREDICTED
+    void enqueue(QString filename, LAUImage image);
+
+    // PREDICTIONS ARE KEPT FOR THE SESSION, UP TO A LIMIT, SO GOING BACK AND FORTH NEVER RECOMPUTES THEM
+    bool prediction(QString filename, Prediction *prediction) const;
+
+public slots:
+    void onInferenceComplete(QString filename);
+
+protected:
+    void run();
+
+private:
+    LAUYoloPoseObject *network;
+
+    mutable QMutex mutex;
+    QWaitCondition queueCondition;
+    QStringList cursorStrings;
+    QHash<QString, LAUImage> images;
+    QHash<QString, Prediction> predictions;
+    bool quitFlag;
+
+    // WHEN EACH PREDICTION WAS LAST ASKED FOR, SO A FULL CACHE DROPS THE ONES THE USER LEFT BEHIND LONGEST AGO
+    mutable QHash<QString, quint64> stamps;
+    mutable quint64 stampCounter;
+
+    Prediction infer(LAUImage image);
+    void evictPredictions();
+
+signals:
+    void emitPredictionReady(QString filename);
+};
+
+#endif // LAUPOSEINFERENCEOBJECT_H
@@ -0,0 +1,354 @@
+#include "lauthumbnailbrowser.h"
+
+#include <QPainter>
+#include <QFileInfo>
+#include <QScrollBar>
+#include <QImageReader>
+#include <QMutexLocker>
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailTask::run()
+{
+    // DON'T BOTHER DECODING IF THE CELL SCROLLED OUT OF VIEW WHILE WE WERE QUEUED
+    if (object->isWanted(row, ticket) == false) {
+        return;
+    }
+
+    QImage image = thumbnail(fileString);
+    QMetaObject::invokeMethod(object, "onTaskComplete", Qt::QueuedConnection, Q_ARG(int, row), Q_ARG(unsigned int, ticket), Q_ARG(QImage, image));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QImage LAUThumbnailTask::thumbnail(QString filename)
+{
+    QSize size(LAUTHUMBNAILBROWSERSIZE, LAUTHUMBNAILBROWSERSIZE);
+
+    // A THUMBNAIL FROM AN EARLIER SESSION OR FROM THE GRID ITSELF
+    QImage image = LAUImagePreviewCache::lookup(filename, LAUIMAGEPREVIEWCACHESMALL);
+    if (image.isNull() == false) {
+        return (image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    }
+
+    // THE VIEWER'S LARGER PREVIEW IS STILL FAR CHEAPER THAN DECODING THE ORIGINAL
+    image = LAUImagePreviewCache::lookup(filename, LAUIMAGEPREVIEWCACHELARGE);
+    if (image.isNull() == false) {
+        image = image.scaled(QSize(LAUIMAGEPREVIEWCACHESMALL, LAUIMAGEPREVIEWCACHESMALL), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        LAUImagePreviewCache::insert(filename, LAUIMAGEPREVIEWCACHESMALL, image);
+        return (image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    }
+
+    // JPEG CAN DECODE STRAIGHT TO A FRACTION OF ITS RESOLUTION, WHICH IS PLENTY FOR A THUMBNAIL
+    QImageReader reader(filename);
+    if (reader.format() == "jpeg" && reader.size().isValid()) {
+        reader.setScaledSize(reader.size().scaled(size, Qt::KeepAspectRatio));
+        if (reader.read(&image)) {
+            return (image);
+        }
+    }
+
+    // OTHERWISE DECODE ONLY AS MANY TIFF ROWS AND COLUMNS AS THE THUMBNAIL NEEDS AND KEEP THE RESULT ON DISK
+    LAUImage lauImage = LAUImage::loadReduced(filename, QSize(LAUIMAGEPREVIEWCACHESMALL, LAUIMAGEPREVIEWCACHESMALL));
+    if (lauImage.isNull()) {
+        return (QImage());
+    }
+    image = LAUImagePreviewCache::preview(lauImage, LAUIMAGEPREVIEWCACHESMALL);
+    return (image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUThumbnailModel::LAUThumbnailModel(LAUDatasetIndex *index, QObject *parent) : QAbstractListModel(parent), datasetIndex(index), rows(index->count()), ticketCounter(0), firstRow(0), lastRow(-1)
+{
+    cache.setMaxCost(LAUTHUMBNAILBROWSERMEGABYTES * 1024);
+
+    // LEAVE HALF THE CORES FOR THE GUI AND THE PREFETCHER
+    threadPool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUThumbnailModel::~LAUThumbnailModel()
+{
+    // CANCEL EVERYTHING AND WAIT FOR THE RUNNING TASKS SINCE THEY HOLD A POINTER TO US
+    mutex.lock();
+    tickets.clear();
+    mutex.unlock();
+
+    threadPool.clear();
+    threadPool.waitForDone();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+int LAUThumbnailModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return (0);
+    }
+    return (rows);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QVariant LAUThumbnailModel::data(const QModelIndex &index, int role) const
+{
+    if (index.isValid() == false || index.row() >= rows) {
+        return (QVariant());
+    }
+    int row = index.row();
+
+    if (role == Qt::DecorationRole) {
+        // THE VIEW ONLY ASKS FOR VISIBLE CELLS, SO THIS IS WHERE THUMBNAILS GET REQUESTED
+        QPixmap *pixmap = cache.object(row);
+        if (pixmap) {
+            return (*pixmap);
+        }
+
+        QMutexLocker locker(&mutex);
+        if (tickets.contains(row) == false) {
+            unsigned int ticket = ++ticketCounter;
+            tickets[row] = ticket;
+            threadPool.start(new LAUThumbnailTask(row, datasetIndex->filename(row), ticket, const_cast<LAUThumbnailModel *>(this)));
+        }
+        return (QVariant());
+    } else if (role == Qt::DisplayRole) {
+        return (QFileInfo(datasetIndex->filename(row)).fileName());
+    } else if (role == Qt::ToolTipRole) {
+        return (datasetIndex->filename(row));
+    }
+
+    // BADGES COME FROM THE INDEX WITHOUT EVER TOUCHING THE DISK ON THE GUI THREAD
+    LAUDatasetIndex::Entry entry = datasetIndex->peek(row);
+    if (role == ScannedRole) {
+        return (entry.scanned);
+    } else if (role == LabeledRole) {
+        return (entry.labeled);
+    } else if (role == ClassRole) {
+        return (entry.classIndex);
+    } else if (role == ConfidenceRole) {
+        return (entry.confidence);
+    }
+    return (QVariant());
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailModel::refresh()
+{
+    int count = datasetIndex->count();
+    if (count > rows) {
+        beginInsertRows(QModelIndex(), rows, count - 1);
+        rows = count;
+        endInsertRows();
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailModel::invalidate(int row)
+{
+    if (row >= 0 && row < rows) {
+        // DROP THE OLD THUMBNAIL AND FORGET ANY DECODE IN FLIGHT SO THE NEXT PAINT ASKS FOR A FRESH ONE
+        cache.remove(row);
+        mutex.lock();
+        tickets.remove(row);
+        mutex.unlock();
+        emit dataChanged(this->index(row), this->index(row));
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailModel::setVisibleRows(int first, int last)
+{
+    QMutexLocker locker(&mutex);
+    firstRow = first - LAUTHUMBNAILBROWSERMARGIN;
+    lastRow = last + LAUTHUMBNAILBROWSERMARGIN;
+
+    // FORGET TASKS FOR CELLS THAT SCROLLED AWAY, THEY SEE THIS AND RETURN WITHOUT DECODING
+    QList<int> keys = tickets.keys();
+    for (int n = 0; n < keys.count(); n++) {
+        if (keys.at(n) < firstRow || keys.at(n) > lastRow) {
+            tickets.remove(keys.at(n));
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+bool LAUThumbnailModel::isWanted(int row, unsigned int ticket) const
+{
+    QMutexLocker locker(&mutex);
+    return (tickets.value(row, 0) == ticket);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailModel::onTaskComplete(int row, unsigned int ticket, QImage image)
+{
+    mutex.lock();
+    bool flag = (tickets.value(row, 0) == ticket);
+    if (flag) {
+        tickets.remove(row);
+    }
+    mutex.unlock();
+
+    if (flag == false || image.isNull()) {
+        return;
+    }
+
+    // PIXMAPS CAN ONLY BE CREATED ON THE GUI THREAD
+    QPixmap *pixmap = new QPixmap(QPixmap::fromImage(image));
+    cache.insert(row, pixmap, qMax(1, (int)((qint64)pixmap->width() * pixmap->height() * pixmap->depth() / 8 / 1024)));
+    emit dataChanged(this->index(row), this->index(row), QVector<int>() << Qt::DecorationRole);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+
+    QRect rect = option.rect.adjusted(4, 4, -4, -4);
+    if (option.state & QStyle::State_Selected) {
+        painter->fillRect(option.rect, option.palette.highlight());
+    }
+
+    // THE THUMBNAIL, OR A GRAY PLACEHOLDER UNTIL IT ARRIVES
+    QRect imageRect(rect.left(), rect.top(), rect.width(), LAUTHUMBNAILBROWSERSIZE);
+    QPixmap pixmap = index.data(Qt::DecorationRole).value<QPixmap>();
+    if (pixmap.isNull()) {
+        painter->fillRect(imageRect, QColor(64, 64, 64));
+    } else {
+        QRect target(QPoint(0, 0), pixmap.size().scaled(imageRect.size(), Qt::KeepAspectRatio));
+        target.moveCenter(imageRect.center());
+        painter->drawPixmap(target, pixmap);
+    }
+
+    // A DOT IN THE CORNER FOR THE LABEL STATE: GRAY UNKNOWN, RED UNLABELED, ORANGE UNCHECKED MODEL GUESS, GREEN LABELED
+    bool scanned = index.data(LAUThumbnailModel::ScannedRole).toBool();
+    bool labeled = index.data(LAUThumbnailModel::LabeledRole).toBool();
+    int classIndex = index.data(LAUThumbnailModel::ClassRole).toInt();
+    float confidence = index.data(LAUThumbnailModel::ConfidenceRole).toFloat();
+
+    QColor color(Qt::gray);
+    QString string("...");
+    if (scanned && labeled == false) {
+        color = QColor(Qt::red);
+        string = QString("unlabeled");
+    } else if (scanned) {
+        color = (confidence >= 0.0f) ? QColor(255, 165, 0) : QColor(Qt::green);
+        string = labelStrings.value(classIndex, QString("?"));
+        if (confidence >= 0.0f) {
+            string.append(QString(" %1").arg(confidence, 0, 'f', 2));
+        }
+    }
+    painter->setPen(QPen(Qt::black, 1.0));
+    painter->setBrush(color);
+    painter->drawEllipse(imageRect.left() + 4, imageRect.top() + 4, 12, 12);
+
+    // CLASS ON ONE LINE AND THE FILE NAME UNDER IT
+    QRect textRect(rect.left(), imageRect.bottom() + 2, rect.width(), option.fontMetrics.height());
+    painter->setPen(option.palette.color((option.state & QStyle::State_Selected) ? QPalette::HighlightedText : QPalette::Text));
+    painter->drawText(textRect, Qt::AlignCenter, string);
+    textRect.translate(0, option.fontMetrics.height());
+    painter->drawText(textRect, Qt::AlignCenter, option.fontMetrics.elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideMiddle, rect.width()));
+
+    painter->restore();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+QSize LAUThumbnailDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+
+    return (QSize(LAUTHUMBNAILBROWSERSIZE + 8, LAUTHUMBNAILBROWSERSIZE + 12 + 2 * option.fontMetrics.height()));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+LAUThumbnailBrowser::LAUThumbnailBrowser(LAUDatasetIndex *index, QStringList labels, QWidget *parent) : QListView(parent)
+{
+    thumbnailModel = new LAUThumbnailModel(index, this);
+    setModel(thumbnailModel);
+    setItemDelegate(new LAUThumbnailDelegate(labels, this));
+
+    // LIST MODE WRAPPED LEFT TO RIGHT WITH UNIFORM SIZES LAYS OUT BY ARITHMETIC, ICON MODE WOULD POSITION ALL 100K CELLS
+    setViewMode(QListView::ListMode);
+    setFlow(QListView::LeftToRight);
+    setWrapping(true);
+    setResizeMode(QListView::Adjust);
+    setUniformItemSizes(true);
+    setLayoutMode(QListView::Batched);
+    setBatchSize(1000);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setSpacing(4);
+
+    setWindowTitle(QString("Thumbnails"));
+    resize(6 * (LAUTHUMBNAILBROWSERSIZE + 16), 4 * (LAUTHUMBNAILBROWSERSIZE + 48));
+
+    connect(this, SIGNAL(activated(QModelIndex)), this, SLOT(onActivated(QModelIndex)));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailBrowser::setCurrentRow(int row)
+{
+    QModelIndex index = thumbnailModel->index(row);
+    if (index.isValid()) {
+        setCurrentIndex(index);
+        scrollTo(index, QAbstractItemView::PositionAtCenter);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailBrowser::scrollContentsBy(int dx, int dy)
+{
+    QListView::scrollContentsBy(dx, dy);
+    updateVisibleRows();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailBrowser::resizeEvent(QResizeEvent *event)
+{
+    QListView::resizeEvent(event);
+    updateVisibleRows();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+void LAUThumbnailBrowser::updateVisibleRows()
+{
+    // THE FIRST AND LAST CELLS TOUCHING THE VIEWPORT, FALLING BACK TO THE ENDS OF THE LIST
+    QModelIndex first = indexAt(QPoint(spacing() + 1, spacing() + 1));
+    QModelIndex last = indexAt(QPoint(viewport()->width() - spacing() - 1, viewport()->height() - spacing() - 1));
+
+    int firstRow = first.isValid() ? first.row() : 0;
+    int lastRow = last.isValid() ? last.row() : thumbnailModel->rowCount() - 1;
+    thumbnailModel->setVisibleRows(firstRow, lastRow);
+}
@@ -0,0 +1,149 @@
+#ifndef LAUTHUMBNAILBROWSER_H
+#define LAUTHUMBNAILBROWSER_H
+
+#include <QHash>
+#include <QCache>
+#include <QMutex>
+#include <QImage>
+#include <QPixmap>
+#include <QObject>
+#include <QRunnable>
+#include <QListView>
+#include <QThreadPool>
+#include <QStringList>
+#include <QResizeEvent>
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+
+#include "laudatasetindex.h"
+#include "lauimagepreviewcache.h"
+
+#define LAUTHUMBNAILBROWSERSIZE         160
+#define LAUTHUMBNAILBROWSERMEGABYTES    64
+#define LAUTHUMBNAILBROWSERMARGIN       64
+
+class LAUThumbnailModel;
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUThumbnailTask : public QRunnable
+{
+public:
+    LAUThumbnailTask(int rw, QString filename, unsigned int tckt, LAUThumbnailModel *obj) : row(rw), fileString(filename), ticket(tckt), object(obj) { ; }
+
+    // CHEAPEST SOURCE FIRST: CACHED THUMBNAIL, CACHED PREVIEW, SCALED JPEG OR SUBSAMPLED TIFF DECODE, AND ONLY THEN A FULL DECODE
+    static QImage thumbnail(QString filename);
+
+protected:
+    void run();
+
+private:
+    int row;
+    QString fileString;
+    unsigned int ticket;
+    LAUThumbnailModel *object;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUThumbnailModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role { LabeledRole = Qt::UserRole, ScannedRole, ClassRole, ConfidenceRole };
+
+    explicit LAUThumbnailModel(LAUDatasetIndex *index, QObject *parent = nullptr);
+    ~LAUThumbnailModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+    // CALL WHEN FILES ARE APPENDED TO THE INDEX OR A FILE'S LABELS CHANGE
+    void refresh();
+    void invalidate(int row);
+
+    // ONLY ROWS NEAR THIS RANGE ARE WORTH DECODING, ANYTHING QUEUED OUTSIDE IT IS DROPPED
+    void setVisibleRows(int first, int last);
+
+    // THIS METHOD IS CALLED FROM THE WORKER THREADS
+    bool isWanted(int row, unsigned int ticket) const;
+
+public slots:
+    void onTaskComplete(int row, unsigned int ticket, QImage image);
+
+private:
+    LAUDatasetIndex *datasetIndex;
+    int rows;
+
+    // ONLY THE THUMBNAILS OF RECENTLY VISIBLE CELLS ARE KEPT, COST IS IN KILOBYTES
+    mutable QCache<int, QPixmap> cache;
+    mutable QThreadPool threadPool;
+    mutable unsigned int ticketCounter;
+
+    // TICKETS OF PENDING TASKS ARE SHARED WITH THE WORKER THREADS
+    mutable QMutex mutex;
+    mutable QHash<int, unsigned int> tickets;
+    int firstRow, lastRow;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUThumbnailDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit LAUThumbnailDelegate(QStringList labels, QObject *parent = nullptr) : QStyledItemDelegate(parent), labelStrings(labels) { ; }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
+private:
+    QStringList labelStrings;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+class LAUThumbnailBrowser : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit LAUThumbnailBrowser(LAUDatasetIndex *index, QStringList labels, QWidget *parent = nullptr);
+
+    void refresh()
+    {
+        thumbnailModel->refresh();
+    }
+
+    void invalidate(int row)
+    {
+        thumbnailModel->invalidate(row);
+    }
+
+    void setCurrentRow(int row);
+
+public slots:
+    void onActivated(const QModelIndex &index)
+    {
+        emit emitImageSelected(index.row());
+    }
+
+protected:
+    void scrollContentsBy(int dx, int dy);
+    void resizeEvent(QResizeEvent *event);
+
+private:
+    LAUThumbnailModel *thumbnailModel;
+    void updateVisibleRows();
+
+signals:
+    void emitImageSelected(int row);
+};
+
+#endif // LAUTHUMBNAILBROWSER_H
@@ -8,9 +8,12 @@
 #include <QDebug>
 #include <QAction>
 #include <QBuffer>
+#include <QtMath>
 #include <QPainter>
+#include <QCoreApplication>
 #include <QGroupBox>
 #include <QMessageBox>
+#include <QDesktopServices>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QFormLayout>
@@ -43,25 +46,190 @@ bool ImageWithConfidencePacket_confidenceLessThanB(const ImageWithConfidencePack
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
-LAUYoloPoseLabelerWidget::LAUYoloPoseLabelerWidget(QStringList strings, QWidget *parent) : QWidget(parent), fileStrings(strings)
+LAUYoloPoseLabelerWidget::LAUYoloPoseLabelerWidget(QStringList strings, QWidget *parent) : QWidget(parent)
 {
-    if (fileStrings.isEmpty()){
-        QSettings settings;
+    QSettings settings;
+    if (strings.isEmpty()){
         QString directory = settings.value("LAUYoloPoseLabelerWidget::lastUsedDirectory", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).toString();
         if (QDir(directory).exists() == false){
             directory = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
         }
-        fileStrings = QFileDialog::getOpenFileNames(this, QString("Load images from disk (*.tif,*.jpg)"), directory, QString("*.tif;*.tiff;*.jpg"));
-        if (fileStrings.isEmpty() == false) {
-            settings.setValue("LAUYoloPoseLabelerWidget::lastUsedDirectory", QFileInfo(fileStrings.first()).absolutePath());
+        directory = QFileDialog::getExistingDirectory(this, QString("Load images from directory (*.tif,*.jpg)"), directory);
+        if (directory.isEmpty() == false) {
+            settings.setValue("LAUYoloPoseLabelerWidget::lastUsedDirectory", directory);
+            strings << directory;
         }
     }
 
-    if (fileStrings.count() > 0){
-        image = LAUImage(fileStrings.first());
-        this->setWindowTitle(QFileInfo(fileStrings.first()).fileName());
+    // FILES ARE USED AS GIVEN, DIRECTORIES ARE WALKED IN THE BACKGROUND SO THE FIRST IMAGE SHOWS UP RIGHT AWAY
+    for (int n = 0; n < strings.count(); n++){
+        if (QFileInfo(strings.at(n)).isDir()){
+            directoryStrings << strings.at(n);
+        } else {
+            fileStrings << strings.at(n);
+        }
+    }
+
+    // BUILD THE TABLE OF LABEL STATES AND PICK UP WHERE THE LAST SESSION LEFT OFF
+    datasetIndex = new LAUDatasetIndex(fileStrings, directoryStrings.isEmpty() ? QString() : LAUDatasetIndex::defaultFilename(directoryStrings), this);
+    resumeFilename = settings.value("LAUYoloPoseLabelerWidget::lastUsedFilename", QString()).toString();
+    currentIndex = qMax(0, datasetIndex->indexOf(resumeFilename));
+
+    // CREATE THE RING OF IMAGES DECODED IN THE BACKGROUND AROUND THE CURRENT IMAGE
+    prefetchAhead = settings.value("LAUYoloPoseLabelerWidget::prefetchAhead", LAUIMAGEPREFETCHAHEAD).toInt();
+    prefetchBehind = settings.value("LAUYoloPoseLabelerWidget::prefetchBehind", LAUIMAGEPREFETCHBEHIND).toInt();
+    prefetcher = new LAUImagePrefetchObject((qint64)settings.value("LAUYoloPoseLabelerWidget::prefetchMegabytes", LAUIMAGEPREFETCHMEGABYTES).toInt() * 1024 * 1024, this);
+    connect(prefetcher, SIGNAL(emitImageReady(QString)), this, SLOT(onImageReady(QString)));
+
+    // PREVIEWS ARE KEPT ON DISK BETWEEN SESSIONS SO WE DON'T REPEAT THE COLOR MANAGEMENT
+    LAUImagePreviewCache::setMaximumBytes((qint64)settings.value("LAUYoloPoseLabelerWidget::previewCacheMegabytes", LAUIMAGEPREVIEWCACHEMEGABYTES).toInt() * 1024 * 1024);
+
+    // CREATE THE BACKGROUND THREAD THAT SAVES LABELS SO NAVIGATION NEVER WAITS ON DISK
+    writer = new LAUImageWriterObject(this);
+    connect(writer, SIGNAL(emitSaveComplete(QString,bool)), this, SLOT(onSaveComplete(QString,bool)));
+
+    // REPLAY ANY EDITS THAT NEVER MADE IT INTO THEIR FILES BECAUSE THE LAST SESSION DIED
+    journal = new LAUAnnotationJournal(LAUAnnotationJournal::defaultFilename(), this);
+    QHash<QString, QByteArray> edits = journal->pendingEdits();
+    QHashIterator<QString, QByteArray> iterator(edits);
+    while (iterator.hasNext()){
+        iterator.next();
+        if (QFileInfo::exists(iterator.key()) == false){
+            journal->markFolded(iterator.key());
+            continue;
+        }
+        writer->enqueue(iterator.key(), LAUImage(), iterator.value());
+
+        int index = datasetIndex->indexOf(iterator.key());
+        if (index >= 0){
+            datasetIndex->update(index, iterator.value());
+        }
     }
+
     initialize();
+
+    if (directoryStrings.isEmpty() == false){
+        walker = new LAUDirectoryWalker(directoryStrings, LAUDirectoryWalker::imageFilters(), this);
+        connect(walker, SIGNAL(emitFilesFound(QStringList)), this, SLOT(onFilesFound(QStringList)));
+        connect(walker, SIGNAL(emitWalkComplete()), this, SLOT(onWalkComplete()));
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onFilesFound(QStringList strings)
+{
+    bool firstFlag = fileStrings.isEmpty();
+    fileStrings << strings;
+    datasetIndex->append(strings);
+
+    // EDITS REPLAYED FROM THE JOURNAL MAY BELONG TO FILES WE ARE ONLY NOW FINDING
+    QHash<QString, QByteArray> edits = journal->pendingEdits();
+    if (edits.isEmpty() == false){
+        for (int n = 0; n < strings.count(); n++){
+            if (edits.contains(strings.at(n))){
+                datasetIndex->update(datasetIndex->indexOf(strings.at(n)), edits.value(strings.at(n)));
+            }
+        }
+    }
+
+    if (browser){
+        browser->refresh();
+    }
+
+    // SHOW THE FIRST IMAGE WE FIND, THEN JUMP TO WHERE THE LAST SESSION LEFT OFF IF THE USER HASN'T MOVED YET
+    if (firstFlag || (navigatedFlag == false && palette->isDirty() == false && strings.contains(resumeFilename))){
+        currentIndex = qMax(0, datasetIndex->indexOf(resumeFilename));
+        showCurrentImage();
+    } else {
+        // THE WINDOW AROUND THE CURSOR MAY HAVE GROWN
+        updateWindowTitle();
+        prefetcher->setCursor(prefetchStrings());
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onWalkComplete()
+{
+    walker->deleteLater();
+    walker = nullptr;
+
+    // THE INDEX NOW HOLDS EVERYTHING THE WALKER FOUND, SO ANYTHING THE WATCHER SEES FROM HERE ON IS NEWS
+    directoryWatcher = new LAUDirectoryWatcher(datasetIndex, directoryStrings, LAUDirectoryWalker::imageFilters(), this);
+    connect(directoryWatcher, SIGNAL(emitFilesAdded(QStringList)), this, SLOT(onFilesFound(QStringList)));
+    connect(directoryWatcher, SIGNAL(emitFilesChanged(QStringList)), this, SLOT(onFilesChanged(QStringList)));
+    connect(directoryWatcher, SIGNAL(emitFilesRemoved(QStringList)), this, SLOT(onFilesRemoved(QStringList)));
+
+    if (fileStrings.isEmpty()){
+        QMessageBox::warning(this, QString("YOLO Pose Labeler"), QString("No images found yet, new images will show up as they are added."));
+    }
+    updateWindowTitle();
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onFilesChanged(QStringList strings)
+{
+    for (int n = 0; n < strings.count(); n++){
+        // OUR OWN SAVES SHOW UP HERE TOO, BUT THE INDEX AND PREFETCHER ALREADY KNOW ABOUT THOSE
+        QByteArray xml;
+        if (savedStrings.remove(strings.at(n)) || writer->pendingXmlData(strings.at(n), &xml)){
+            continue;
+        }
+
+        int index = datasetIndex->indexOf(strings.at(n));
+        if (index >= 0){
+            datasetIndex->rescan(index);
+            prefetcher->remove(strings.at(n));
+            if (browser){
+                browser->invalidate(index);
+            }
+        }
+    }
+    updateWindowTitle();
+    prefetcher->setCursor(prefetchStrings());
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onFilesRemoved(QStringList strings)
+{
+    // DELETED FILES KEEP THEIR PLACE IN THE LIST SO NO INDEX HANDED OUT EVER MOVES, NAVIGATION JUST SKIPS THEM
+    for (int n = 0; n < strings.count(); n++){
+        int index = datasetIndex->indexOf(strings.at(n));
+        if (index >= 0){
+            datasetIndex->setMissing(index);
+            prefetcher->remove(strings.at(n));
+            if (browser){
+                browser->invalidate(index);
+            }
+        }
+    }
+    updateWindowTitle();
+    prefetcher->setCursor(prefetchStrings());
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::updateWindowTitle()
+{
+    if (fileStrings.isEmpty()){
+        this->setWindowTitle(QString("Searching for images..."));
+        return;
+    }
+
+    int count = fileStrings.count() - datasetIndex->missing();
+    if (walker){
+        this->setWindowTitle(QString("%1 (%2 of %3 so far)").arg(QFileInfo(currentFilename()).fileName()).arg(currentIndex + 1).arg(count));
+    } else {
+        this->setWindowTitle(QString("%1 (%2 of %3)").arg(QFileInfo(currentFilename()).fileName()).arg(currentIndex + 1).arg(count));
+    }
 }
 
 /*************************************************************************************/
@@ -123,76 +291,738 @@ void LAUYoloPoseLabelerWidget::initialize()
     palette = new LAUYoloPoseLabelerPalette(labels, fiducials);
     connect(label, SIGNAL(emitMousePressEvent(int,int)), palette, SLOT(onSpinBoxValueChanged(int,int)));
     connect(label, SIGNAL(emitPaint(QPainter*,QSize)), palette, SLOT(onPaintEvent(QPainter*,QSize)));
+    connect(label, SIGNAL(emitOverlayRegion(QRegion*,QSize,QFontMetrics)), palette, SLOT(onOverlayRegion(QRegion*,QSize,QFontMetrics)));
     connect(palette, SIGNAL(emitPreviousButtonClicked(bool)), this, SLOT(onPreviousButtonClicked(bool)));
     connect(palette, SIGNAL(emitNextButtonClicked(bool)), this, SLOT(onNextButtonClicked(bool)));
+    connect(palette, SIGNAL(emitEdited()), this, SLOT(onPaletteEdited()));
     connect(label, SIGNAL(emitMouseRightClickEvent(QMouseEvent*)), this, SLOT(onContextMenuTriggered(QMouseEvent*)));
     box->layout()->addWidget(palette);
     box->setFixedWidth(380);
     this->layout()->addWidget(box);
 
-    palette->setXml(image.xmlData());
-    palette->setImageSize(image.width(), image.height());
-    label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
-}
+    showCurrentImage();
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+LAUYoloPoseLabelerWidget::~LAUYoloPoseLabelerWidget()
+{
+    // THE BROWSER'S MODEL AND THE WATCHER'S THREAD READ FROM THE INDEX, SO THEY HAVE TO GO FIRST
+    delete browser;
+    browser = nullptr;
+    delete directoryWatcher;
+    directoryWatcher = nullptr;
+
+    // MAKE SURE EVERY LABEL IS ON DISK BEFORE WE GO AWAY
+    saveCurrentImage();
+    writer->flush();
+
+    // DELIVER THE WRITER'S COMPLETION NOTICES NOW SO THE JOURNAL CAN LET GO OF WHAT WAS SAVED
+    QCoreApplication::sendPostedEvents(writer, QEvent::MetaCall);
+
+    // REMEMBER WHERE WE WERE SO THE NEXT SESSION CAN RESUME FROM HERE
+    if (fileStrings.isEmpty() == false){
+        QSettings settings;
+        settings.setValue("LAUYoloPoseLabelerWidget::lastUsedFilename", currentFilename());
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::saveCurrentImage()
+{
+    if (fileStrings.isEmpty() == false && palette->isDirty()){
+        QByteArray xml = palette->xml();
+
+        // DROP THE CACHED COPY SINCE ITS XML IS NOW STALE
+        prefetcher->remove(currentFilename());
+        datasetIndex->update(currentIndex, xml);
+
+        // HAND THE IMAGE TO THE WRITER THREAD INSTEAD OF WAITING ON THE ENCODER
+        writer->enqueue(currentFilename(), image, xml);
+        palette->setDirty(false);
+
+        // REDRAW THIS FILE'S BADGE IN THE THUMBNAIL GRID
+        if (browser){
+            browser->invalidate(currentIndex);
+        }
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onSaveComplete(QString filename, bool flag)
+{
+    // ANY COPY DECODED WHILE THE SAVE WAS IN FLIGHT HAS THE OLD XML, SO DECODE IT AGAIN
+    prefetcher->remove(filename);
+    if (directoryWatcher && flag){
+        savedStrings.insert(filename);
+    }
+    prefetcher->setCursor(prefetchStrings());
+
+    if (flag == false){
+        QMessageBox::warning(this, QString("YOLO Pose Labeler"), QString("Error saving labels to %1.").arg(filename));
+        return;
+    }
+
+    // THE JOURNAL CAN FORGET THIS FILE UNLESS IT HAS BEEN EDITED AGAIN SINCE THIS SAVE WAS QUEUED
+    QByteArray xml;
+    if (writer->pendingXmlData(filename, &xml) == false){
+        if (fileStrings.isEmpty() || filename != currentFilename() || palette->isDirty() == false){
+            journal->markFolded(filename);
+        }
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onPaletteEdited()
+{
+    if (fileStrings.isEmpty()){
+        return;
+    }
+
+    // A PERSON TOUCHED THESE LABELS SO THEY NO LONGER CARRY THE MODEL'S CONFIDENCE
+    palette->setConfidence(-1.0f);
+    predictionFlag = false;
+
+    // LOG THE WHOLE LABEL SET, IT'S ONLY A FEW HUNDRED BYTES AND MAKES REPLAY TRIVIAL
+    journal->append(currentFilename(), palette->xml());
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::showCurrentImage()
+{
+    if (fileStrings.isEmpty()){
+        updateWindowTitle();
+        return;
+    }
+
+    // SWAP IN THE PREFETCHED IMAGE IF ITS READY, OTHERWISE DECODE IT NOW
+    QPixmap pixmap;
+    if (prefetcher->image(currentFilename(), &image, &pixmap) == false){
+        image = LAUImage(currentFilename());
+        pixmap = QPixmap::fromImage(LAUImagePrefetchObject::preview(image));
+        prefetcher->insert(currentFilename(), image, pixmap);
+    }
+
+    // A SAVE STILL IN THE WRITER QUEUE HAS NEWER XML THAN WHAT IS ON DISK
+    QByteArray xml = image.xmlData();
+    writer->pendingXmlData(currentFilename(), &xml);
+
+    palette->setXml(xml);
+    palette->setImageSize(image.width(), image.height());
+    label->setImage(image, pixmap);
+    updateWindowTitle();
+
+    // START DECODING THE IMAGES AROUND THE NEW CURSOR POSITION
+    prefetcher->setCursor(prefetchStrings());
+
+    // AN UNLABELED IMAGE GETS THE MODEL'S GUESS, WHICH IS USUALLY WAITING FOR US ALREADY
+    prefillFlag = xml.isEmpty();
+    predictionFlag = false;
+    if (inference){
+        inference->setCursor(prefetchStrings());
+        LAUPoseInferenceObject::Prediction prediction;
+        if (inference->prediction(currentFilename(), &prediction)){
+            applyPrediction(prediction);
+        } else if (prefillFlag){
+            inference->enqueue(currentFilename(), image);
+        }
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::applyPrediction(LAUPoseInferenceObject::Prediction prediction)
+{
+    // NEVER OVERWRITE EXISTING LABELS OR ANYTHING THE USER HAS ALREADY TOUCHED
+    if (prefillFlag == false || palette->isDirty() || prediction.classIndex < 0){
+        return;
+    }
+    prefillFlag = false;
+
+    palette->setClass(prediction.classIndex);
+    for (int n = 0; n < palette->fiducials(); n++){
+#ifdef ZOOMINTOHEAD
+        if (n < 6 || n > 11 || n - 6 >= prediction.points.count()){
+            continue;
+        }
+        QVector3D point = prediction.points.at(n - 6);
+#else
+        if (n >= prediction.points.count()){
+            break;
+        }
+        QVector3D point = prediction.points.at(n);
+#endif
+        palette->setFiducial(n, qRound(point.x()), qRound(point.y()), (point.z() > 0.5));
+    }
+
+    // KEEP THE MODEL'S CONFIDENCE UNTIL A PERSON CORRECTS SOMETHING, BUT AN UNREVIEWED GUESS NEVER GOES TO DISK,
+    // ONLY ONCE THE USER EDITS IT OR ACCEPTS IT AS IS WITH THE RETURN KEY
+    palette->setConfidence(prediction.confidence);
+    palette->setDirty(false);
+    predictionFlag = true;
+    label->update();
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onAcceptPrediction()
+{
+    if (fileStrings.isEmpty() || predictionFlag == false){
+        return;
+    }
+    predictionFlag = false;
+
+    // THE GUESS IS NOW THE USER'S, SO IT IS LOGGED AND SAVED LIKE ANY OTHER EDIT
+    palette->setDirty(true);
+    journal->append(currentFilename(), palette->xml());
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onImageReady(QString filename)
+{
+    if (inference == nullptr){
+        return;
+    }
+
+    // ONLY IMAGES WITHOUT LABELS ARE WORTH RUNNING THROUGH THE MODEL
+    LAUImage image;
+    QPixmap pixmap;
+    QByteArray xml;
+    if (prefetcher->image(filename, &image, &pixmap) && image.xmlData().isEmpty() && writer->pendingXmlData(filename, &xml) == false){
+        inference->enqueue(filename, image);
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onPredictionReady(QString filename)
+{
+    LAUPoseInferenceObject::Prediction prediction;
+    if (fileStrings.isEmpty() == false && filename == currentFilename() && inference->prediction(filename, &prediction)){
+        applyPrediction(prediction);
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onEnableModelAssist()
+{
+    // SELECTING THE ACTION AGAIN TURNS THE MODEL BACK OFF
+    if (inference){
+        delete inference;
+        inference = nullptr;
+        return;
+    }
+
+    QSettings settings;
+    QString directory = settings.value("LAUDeepNetworkObject::lastUsedDirectory", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).toString();
+    QString filename = QFileDialog::getOpenFileName(this, QString("Load model from disk (*.onnx)"), directory, QString("*.onnx"));
+    if (filename.isEmpty()){
+        return;
+    }
+    settings.setValue("LAUDeepNetworkObject::lastUsedDirectory", QFileInfo(filename).absolutePath());
+
+    inference = new LAUPoseInferenceObject(filename, this);
+    if (inference->isValid() == false){
+        delete inference;
+        inference = nullptr;
+        QMessageBox::warning(this, QString("YOLO Pose Labeler"), QString("Unable to load model from %1.").arg(filename));
+        return;
+    }
+    connect(inference, SIGNAL(emitPredictionReady(QString)), this, SLOT(onPredictionReady(QString)));
+
+    // START ON WHATEVER IS ALREADY DECODED AROUND THE CURSOR, THE PREFETCHER FEEDS US THE REST
+    QStringList strings = prefetchStrings();
+    inference->setCursor(strings);
+    for (int n = 0; n < strings.count(); n++){
+        onImageReady(strings.at(n));
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+QStringList LAUYoloPoseLabelerWidget::prefetchStrings() const
+{
+    // CURRENT IMAGE FIRST, THEN ALTERNATE BETWEEN THE DIRECTION OF TRAVEL AND BEHIND IT
+    QStringList strings;
+    if (fileStrings.isEmpty()){
+        return (strings);
+    }
+    strings << currentFilename();
+
+    // FOLLOW THE SAME FILTERED PATH THE NEXT AND PREVIOUS BUTTONS WILL TAKE
+    int step = (forwardFlag) ? 1 : -1;
+    int aheadIndex = currentIndex;
+    int behindIndex = currentIndex;
+    for (int n = 1; n <= qMax(prefetchAhead, prefetchBehind); n++){
+        if (n <= prefetchAhead && aheadIndex >= 0){
+            aheadIndex = datasetIndex->next(aheadIndex, step, navigationFilter, navigationClass);
+            if (aheadIndex >= 0 && strings.contains(fileStrings.at(aheadIndex)) == false){
+                strings << fileStrings.at(aheadIndex);
+            }
+        }
+        if (n <= prefetchBehind && behindIndex >= 0){
+            behindIndex = datasetIndex->next(behindIndex, -step, navigationFilter, navigationClass);
+            if (behindIndex >= 0 && strings.contains(fileStrings.at(behindIndex)) == false){
+                strings << fileStrings.at(behindIndex);
+            }
+        }
+    }
+    return (strings);
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onSetPrefetchWindow()
+{
+    bool okay = false;
+    int ahead = QInputDialog::getInt(this, QString("Prefetch Window"), QString("How many images to decode ahead of the current image?"), prefetchAhead, 0, 32, 1, &okay);
+    if (okay == false){
+        return;
+    }
+
+    int behind = QInputDialog::getInt(this, QString("Prefetch Window"), QString("How many images to decode behind the current image?"), prefetchBehind, 0, 32, 1, &okay);
+    if (okay == false){
+        return;
+    }
+
+    int megabytes = QInputDialog::getInt(this, QString("Prefetch Window"), QString("How many megabytes can the prefetched images use?"), (int)(prefetcher->maximumBytes() / 1024 / 1024), 64, 65536, 64, &okay);
+    if (okay == false){
+        return;
+    }
+
+    QSettings settings;
+    settings.setValue("LAUYoloPoseLabelerWidget::prefetchAhead", ahead);
+    settings.setValue("LAUYoloPoseLabelerWidget::prefetchBehind", behind);
+    settings.setValue("LAUYoloPoseLabelerWidget::prefetchMegabytes", megabytes);
+
+    prefetchAhead = ahead;
+    prefetchBehind = behind;
+    prefetcher->setMaximumBytes((qint64)megabytes * 1024 * 1024);
+    prefetcher->setCursor(prefetchStrings());
+    if (inference){
+        inference->setCursor(prefetchStrings());
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onSetPreviewCacheSize()
+{
+    bool okay = false;
+    int megabytes = QInputDialog::getInt(this, QString("Preview Cache"), QString("How many megabytes of previews can be kept on disk?"), (int)(LAUImagePreviewCache::maximumBytes() / 1024 / 1024), 16, 65536, 64, &okay);
+    if (okay == false){
+        return;
+    }
+
+    QSettings settings;
+    settings.setValue("LAUYoloPoseLabelerWidget::previewCacheMegabytes", megabytes);
+
+    LAUImagePreviewCache::setMaximumBytes((qint64)megabytes * 1024 * 1024);
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onPreviousButtonClicked(bool state)
+{
+    Q_UNUSED(state);
+
+    stepCurrentImage(-1);
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onNextButtonClicked(bool state)
+{
+    Q_UNUSED(state);
+
+    stepCurrentImage(1);
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::stepCurrentImage(int step)
+{
+    saveCurrentImage();
+
+    // MOVE TO THE NEXT IMAGE THAT PASSES THE NAVIGATION FILTER
+    int index = datasetIndex->next(currentIndex, step, navigationFilter, navigationClass);
+    if (index < 0 || index == currentIndex){
+        QApplication::beep();
+        return;
+    }
+    navigatedFlag = true;
+    currentIndex = index;
+    forwardFlag = (step > 0);
+    showCurrentImage();
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onGoToImage()
+{
+    if (fileStrings.isEmpty()){
+        return;
+    }
+
+    bool okay = false;
+    int index = QInputDialog::getInt(this, QString("Go to Image"), QString("Which image do you want to see?"), currentIndex + 1, 1, fileStrings.count(), 1, &okay);
+    if (okay == false){
+        return;
+    }
+
+    saveCurrentImage();
+    navigatedFlag = true;
+    currentIndex = index - 1;
+    showCurrentImage();
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onBrowseThumbnails()
+{
+    if (fileStrings.isEmpty()){
+        return;
+    }
+
+    // THE GRID IS A TOP LEVEL WINDOW THAT STICKS AROUND SO ITS THUMBNAILS STAY CACHED BETWEEN VISITS
+    if (browser == nullptr){
+        browser = new LAUThumbnailBrowser(datasetIndex, palette->labels());
+        browser->setParent(this, Qt::Window);
+        connect(browser, SIGNAL(emitImageSelected(int)), this, SLOT(onBrowserImageSelected(int)));
+    }
+    browser->show();
+    browser->raise();
+    browser->activateWindow();
+    browser->setCurrentRow(currentIndex);
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onBrowserImageSelected(int row)
+{
+    if (row < 0 || row >= fileStrings.count() || row == currentIndex){
+        return;
+    }
+
+    saveCurrentImage();
+    navigatedFlag = true;
+    forwardFlag = (row > currentIndex);
+    currentIndex = row;
+    showCurrentImage();
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onSetNavigationFilter()
+{
+    QStringList items;
+    items << QString("All Images");
+    items << QString("Unlabeled Images");
+    QStringList labels = palette->labels();
+    for (int n = 0; n < labels.count(); n++){
+        items << QString("%1 Images").arg(labels.at(n));
+    }
+    items << QString("Low Confidence Images");
+    items << QString("Suspect Images");
+
+    int current = 0;
+    if (navigationFilter == LAUDatasetIndex::FilterUnlabeled){
+        current = 1;
+    } else if (navigationFilter == LAUDatasetIndex::FilterClass){
+        current = 2 + navigationClass;
+    } else if (navigationFilter == LAUDatasetIndex::FilterLowConfidence){
+        current = items.count() - 2;
+    } else if (navigationFilter == LAUDatasetIndex::FilterSuspect){
+        current = items.count() - 1;
+    }
+
+    bool okay = false;
+    QString item = QInputDialog::getItem(this, QString("Navigation Filter"), QString("Which images should Next and Previous visit?"), items, current, false, &okay);
+    if (okay == false){
+        return;
+    }
+
+    int index = items.indexOf(item);
+    if (index == 0){
+        navigationFilter = LAUDatasetIndex::FilterAll;
+    } else if (index == 1){
+        navigationFilter = LAUDatasetIndex::FilterUnlabeled;
+    } else if (index == items.count() - 2){
+        navigationFilter = LAUDatasetIndex::FilterLowConfidence;
+    } else if (index == items.count() - 1){
+        navigationFilter = LAUDatasetIndex::FilterSuspect;
+    } else {
+        navigationFilter = LAUDatasetIndex::FilterClass;
+        navigationClass = index - 2;
+    }
+
+    // THE IMAGES AROUND THE CURSOR DEPEND ON THE FILTER
+    prefetcher->setCursor(prefetchStrings());
+    if (inference){
+        inference->setCursor(prefetchStrings());
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onSkipNearDuplicates(bool state)
+{
+    if (state && findNearDuplicates() == false){
+        return;
+    }
+    skipDuplicatesFlag = state;
+    datasetIndex->setSkipDuplicates(state);
+
+    // THE IMAGES AROUND THE CURSOR DEPEND ON WHICH IMAGES WE SKIP
+    prefetcher->setCursor(prefetchStrings());
+    if (inference){
+        inference->setCursor(prefetchStrings());
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+bool LAUYoloPoseLabelerWidget::findNearDuplicates()
+{
+    int count = datasetIndex->count();
+    if (count == 0){
+        return (false);
+    }
+
+    // HASH EVERY IMAGE THE INDEX DOESN'T ALREADY HAVE A HASH FOR, SPREAD ACROSS ALL THE CORES
+    QAtomicInt cancelFlag(0);
+    QAtomicInt doneCount(0);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(QThread::idealThreadCount());
+    for (int n = 0; n < count; n += LAUPERCEPTUALHASHBLOCKSIZE){
+        threadPool.start(new LAUPerceptualHashTask(datasetIndex, n, qMin(n + LAUPERCEPTUALHASHBLOCKSIZE, count), &cancelFlag, &doneCount));
+    }
+
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT, THE HASHES FINISHED SO FAR ARE KEPT EITHER WAY
+    QProgressDialog progressDialog(QString("Hashing images..."), QString("Abort"), 0, count, this, Qt::Sheet);
+    progressDialog.setModal(Qt::WindowModal);
+    progressDialog.show();
+
+    while (threadPool.waitForDone(100) == false){
+        if (progressDialog.wasCanceled()){
+            cancelFlag.storeRelease(1);
+            threadPool.clear();
+        }
+        progressDialog.setValue(doneCount.loadAcquire());
+        qApp->processEvents();
+    }
+    progressDialog.setValue(count);
+
+    if (cancelFlag.loadAcquire()){
+        return (false);
+    }
 
-/*************************************************************************************/
-/*************************************************************************************/
-/*************************************************************************************/
-LAUYoloPoseLabelerWidget::~LAUYoloPoseLabelerWidget()
-{
-    if (palette->isDirty()){
-        image.setXmlData(palette->xml());
-        image.save(fileStrings.first());
-        palette->setDirty(false);
+    // CLUSTER IN FILE ORDER SO THE FIRST FRAME OF EVERY RUN IS THE ONE WE KEEP
+    LAUDuplicateIndex duplicateIndex;
+    QVector<int> representatives(count);
+    int duplicates = 0;
+    for (int n = 0; n < count; n++){
+        LAUDatasetIndex::Entry entry = datasetIndex->peek(n);
+        representatives[n] = (entry.hashed && entry.missing == false) ? duplicateIndex.insert(n, entry.hash) : n;
+        if (representatives.at(n) != n){
+            duplicates++;
+        }
     }
+    datasetIndex->setDuplicates(representatives);
+
+    QMessageBox::information(this, QString("Skip Near Duplicates"), QString("Found %1 near duplicates among %2 images, which leaves %3 distinct scenes.").arg(duplicates).arg(count).arg(duplicateIndex.clusters()));
+    return (true);
 }
 
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
-void LAUYoloPoseLabelerWidget::onPreviousButtonClicked(bool state)
+void LAUYoloPoseLabelerWidget::onDatasetReport()
 {
-    Q_UNUSED(state);
+    int count = datasetIndex->count();
+    if (count == 0){
+        return;
+    }
 
-    if (palette->isDirty()){
-        image.setXmlData(palette->xml());
-        image.save(fileStrings.first());
-        palette->setDirty(false);
+    QSettings settings;
+    QString filename = settings.value("LAUYoloPoseLabelerWidget::reportFilename", QString("%1/report.html").arg(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation))).toString();
+    filename = QFileDialog::getSaveFileName(this, QString("Save dataset report..."), filename, QString("*.html"));
+    if (filename.isEmpty()){
+        return;
+    }
+    if (filename.endsWith(".html") == false){
+        filename.append(".html");
+    }
+    settings.setValue("LAUYoloPoseLabelerWidget::reportFilename", filename);
+
+    // MAKE SURE THE LABELS ON SCREEN ARE COUNTED
+    saveCurrentImage();
+
+    // ONE ACCUMULATOR PER THREAD, EACH WORKING THROUGH ITS OWN STRETCH OF THE INDEX, READING XML ONLY WHERE THE INDEX HASN'T YET
+    LAUPoseAnnotation annotation = palette->annotation();
+    int threads = qMax(1, QThread::idealThreadCount());
+    QVector<LAUDatasetReport> reports(threads, LAUDatasetReport(annotation.fiducialNames()));
+    QAtomicInt cancelFlag(0);
+    QAtomicInt doneCount(0);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threads);
+    for (int n = 0; n < threads; n++){
+        threadPool.start(new LAUDatasetReportTask(datasetIndex, n * count / threads, (n + 1) * count / threads, &reports[n], &cancelFlag, &doneCount));
+    }
+
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT
+    QProgressDialog progressDialog(QString("Gathering statistics..."), QString("Abort"), 0, count, this, Qt::Sheet);
+    progressDialog.setModal(Qt::WindowModal);
+    progressDialog.show();
+
+    while (threadPool.waitForDone(100) == false){
+        if (progressDialog.wasCanceled()){
+            cancelFlag.storeRelease(1);
+        }
+        progressDialog.setValue(doneCount.loadAcquire());
+        qApp->processEvents();
     }
+    progressDialog.setValue(count);
 
-    if (fileStrings.count() > 1){
-        QString string = fileStrings.takeLast();
-        fileStrings.prepend(string);
-        image = LAUImage(fileStrings.first());
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
-        this->setWindowTitle(QFileInfo(fileStrings.first()).fileName());
+    if (cancelFlag.loadAcquire()){
+        return;
+    }
+
+    LAUDatasetReport report(annotation.fiducialNames());
+    for (int n = 0; n < threads; n++){
+        report.merge(reports.at(n));
+    }
+
+    if (report.save(filename, annotation.labels(), annotation.fiducialNames()) == false){
+        QMessageBox::warning(this, QString("Dataset Report"), QString("Unable to write the report to %1.").arg(filename));
+        return;
     }
+    QDesktopServices::openUrl(QUrl::fromLocalFile(filename));
 }
 
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
-void LAUYoloPoseLabelerWidget::onNextButtonClicked(bool state)
+void LAUYoloPoseLabelerWidget::onCheckAnnotations()
 {
-    Q_UNUSED(state);
+    int count = datasetIndex->count();
+    if (count == 0){
+        return;
+    }
 
-    if (palette->isDirty()){
-        image.setXmlData(palette->xml());
-        image.save(fileStrings.first());
-        palette->setDirty(false);
+    // MAKE SURE THE LABELS ON SCREEN ARE CHECKED TOO
+    saveCurrentImage();
+
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT, IT COVERS BOTH PASSES OVER THE INDEX
+    QProgressDialog progressDialog(QString("Checking annotations..."), QString("Abort"), 0, 2 * count, this, Qt::Sheet);
+    progressDialog.setModal(Qt::WindowModal);
+    progressDialog.show();
+
+    // FIRST PASS GATHERS WHAT A TYPICAL ANNOTATION LOOKS LIKE, ONE ACCUMULATOR PER THREAD
+    int threads = qMax(1, QThread::idealThreadCount());
+    LAUPoseAnnotation annotation = palette->annotation();
+    QVector<LAUAnnotationStatistics> accumulators(threads, LAUAnnotationStatistics(annotation.fiducialNames()));
+    QAtomicInt cancelFlag(0);
+    QAtomicInt doneCount(0);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threads);
+    for (int n = 0; n < threads; n++){
+        threadPool.start(new LAUAnnotationStatisticsTask(datasetIndex, n * count / threads, (n + 1) * count / threads, &accumulators[n], nullptr, &cancelFlag, &doneCount));
+    }
+    while (threadPool.waitForDone(100) == false){
+        if (progressDialog.wasCanceled()){
+            cancelFlag.storeRelease(1);
+        }
+        progressDialog.setValue(doneCount.loadAcquire());
+        qApp->processEvents();
+    }
+    if (cancelFlag.loadAcquire()){
+        return;
+    }
+
+    LAUAnnotationStatistics statistics(annotation.fiducialNames());
+    for (int n = 0; n < threads; n++){
+        statistics.merge(accumulators.at(n));
+    }
+    statistics.finalize();
+
+    // SECOND PASS SCORES EVERY ANNOTATION AGAINST THAT, EACH TASK WRITING ITS OWN STRETCH OF THE SCORES
+    QVector<float> scores(count, -FLT_MAX);
+    for (int n = 0; n < threads; n++){
+        threadPool.start(new LAUAnnotationStatisticsTask(datasetIndex, n * count / threads, (n + 1) * count / threads, &statistics, scores.data(), &cancelFlag, &doneCount));
+    }
+    while (threadPool.waitForDone(100) == false){
+        if (progressDialog.wasCanceled()){
+            cancelFlag.storeRelease(1);
+        }
+        progressDialog.setValue(doneCount.loadAcquire());
+        qApp->processEvents();
+    }
+    progressDialog.setValue(2 * count);
+    if (cancelFlag.loadAcquire()){
+        return;
+    }
+
+    // RANK THE LABELED IMAGES FROM MOST TO LEAST SUSPICIOUS
+    QList<QPair<float, int> > ranking;
+    for (int n = 0; n < count; n++){
+        if (scores.at(n) > -FLT_MAX){
+            ranking << QPair<float, int>(-scores.at(n), n);
+        }
+    }
+    if (ranking.isEmpty()){
+        QMessageBox::information(this, QString("Check Annotations"), QString("There are no labeled images to check."));
+        return;
+    }
+    std::sort(ranking.begin(), ranking.end());
+
+    QSettings settings;
+    bool okay = false;
+    int suspects = QInputDialog::getInt(this, QString("Check Annotations"), QString("How many of the %1 labeled images do you want to review, most suspicious first?").arg(ranking.count()), qMin(settings.value("LAUYoloPoseLabelerWidget::suspectCount", LAUANNOTATIONSTATISTICSSUSPECTS).toInt(), ranking.count()), 1, ranking.count(), 1, &okay);
+    if (okay == false){
+        return;
     }
+    settings.setValue("LAUYoloPoseLabelerWidget::suspectCount", suspects);
 
-    if (fileStrings.count() > 1){
-        QString string = fileStrings.takeFirst();
-        fileStrings.append(string);
-        image = LAUImage(fileStrings.first());
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
-        this->setWindowTitle(QFileInfo(fileStrings.first()).fileName());
+    QList<int> suspectList;
+    for (int n = 0; n < suspects; n++){
+        suspectList << ranking.at(n).second;
     }
+    datasetIndex->setSuspects(suspectList);
+
+    // SEND THE REVIEWER STRAIGHT TO THE WORST ONE, WITH NEXT AND PREVIOUS LIMITED TO THE REST
+    navigationFilter = LAUDatasetIndex::FilterSuspect;
+    navigatedFlag = true;
+    currentIndex = ranking.first().second;
+    showCurrentImage();
 }
 
 /*************************************************************************************/
@@ -213,29 +1043,6 @@ void LAUYoloPoseLabelerWidget::onExportLabelsForYoloPoseTraining()
         return;
     }
 
-    // FIND ALL IMAGES INSIDE NESTED FOLDERS OF THE INPUT DIRECTORY
-    QStringList inputImageStrings;
-    QStringList directoryList;
-    QDir currentDirectory;
-
-    directoryList.append(inputDirectoryString);
-    while (directoryList.count() > 0) {
-        currentDirectory.setPath(directoryList.takeFirst());
-        QStringList list = currentDirectory.entryList();
-        while (list.count() > 0) {
-            QString item = list.takeFirst();
-            if (!item.startsWith(".")) {
-                QDir dir(currentDirectory.absolutePath().append(QString("/").append(item)));
-                if (dir.exists()) {
-                    directoryList.append(dir.absolutePath());
-                } else if (item.endsWith(".tif")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                } else if (item.endsWith(".tiff")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                }
-            }
-        }
-    }
 
     directory = settings.value("LAUYoloPoseLabelerWidget::outputDirectoryString", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).toString();
     if (QDir(directory).exists() == false){
@@ -249,162 +1056,45 @@ void LAUYoloPoseLabelerWidget::onExportLabelsForYoloPoseTraining()
         return;
     }
 
-    QDir imageDir(QString("%1/%2").arg(outputDirectoryString).arg("images"));
-    if (imageDir.exists() == false){
-        imageDir.mkdir(imageDir.absolutePath());
-    }
-
-    QDir imageTrainDir(QString("%1/%2").arg(imageDir.absolutePath()).arg("train"));
-    if (imageTrainDir.exists() == false){
-        imageTrainDir.mkdir(imageTrainDir.absolutePath());
-    }
-
-    QDir imageValidDir(QString("%1/%2").arg(imageDir.absolutePath()).arg("val"));
-    if (imageValidDir.exists() == false){
-        imageValidDir.mkdir(imageValidDir.absolutePath());
-    }
-
-    QDir labelDir(QString("%1/%2").arg(outputDirectoryString).arg("labels"));
-    if (labelDir.exists() == false){
-        labelDir.mkdir(labelDir.absolutePath());
-    }
-
-    QDir labelTrainDir(QString("%1/%2").arg(labelDir.absolutePath()).arg("train"));
-    if (labelTrainDir.exists() == false){
-        labelTrainDir.mkdir(labelTrainDir.absolutePath());
-    }
-
-    QDir labelValidDir(QString("%1/%2").arg(labelDir.absolutePath()).arg("val"));
-    if (labelValidDir.exists() == false){
-        labelValidDir.mkdir(labelValidDir.absolutePath());
-    }
-
-    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY
-    if (palette->isDirty()){
-        image.setXmlData(palette->xml());
-        image.save(fileStrings.first());
-        palette->setDirty(false);
-    }
+    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY AND WAIT FOR IT TO LAND ON DISK
+    saveCurrentImage();
+    writer->flush();
 
     // ASK USER HOW MANY TRAINING IMAGES FOR EACH VALIDATION IMAGE
     int numImages = settings.value("LAUYoloPoseLabelerWidget::numImages", 1).toInt();
     numImages = QInputDialog::getInt(this, QString("Export Labels for YOLO Pose Training"), QString("How many training images for validation image?"), numImages, 1, 10, 1) + 1;
     settings.setValue("LAUYoloPoseLabelerWidget::numImages", numImages);
 
-    // CREATE A PROGRESS DIALOG SO USER CAN ABORT
-    QProgressDialog progressDialog(QString("Processing images..."), QString("Abort"), 0, inputImageStrings.count(), this, Qt::Sheet);
+    // THE EXPORTER WALKS, DECODES, CROPS AND ENCODES ON ITS OWN THREADS, NUMBERING FILES IN WALK ORDER, WE JUST WATCH
+    LAUPoseExporter exporter(inputDirectoryString, outputDirectoryString, palette->annotation(), numImages, skipDuplicatesFlag);
+
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT, ITS RANGE GROWS AS THE WALKER FINDS MORE IMAGES
+    QProgressDialog progressDialog(QString("Processing images..."), QString("Abort"), 0, 0, this, Qt::Sheet);
     progressDialog.setModal(Qt::WindowModal);
     progressDialog.show();
 
-    int validImageCounter = 0;
-    for (int n = 0; n < inputImageStrings.count(); n++){
-        if (progressDialog.wasCanceled()) {
-            break;
+    bool canceled = false;
+    while (exporter.wait(100) == false){
+        if (progressDialog.wasCanceled()){
+            exporter.cancel();
+            canceled = true;
         }
-        progressDialog.setValue(n);
+        progressDialog.setMaximum(exporter.count());
+        progressDialog.setValue(exporter.progress());
         qApp->processEvents();
-
-        QString string = inputImageStrings.at(n);
-        LAUImage image(string);
-        if (image.xmlData().isEmpty() == false){
-            validImageCounter++;
-            palette->setXml(image.xmlData());
-            palette->setFilename(string);
-            palette->setImageSize(image.width(), image.height());
-            label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
-            this->setWindowTitle(image.filename());
-            qApp->processEvents();
-
-#ifdef ZOOMINTOHEAD
-            int left = (image.width() - 640)/2;
-            int top = (image.height() - 640)/2;
-            QRect rect(left, top, 640, 640);
-
-            // GET STRING THAT WE CAN WRITE TO LABELS FILE
-            QString labelString = palette->labelString(&rect, true);
-
-            // CROP AND RESCALE IMAGE FOR TRAINING
-            image = image.crop(rect.left(), rect.top(), rect.width(), rect.height());
-            image.setXmlData(palette->xml(rect, 1.0, true));
-#else
-            int left = (image.width() - 1000)/2;
-            int top = (image.height() - 1000)/2;
-            QRect rect(left, top, 1000, 1000);
-
-            // GET STRING THAT WE CAN WRITE TO LABELS FILE
-            QString labelString = palette->labelString(&rect, false);
-
-            // CROP AND RESCALE IMAGE FOR TRAINING
-            image = image.crop(rect.left(), rect.top(), rect.width(), rect.height()).rescale(640,640);
-            image.setXmlData(palette->xml(rect, 0.640));
-#endif
-            QString newFileString = QString("%1").arg(validImageCounter);
-            while (newFileString.length() < 9){
-                newFileString.prepend(QString("0"));
-            }
-
-            if (validImageCounter % numImages){
-                image.save(QString("%1/%2.tif").arg(imageTrainDir.absolutePath()).arg(newFileString));
-                QFile file(QString("%1/%2.txt").arg(labelTrainDir.absolutePath()).arg(newFileString));
-                if (file.open(QIODevice::WriteOnly)){
-                    file.write(labelString.toLatin1());
-                    file.close();
-                }
-            } else {
-                image.save(QString("%1/%2.tif").arg(imageValidDir.absolutePath()).arg(newFileString));
-                QFile file(QString("%1/%2.txt").arg(labelValidDir.absolutePath()).arg(newFileString));
-                if (file.open(QIODevice::WriteOnly)){
-                    file.write(labelString.toLatin1());
-                    file.close();
-                }
-            }
-        }
     }
-    progressDialog.setValue(inputImageStrings.count());
-
-    QFile yamlFile(QString("%1/%2.yaml").arg(outputDirectoryString).arg(outputDirectoryString.split("/").last()));
-    if (yamlFile.open(QIODevice::WriteOnly)){
-        QTextStream stream(&yamlFile);
-        stream << "# Ultralytics YOLO 🚀, AGPL-3.0 license\n";
-        stream << "# COCO8-pose dataset (first 8 images from COCO train2017) by Ultralytics\n";
-        stream << "\n";
-        stream << "# Example usage: yolo train data=coco8-pose.yaml\n";
-        stream << "# parent\n";
-        stream << "# ├── ultralytics\n";
-        stream << "# └── datasets\n";
-        stream << "#     └── cowPose  ← downloads here (1 MB)\n";
-        stream << "\n";
-        stream << "# Train/val/test sets as 1) dir: path/to/imgs, 2) file: path/to/imgs.txt, or 3) list: [path/to/imgs1, path/to/imgs2, ..]\n";
-        stream << "path:  " << outputDirectoryString << " # dataset root dir\n";
-        stream << "train: images/train # train images (relative to 'path') 4 images\n";
-        stream << "val:   images/val # val images (relative to 'path') 4 images\n";
-        stream << "\n";
-        stream << "# Keypoints\n";
-#ifdef ZOOMINTOHEAD
-        stream << "kpt_shape: [" << 6 << ", 3]  # number of keypoints, number of dims (3 for x,y,visible)\n";
-#else
-        stream << "kpt_shape: [" << palette->fiducials() << ", 3]  # number of keypoints, number of dims (3 for x,y,visible)\n";
-#endif
-        stream << "\n";
-        stream << "# Classes\n";
-        stream << "names:\n";
+    progressDialog.setValue(progressDialog.maximum());
 
-        QStringList labels = palette->labels();
-        for (int n = 0; n < labels.count(); n++){
-            stream << "  " << n << ": " << labels.at(n) << "\n";
+    if (canceled == false){
+        if (exporter.isOkay() == false){
+            QMessageBox::warning(this, QString("Export Labels for YOLO Pose Training"), QString("Unable to write the training data to %1.").arg(outputDirectoryString));
+        } else if (exporter.failed() > 0){
+            QMessageBox::warning(this, QString("Export Labels for YOLO Pose Training"), QString("Exported %1 images but failed on %2.").arg(exporter.exported()).arg(exporter.failed()));
         }
-
-        yamlFile.close();
     }
 
     // RESET THE DISPLAY TO SHOW THE IMAGE THAT WAS THERE AT THE START OF THIS METHOD
-    if (fileStrings.count() > 0){
-        image = LAUImage(fileStrings.first());
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
-        this->setWindowTitle(QFileInfo(fileStrings.first()).fileName());
-    }
+    showCurrentImage();
 }
 
 /*************************************************************************************/
@@ -421,29 +1111,6 @@ void LAUYoloPoseLabelerWidget::onExportLabelsForYoloClassifierTraining()
         return;
     }
 
-    // FIND ALL IMAGES INSIDE NESTED FOLDERS OF THE INPUT DIRECTORY
-    QStringList inputImageStrings;
-    QStringList directoryList;
-    QDir currentDirectory;
-
-    directoryList.append(inputDirectoryString);
-    while (directoryList.count() > 0) {
-        currentDirectory.setPath(directoryList.takeFirst());
-        QStringList list = currentDirectory.entryList();
-        while (list.count() > 0) {
-            QString item = list.takeFirst();
-            if (!item.startsWith(".")) {
-                QDir dir(currentDirectory.absolutePath().append(QString("/").append(item)));
-                if (dir.exists()) {
-                    directoryList.append(dir.absolutePath());
-                } else if (item.endsWith(".tif")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                } else if (item.endsWith(".tiff")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                }
-            }
-        }
-    }
 
     directory = settings.value("LAUYoloPoseLabelerWidget::outputDirectoryString", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).toString();
     QString outputDirectoryString = QFileDialog::getExistingDirectory(this, QString("Set directory for outputing training data..."), directory);
@@ -483,33 +1150,62 @@ void LAUYoloPoseLabelerWidget::onExportLabelsForYoloClassifierTraining()
         }
     }
 
-    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY
-    if (palette->isDirty()){
-        image.setXmlData(palette->xml());
-        image.save(fileStrings.first());
-        palette->setDirty(false);
-    }
+    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY AND WAIT FOR IT TO LAND ON DISK
+    saveCurrentImage();
+    writer->flush();
 
-    // CREATE A PROGRESS DIALOG SO USER CAN ABORT
-    QProgressDialog progressDialog(QString("Processing images..."), QString("Abort"), 0, inputImageStrings.count(), this, Qt::Sheet);
+    // FIND IMAGES IN THE BACKGROUND AND START ON THEM AS THEY TURN UP, THE INDEX TELLS US WHICH ARE LABELED SO WE ONLY DECODE THOSE
+    LAUDatasetIndex labelIndex(QStringList(), LAUDatasetIndex::defaultFilename(QStringList() << inputDirectoryString));
+    LAUDirectoryWalker walker(QStringList() << inputDirectoryString, QStringList() << "*.tif" << "*.tiff", &labelIndex);
+
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT, ITS RANGE GROWS AS THE WALKER FINDS MORE IMAGES
+    QProgressDialog progressDialog(QString("Processing images..."), QString("Abort"), 0, 0, this, Qt::Sheet);
     progressDialog.setModal(Qt::WindowModal);
     progressDialog.show();
 
     int validImageCounter = 0;
-    for (int n = 0; n < inputImageStrings.count(); n++){
+    // WORK ON A COPY OF THE ANNOTATION SO NOTHING HERE DEPENDS ON THE PALETTE'S WIDGETS
+    LAUPoseAnnotation annotation = palette->annotation();
+    LAUDuplicateIndex duplicateIndex;
+    QString string;
+    for (int n = 0; walker.next(&string); n++){
         if (progressDialog.wasCanceled()) {
             break;
         }
+        progressDialog.setMaximum(walker.count());
         progressDialog.setValue(n);
         qApp->processEvents();
 
-        QString string = inputImageStrings.at(n);
-        LAUImage image(string);
+        if (labelIndex.entry(n).labeled == false){
+            continue;
+        }
+
+        // WHEN THE USER IS SKIPPING NEAR DUPLICATES, ONLY THE FIRST LABELED FRAME OF EACH RUN GOES INTO THE EXPORT
+        if (skipDuplicatesFlag){
+            LAUDatasetIndex::Entry entry = labelIndex.entry(n);
+            quint64 hash = entry.hash;
+            bool hashed = entry.hashed;
+            if (hashed == false && LAUPerceptualHash::hash(string, &hash)){
+                labelIndex.setHash(n, hash);
+                hashed = true;
+            }
+            if (hashed && duplicateIndex.insert(n, hash) != n){
+                continue;
+            }
+        }
+
+        // READ THE TAGS FIRST, THE PIXELS ARE ONLY DECODED ONCE WE KNOW WE NEED THEM
+        LAUImage image(string, LAUImage::LoadMetadata);
         if (image.xmlData().isEmpty() == false){
+            // DECODE HERE, BEFORE ANY COPIES ARE MADE, SO THE COPIES SHARE ONE SET OF PIXELS, AND SKIP FILES THAT WON'T DECODE
+            if (image.loadPixels() == false){
+                continue;
+            }
             validImageCounter++;
-            palette->setXml(image.xmlData());
-            palette->setImageSize(image.width(), image.height());
-            label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
+            annotation.setXml(image.xmlData());
+            annotation.setImageSize(image.width(), image.height());
+            palette->setAnnotation(annotation);
+            label->setPixmap(QPixmap::fromImage(LAUImagePrefetchObject::preview(image)));
             this->setWindowTitle(image.filename());
             qApp->processEvents();
 
@@ -519,25 +1215,25 @@ void LAUYoloPoseLabelerWidget::onExportLabelsForYoloClassifierTraining()
             QRect rect(left, top, 640, 640);
 
             // GET STRING THAT WE CAN WRITE TO LABELS FILE
-            QString labelString = palette->labelString(&rect, true);
+            QString labelString = annotation.labelString(&rect, true);
 
             // CROP AND RESCALE IMAGE FOR TRAINING
             image = image.crop(rect.left(), rect.top(), rect.width(), rect.height());
-            image.setXmlData(palette->xml(rect, 1.0, true));
+            image.setXmlData(annotation.xml(rect, 1.0, true));
 #else
             int left = (image.width() - 1000)/2;
             int top = (image.height() - 1000)/2;
             QRect rect(left, top, 1000, 1000);
 
             // GET STRING THAT WE CAN WRITE TO LABELS FILE
-            QString labelString = palette->labelString(&rect, false);
+            QString labelString = annotation.labelString(&rect, false);
 
             // CROP AND RESCALE IMAGE FOR TRAINING
             image = image.crop(rect.left(), rect.top(), rect.width(), rect.height()).rescale(640,640);
-            image.setXmlData(palette->xml(rect, 0.640));
+            image.setXmlData(annotation.xml(rect, 0.640));
 #endif
             // GENERATE NEW LABEL STRING
-            int classIndex = palette->getClass();
+            int classIndex = annotation.classIndex();
 
             QString newFileString = QString("%1").arg(validImageCounter);
             while (newFileString.length() < 9){
@@ -551,7 +1247,7 @@ void LAUYoloPoseLabelerWidget::onExportLabelsForYoloClassifierTraining()
             }
         }
     }
-    progressDialog.setValue(inputImageStrings.count());
+    progressDialog.setValue(progressDialog.maximum());
 
     QFile yamlFile(QString("%1/%2.yaml").arg(outputDirectoryString).arg(outputDirectoryString.split("/").last()));
     if (yamlFile.open(QIODevice::WriteOnly)){
@@ -589,14 +1285,173 @@ void LAUYoloPoseLabelerWidget::onExportLabelsForYoloClassifierTraining()
         yamlFile.close();
     }
 
-    // RESET THE DISPLAY TO SHOW THE IMAGE THAT WAS THERE AT THE START OF THIS METHOD
-    if (fileStrings.count() > 0){
-        image = LAUImage(fileStrings.first());
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
-        this->setWindowTitle(QFileInfo(fileStrings.first()).fileName());
+    // RESET THE DISPLAY TO SHOW THE IMAGE THAT WAS THERE AT THE START OF THIS METHOD
+    showCurrentImage();
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onExportLabelsAsCocoKeypoints()
+{
+    if (datasetIndex->count() == 0){
+        return;
+    }
+
+    QSettings settings;
+    QString filename = settings.value("LAUYoloPoseLabelerWidget::cocoFilename", QString("%1/person_keypoints.json").arg(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation))).toString();
+    filename = QFileDialog::getSaveFileName(this, QString("Export labels as COCO keypoints..."), filename, QString("*.json"));
+    if (filename.isEmpty()){
+        return;
+    }
+    if (filename.endsWith(".json") == false){
+        filename.append(".json");
+    }
+    settings.setValue("LAUYoloPoseLabelerWidget::cocoFilename", filename);
+
+    // MAKE SURE THE LABELS ON SCREEN ARE EXPORTED
+    saveCurrentImage();
+
+    // WITH A SINGLE IMAGE DIRECTORY THE FILE NAMES ARE RELATIVE TO IT, OTHERWISE THEY HAVE TO BE ABSOLUTE
+    QString rootString = (directoryStrings.count() == 1) ? directoryStrings.first() : QString();
+
+    // THE EXPORTER FORMATS IN PARALLEL AND STREAMS TO DISK ON ITS OWN THREAD, WE JUST WATCH
+    LAUPoseAnnotation annotation = palette->annotation();
+    LAUCocoExporter exporter(datasetIndex, filename, annotation.labels(), annotation.fiducialNames(), rootString, skipDuplicatesFlag);
+
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT
+    QProgressDialog progressDialog(QString("Exporting COCO keypoints..."), QString("Abort"), 0, datasetIndex->count(), this, Qt::Sheet);
+    progressDialog.setModal(Qt::WindowModal);
+    progressDialog.show();
+
+    bool canceled = false;
+    while (exporter.wait(100) == false){
+        if (progressDialog.wasCanceled()){
+            exporter.cancel();
+            canceled = true;
+        }
+        progressDialog.setValue(exporter.progress());
+        qApp->processEvents();
+    }
+    progressDialog.setValue(progressDialog.maximum());
+
+    if (canceled){
+        return;
+    } else if (exporter.isOkay() == false){
+        QMessageBox::warning(this, QString("Export COCO Keypoints"), QString("Unable to write %1.").arg(filename));
+        return;
+    }
+    QMessageBox::information(this, QString("Export COCO Keypoints"), QString("Exported %1 annotations to %2.").arg(exporter.annotations()).arg(filename));
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerWidget::onImportLabels()
+{
+    QSettings settings;
+    QString directory = settings.value("LAUYoloPoseLabelerWidget::importDirectoryString", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).toString();
+    if (QDir(directory).exists() == false){
+        directory = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    }
+    QMessageBox::information(this, QString("Import Labels"), QString("First, select directory of images to receive the labels."));
+    QString inputDirectoryString = QFileDialog::getExistingDirectory(this, QString("Set directory of images to label..."), directory);
+    if (inputDirectoryString.isEmpty()){
+        return;
+    }
+    settings.setValue("LAUYoloPoseLabelerWidget::importDirectoryString", inputDirectoryString);
+
+    QStringList items;
+    items << QString("YOLO Pose Label Files (*.txt)");
+    items << QString("COCO Keypoints File (*.json)");
+    bool okay = false;
+    QString item = QInputDialog::getItem(this, QString("Import Labels"), QString("Where are the labels coming from?"), items, settings.value("LAUYoloPoseLabelerWidget::importFormat", 0).toInt(), false, &okay);
+    if (okay == false){
+        return;
+    }
+    settings.setValue("LAUYoloPoseLabelerWidget::importFormat", items.indexOf(item));
+
+    bool replaceFlag = (QMessageBox::question(this, QString("Import Labels"), QString("Replace labels already saved in the images?"), QMessageBox::Yes | QMessageBox::No, QMessageBox::No) == QMessageBox::Yes);
+
+    LAUPoseAnnotation annotation = palette->annotation();
+    LAUPoseImporter importer(annotation.labels(), annotation.fiducialNames(), replaceFlag);
+
+    QString labelString = settings.value("LAUYoloPoseLabelerWidget::importLabelsString", inputDirectoryString).toString();
+    if (items.indexOf(item) == 0){
+        labelString = QFileDialog::getExistingDirectory(this, QString("Set directory of YOLO label files..."), labelString);
+        if (labelString.isEmpty()){
+            return;
+        }
+        importer.setYoloDirectory(labelString);
+    } else {
+        labelString = QFileDialog::getOpenFileName(this, QString("Load COCO keypoints from disk (*.json)"), labelString, QString("*.json"));
+        if (labelString.isEmpty()){
+            return;
+        }
+        QString errorString;
+        if (importer.loadCoco(labelString, &errorString) == false){
+            QMessageBox::warning(this, QString("Import Labels"), QString("Unable to read %1: %2").arg(labelString).arg(errorString));
+            return;
+        } else if (errorString.isEmpty() == false){
+            QMessageBox::warning(this, QString("Import Labels"), errorString);
+        }
+    }
+    settings.setValue("LAUYoloPoseLabelerWidget::importLabelsString", labelString);
+
+    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY AND WAIT FOR IT TO LAND ON DISK SO WE DON'T RACE THE WRITER
+    saveCurrentImage();
+    writer->flush();
+
+    // FIND IMAGES IN THE BACKGROUND AND HAND THEM TO THE WORKERS IN BLOCKS AS THEY TURN UP
+    LAUDirectoryWalker walker(QStringList() << inputDirectoryString, QStringList() << "*.tif" << "*.tiff", static_cast<LAUDatasetIndex *>(nullptr));
+
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT, ITS RANGE GROWS AS THE WALKER FINDS MORE IMAGES
+    QProgressDialog progressDialog(QString("Importing labels..."), QString("Abort"), 0, 0, this, Qt::Sheet);
+    progressDialog.setModal(Qt::WindowModal);
+    progressDialog.show();
+
+    QAtomicInt cancelFlag(0);
+    QAtomicInt doneCount(0);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(QThread::idealThreadCount());
+
+    QStringList block;
+    QString string;
+    while (walker.next(&string)){
+        block << string;
+        if (block.count() >= LAUPOSEIMPORTERBLOCKSIZE){
+            threadPool.start(new LAUPoseImportTask(&importer, block, &cancelFlag, &doneCount));
+            block.clear();
+        }
+        if (progressDialog.wasCanceled()){
+            cancelFlag.storeRelease(1);
+            break;
+        }
+        progressDialog.setMaximum(walker.count());
+        progressDialog.setValue(doneCount.loadAcquire());
+        qApp->processEvents();
+    }
+    if (block.isEmpty() == false && cancelFlag.loadAcquire() == 0){
+        threadPool.start(new LAUPoseImportTask(&importer, block, &cancelFlag, &doneCount));
+    }
+
+    while (threadPool.waitForDone(100) == false){
+        if (progressDialog.wasCanceled()){
+            cancelFlag.storeRelease(1);
+        }
+        progressDialog.setValue(doneCount.loadAcquire());
+        qApp->processEvents();
+    }
+    progressDialog.setValue(progressDialog.maximum());
+
+    // THE OPEN DATASET MAY HAVE BEEN AMONG THE FILES WE REWROTE, SO TREAT THEM LIKE ANY OTHER CHANGE ON DISK
+    QStringList strings = importer.importedStrings();
+    onFilesChanged(strings);
+    if (fileStrings.isEmpty() == false && strings.contains(currentFilename())){
+        showCurrentImage();
     }
+
+    QMessageBox::information(this, QString("Import Labels"), QString("Imported labels into %1 images, skipped %2 and failed on %3.").arg(importer.imported()).arg(importer.skipped()).arg(importer.failed()));
 }
 
 /*************************************************************************************/
@@ -614,10 +1469,6 @@ void LAUYoloPoseLabelerWidget::onSortByClass()
         return;
     }
 
-    // FIND ALL IMAGES INSIDE NESTED FOLDERS OF THE INPUT DIRECTORY
-    QStringList inputImageStrings;
-    QStringList directoryList;
-    QDir currentDirectory;
 
     // KEEP A LIST OF IMAGE FILES AND THEIR CORRESPONDING CONFIDENCES
     QList<ImageWithConfidencePacket> imagePackets;
@@ -641,44 +1492,33 @@ void LAUYoloPoseLabelerWidget::onSortByClass()
         femaleDir.mkdir(femaleDir.absolutePath());
     }
 
-    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY
-    if (palette->isDirty()){
-        image.setXmlData(palette->xml());
-        image.save(fileStrings.first());
-        palette->setDirty(false);
-    }
+    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY AND WAIT FOR IT TO LAND ON DISK
+    saveCurrentImage();
+    writer->flush();
 
-    directoryList.append(inputDirectoryString);
-    while (directoryList.count() > 0) {
-        currentDirectory.setPath(directoryList.takeFirst());
-        QStringList list = currentDirectory.entryList();
-        while (list.count() > 0) {
-            QString item = list.takeFirst();
-            if (!item.startsWith(".")) {
-                QDir dir(currentDirectory.absolutePath().append(QString("/").append(item)));
-                if (dir.exists()) {
-                    directoryList.append(dir.absolutePath());
-                } else if (item.endsWith(".tif")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                } else if (item.endsWith(".tiff")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                }
-            }
+    // FIND IMAGES IN THE BACKGROUND AND START ON THEM AS THEY TURN UP, THE INDEX TELLS US WHICH ARE LABELED SO WE ONLY DECODE THOSE
+    LAUDatasetIndex labelIndex(QStringList(), LAUDatasetIndex::defaultFilename(QStringList() << inputDirectoryString));
+    LAUDirectoryWalker walker(QStringList() << inputDirectoryString, QStringList() << "*.tif" << "*.tiff", &labelIndex);
+
+    // WORK ON A COPY OF THE ANNOTATION SO NOTHING HERE DEPENDS ON THE PALETTE'S WIDGETS
+    LAUPoseAnnotation annotation = palette->annotation();
+    QString string;
+    for (int n = 0; walker.next(&string); n++){
+        if (labelIndex.entry(n).labeled == false){
+            continue;
         }
-    }
 
-    for (int n = 0; n < inputImageStrings.count(); n++){
-        QString string = inputImageStrings.at(n);
         LAUImage image(string);
 
         // SET PALETTE WIDGETS FROM XML STRING OF IMAGE
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
+        annotation.setXml(image.xmlData());
+        annotation.setImageSize(image.width(), image.height());
+        palette->setAnnotation(annotation);
+        label->setPixmap(QPixmap::fromImage(LAUImagePrefetchObject::preview(image)));
         this->setWindowTitle(image.filename());
 
         if (image.xmlData().isEmpty() == false){
-            if (palette->getClass() == 0){
+            if (annotation.classIndex() == 0){
                 QString labelString = QString("%1/%2").arg(maleDir.absolutePath()).arg(QFileInfo(string).fileName());
                 image.save(labelString);
             } else {
@@ -690,13 +1530,7 @@ void LAUYoloPoseLabelerWidget::onSortByClass()
     }
 
     // RESET THE DISPLAY TO SHOW THE IMAGE THAT WAS THERE AT THE START OF THIS METHOD
-    if (fileStrings.count() > 0){
-        image = LAUImage(fileStrings.first());
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
-        this->setWindowTitle(QFileInfo(fileStrings.first()).fileName());
-    }
+    showCurrentImage();
 }
 
 /*************************************************************************************/
@@ -722,10 +1556,6 @@ void LAUYoloPoseLabelerWidget::onLabelImagesFromDisk()
         return;
     }
 
-    // FIND ALL IMAGES INSIDE NESTED FOLDERS OF THE INPUT DIRECTORY
-    QStringList inputImageStrings;
-    QStringList directoryList;
-    QDir currentDirectory;
 
     // KEEP A LIST OF IMAGE FILES AND THEIR CORRESPONDING CONFIDENCES
     QList<ImageWithConfidencePacket> imagePackets;
@@ -740,53 +1570,36 @@ void LAUYoloPoseLabelerWidget::onLabelImagesFromDisk()
         return;
     }
 
-    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY
-    if (palette->isDirty()){
-        image.setXmlData(palette->xml());
-        image.save(fileStrings.first());
-        palette->setDirty(false);
-    }
+    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY AND WAIT FOR IT TO LAND ON DISK
+    saveCurrentImage();
+    writer->flush();
 
-    directoryList.append(inputDirectoryString);
-    while (directoryList.count() > 0) {
-        currentDirectory.setPath(directoryList.takeFirst());
-        QStringList list = currentDirectory.entryList();
-        while (list.count() > 0) {
-            QString item = list.takeFirst();
-            if (!item.startsWith(".")) {
-                QDir dir(currentDirectory.absolutePath().append(QString("/").append(item)));
-                if (dir.exists()) {
-                    directoryList.append(dir.absolutePath());
-                } else if (item.endsWith(".tif")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                } else if (item.endsWith(".tiff")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                } else if (item.endsWith(".jpg")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                }
-            }
-        }
-    }
+    // FIND IMAGES IN THE BACKGROUND AND START ON THEM AS THEY TURN UP
+    LAUDirectoryWalker walker(QStringList() << inputDirectoryString, LAUDirectoryWalker::imageFilters(), static_cast<LAUDatasetIndex *>(nullptr));
 
-    // CREATE A PROGRESS DIALOG SO USER CAN ABORT
-    QProgressDialog progressDialog(QString("Labeling images..."), QString("Abort"), 0, inputImageStrings.count(), this, Qt::Sheet);
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT, ITS RANGE GROWS AS THE WALKER FINDS MORE IMAGES
+    QProgressDialog progressDialog(QString("Labeling images..."), QString("Abort"), 0, 0, this, Qt::Sheet);
     progressDialog.setModal(Qt::WindowModal);
     progressDialog.show();
 
-    for (int n = 0; n < inputImageStrings.count(); n++){
+    // WORK ON A COPY OF THE ANNOTATION SO NOTHING HERE DEPENDS ON THE PALETTE'S WIDGETS
+    LAUPoseAnnotation annotation = palette->annotation();
+    QString string;
+    for (int n = 0; walker.next(&string); n++){
         if (progressDialog.wasCanceled()) {
             break;
         }
+        progressDialog.setMaximum(walker.count());
         progressDialog.setValue(n);
         qApp->processEvents();
 
-        QString string = inputImageStrings.at(n);
         LAUImage image(string);
 
         // SET PALETTE WIDGETS FROM XML STRING OF IMAGE
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
+        annotation.setXml(image.xmlData());
+        annotation.setImageSize(image.width(), image.height());
+        palette->setAnnotation(annotation);
+        label->setPixmap(QPixmap::fromImage(LAUImagePrefetchObject::preview(image)));
         this->setWindowTitle(image.filename());
 
         QList<LAUMemoryObject> objects = poseNetwork.process(image.zeroPad(0, 0, 0, 640 - image.height()));
@@ -795,10 +1608,11 @@ void LAUYoloPoseLabelerWidget::onLabelImagesFromDisk()
             float confidence = 0.70f;
             QList<QVector3D> points = poseNetwork.points(0, &confidence);
 
-            for (int n = 0; n < palette->fiducials(); n++){
-                palette->setFiducial(n, qRound(points.at(n+2).x()), qRound(points.at(n+2).y()), (points.at(n+2).z() > 0.5));
+            for (int n = 0; n < annotation.fiducials(); n++){
+                annotation.setFiducial(n, qRound(points.at(n+2).x()), qRound(points.at(n+2).y()), (points.at(n+2).z() > 0.5));
             }
-            image.setXmlData(palette->xml());
+            annotation.setConfidence(confidence);
+            QByteArray xml = annotation.xml();
 
             QString fileString = QString("%1").arg(n);
             while (fileString.length() < 5){
@@ -806,11 +1620,15 @@ void LAUYoloPoseLabelerWidget::onLabelImagesFromDisk()
             }
             fileString.prepend(labelsDirectoryString);
             fileString.append(".tif");
-            image.save(fileString);
-            palette->setDirty(false);
+
+            // COPY THE FILE AND REWRITE ITS XML PACKET RATHER THAN RE-ENCODING EVERY PIXEL
+            if (LAUImage::copyWithXmlPacket(string, fileString, xml) == false){
+                image.setXmlData(xml);
+                image.save(fileString);
+            }
         }
     }
-    progressDialog.setValue(inputImageStrings.count());
+    progressDialog.setValue(progressDialog.maximum());
 #else
     // ASK THE USER FOR A FOLDER TO SAVE THE IMAGES IN ORDER OF CONFIDENCE A
     directory = settings.value("LAUYoloPoseLabelerWidget::confidenceDirectoryString", QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).toString();
@@ -837,53 +1655,36 @@ void LAUYoloPoseLabelerWidget::onLabelImagesFromDisk()
         errorDir.mkdir(errorDir.absolutePath());
     }
 
-    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY
-    if (palette->isDirty()){
-        image.setXmlData(palette->xml());
-        image.save(fileStrings.first());
-        palette->setDirty(false);
-    }
+    // SAVE THE CURRENT IMAGE ON SCREEN IF DIRTY AND WAIT FOR IT TO LAND ON DISK
+    saveCurrentImage();
+    writer->flush();
 
-    directoryList.append(inputDirectoryString);
-    while (directoryList.count() > 0) {
-        currentDirectory.setPath(directoryList.takeFirst());
-        QStringList list = currentDirectory.entryList();
-        while (list.count() > 0) {
-            QString item = list.takeFirst();
-            if (!item.startsWith(".")) {
-                QDir dir(currentDirectory.absolutePath().append(QString("/").append(item)));
-                if (dir.exists()) {
-                    directoryList.append(dir.absolutePath());
-                } else if (item.endsWith(".tif")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                } else if (item.endsWith(".tiff")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                } else if (item.endsWith(".jpg")) {
-                    inputImageStrings.append(currentDirectory.absolutePath().append(QString("/").append(item)));
-                }
-            }
-        }
-    }
+    // FIND IMAGES IN THE BACKGROUND AND START ON THEM AS THEY TURN UP
+    LAUDirectoryWalker walker(QStringList() << inputDirectoryString, LAUDirectoryWalker::imageFilters(), static_cast<LAUDatasetIndex *>(nullptr));
 
-    // CREATE A PROGRESS DIALOG SO USER CAN ABORT
-    QProgressDialog progressDialog(QString("Labeling images..."), QString("Abort"), 0, inputImageStrings.count(), this, Qt::Sheet);
+    // CREATE A PROGRESS DIALOG SO USER CAN ABORT, ITS RANGE GROWS AS THE WALKER FINDS MORE IMAGES
+    QProgressDialog progressDialog(QString("Labeling images..."), QString("Abort"), 0, 0, this, Qt::Sheet);
     progressDialog.setModal(Qt::WindowModal);
     progressDialog.show();
 
-    for (int n = 0; n < inputImageStrings.count(); n++){
+    // WORK ON A COPY OF THE ANNOTATION SO NOTHING HERE DEPENDS ON THE PALETTE'S WIDGETS
+    LAUPoseAnnotation annotation = palette->annotation();
+    QString string;
+    for (int n = 0; walker.next(&string); n++){
         if (progressDialog.wasCanceled()) {
             break;
         }
+        progressDialog.setMaximum(walker.count());
         progressDialog.setValue(n);
         qApp->processEvents();
 
-        QString string = inputImageStrings.at(n);
         LAUImage image(string);
 
         // SET PALETTE WIDGETS FROM XML STRING OF IMAGE
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
+        annotation.setXml(image.xmlData());
+        annotation.setImageSize(image.width(), image.height());
+        palette->setAnnotation(annotation);
+        label->setPixmap(QPixmap::fromImage(LAUImagePrefetchObject::preview(image)));
         this->setWindowTitle(image.filename());
 
         QList<LAUMemoryObject> objects = poseNetwork.process(image);
@@ -899,33 +1700,33 @@ void LAUYoloPoseLabelerWidget::onLabelImagesFromDisk()
             if (qMax(confidenceA, confidenceB) > 0.7){
                 bool errorFlag = false;
                 if (confidenceA > confidenceB){
-                    if (palette->getClass() != 0){
+                    if (annotation.classIndex() != 0){
                         errorFlag = true;
                     }
-                    palette->setClass(0);
-                    for (int n = 0; n < palette->fiducials(); n++){
+                    annotation.setClassIndex(0);
+                    for (int n = 0; n < annotation.fiducials(); n++){
 #ifdef ZOOMINTOHEAD
                         if (n < 6 || n > 11){
                             continue;
                         }
-                        palette->setFiducial(n, qRound(pointsA.at(n-4).x()), qRound(pointsA.at(n-4).y()), (pointsA.at(n-4).z() > 0.5));
+                        annotation.setFiducial(n, qRound(pointsA.at(n-4).x()), qRound(pointsA.at(n-4).y()), (pointsA.at(n-4).z() > 0.5));
 #else
-                        palette->setFiducial(n, qRound(pointsA.at(n+2).x()), qRound(pointsA.at(n+2).y()), (pointsA.at(n+2).z() > 0.5));
+                        annotation.setFiducial(n, qRound(pointsA.at(n+2).x()), qRound(pointsA.at(n+2).y()), (pointsA.at(n+2).z() > 0.5));
 #endif
                     }
                 } else {
-                    if (palette->getClass() != 1){
+                    if (annotation.classIndex() != 1){
                         errorFlag = true;
                     }
-                    palette->setClass(1);
-                    for (int n = 0; n < palette->fiducials(); n++){
+                    annotation.setClassIndex(1);
+                    for (int n = 0; n < annotation.fiducials(); n++){
 #ifdef ZOOMINTOHEAD
                         if (n < 6 || n > 11){
                             continue;
                         }
-                        palette->setFiducial(n, qRound(pointsB.at(n-4).x()), qRound(pointsB.at(n-4).y()), (pointsB.at(n-4).z() > 0.5));
+                        annotation.setFiducial(n, qRound(pointsB.at(n-4).x()), qRound(pointsB.at(n-4).y()), (pointsB.at(n-4).z() > 0.5));
 #else
-                        palette->setFiducial(n, qRound(pointsB.at(n+2).x()), qRound(pointsB.at(n+2).y()), (pointsB.at(n+2).z() > 0.5));
+                        annotation.setFiducial(n, qRound(pointsB.at(n+2).x()), qRound(pointsB.at(n+2).y()), (pointsB.at(n+2).z() > 0.5));
 #endif
                     }
                 }
@@ -945,31 +1746,35 @@ void LAUYoloPoseLabelerWidget::onLabelImagesFromDisk()
                 // SAVE THE IMAGE TO THE ERROR STRING BEFORE WE CHANGE ITS XML FIELD TO THE AI MODEL OUTPUT
                 if (errorFlag){
                     QString errorString = QString("%1/error_%2_%3_%4").arg(errorDir.absolutePath()).arg(labelStringA).arg(labelStringB).arg(fileString);
-                    image.save(errorString);
+                    if (LAUImage::copyWithXmlPacket(string, errorString, image.xmlData()) == false){
+                        image.save(errorString);
+                    }
                 }
-                image.setXmlData(palette->xml());
+
+                // COPY THE FILE AND REWRITE ITS XML PACKET RATHER THAN RE-ENCODING EVERY PIXEL
+                annotation.setConfidence(qMax(confidenceA, confidenceB));
+                QByteArray xml = annotation.xml();
 
                 QString labelString = QString("%1/male_%2_%3_%4").arg(maleDir.absolutePath()).arg(labelStringA).arg(labelStringB).arg(fileString);
-                image.save(labelString);
+                if (LAUImage::copyWithXmlPacket(string, labelString, xml) == false){
+                    image.setXmlData(xml);
+                    image.save(labelString);
+                }
 
                 labelString = QString("%1/female_%2_%3_%4").arg(femaleDir.absolutePath()).arg(labelStringB).arg(labelStringA).arg(fileString);
-                image.save(labelString);
+                if (LAUImage::copyWithXmlPacket(string, labelString, xml) == false){
+                    image.setXmlData(xml);
+                    image.save(labelString);
+                }
             }
-            palette->setDirty(false);
         }
         qApp->processEvents();
     }
-    progressDialog.setValue(inputImageStrings.count());
+    progressDialog.setValue(progressDialog.maximum());
 #endif
 
     // RESET THE DISPLAY TO SHOW THE IMAGE THAT WAS THERE AT THE START OF THIS METHOD
-    if (fileStrings.count() > 0){
-        image = LAUImage(fileStrings.first());
-        palette->setXml(image.xmlData());
-        palette->setImageSize(image.width(), image.height());
-        label->setPixmap(QPixmap::fromImage(image.preview(QSize(image.width(), image.height()))));
-        this->setWindowTitle(QFileInfo(fileStrings.first()).fileName());
-    }
+    showCurrentImage();
 }
 
 /*************************************************************************************/
@@ -983,6 +1788,14 @@ void LAUYoloPoseLabelerWidget::onContextMenuTriggered(QMouseEvent *event)
     connect(action, SIGNAL(triggered()), this, SLOT(onExportLabelsForYoloPoseTraining()));
     contextMenu.addAction(action);
 
+    action = new QAction("Export Labels as COCO Keypoints...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onExportLabelsAsCocoKeypoints()));
+    contextMenu.addAction(action);
+
+    action = new QAction("Import Labels...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onImportLabels()));
+    contextMenu.addAction(action);
+
     // action = new QAction("Export Labels for YOLO Classifier Training", this);
     // connect(action, SIGNAL(triggered()), this, SLOT(onExportLabelsForYoloClassifierTraining()));
     // contextMenu.addAction(action);
@@ -991,10 +1804,59 @@ void LAUYoloPoseLabelerWidget::onContextMenuTriggered(QMouseEvent *event)
     connect(action, SIGNAL(triggered()), this, SLOT(onLabelImagesFromDisk()));
     contextMenu.addAction(action);
 
+    action = new QAction("Model Assisted Labeling...", this);
+    action->setCheckable(true);
+    action->setChecked(inference != nullptr);
+    connect(action, SIGNAL(triggered()), this, SLOT(onEnableModelAssist()));
+    contextMenu.addAction(action);
+
+    action = new QAction("Accept Model Prediction", this);
+    action->setEnabled(predictionFlag);
+    connect(action, SIGNAL(triggered()), this, SLOT(onAcceptPrediction()));
+    contextMenu.addAction(action);
+
     action = new QAction("Sort Images by Class", this);
     connect(action, SIGNAL(triggered()), this, SLOT(onSortByClass()));
     contextMenu.addAction(action);
 
+    action = new QAction("Dataset Report...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onDatasetReport()));
+    contextMenu.addAction(action);
+
+    action = new QAction("Check Annotations...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onCheckAnnotations()));
+    contextMenu.addAction(action);
+
+    contextMenu.addSeparator();
+
+    action = new QAction("Go to Image...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onGoToImage()));
+    contextMenu.addAction(action);
+
+    action = new QAction("Browse Thumbnails...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onBrowseThumbnails()));
+    contextMenu.addAction(action);
+
+    action = new QAction("Set Navigation Filter...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onSetNavigationFilter()));
+    contextMenu.addAction(action);
+
+    action = new QAction("Skip Near Duplicates", this);
+    action->setCheckable(true);
+    action->setChecked(skipDuplicatesFlag);
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(onSkipNearDuplicates(bool)));
+    contextMenu.addAction(action);
+
+    contextMenu.addSeparator();
+
+    action = new QAction("Set Prefetch Window...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onSetPrefetchWindow()));
+    contextMenu.addAction(action);
+
+    action = new QAction("Set Preview Cache Size...", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(onSetPreviewCacheSize()));
+    contextMenu.addAction(action);
+
     contextMenu.exec(event->globalPos());
 }
 
@@ -1042,37 +1904,8 @@ LAUFiducialWidget::LAUFiducialWidget(QWidget *parent) : QWidget(parent)
 /*************************************************************************************/
 LAUYoloPoseLabelerPalette::LAUYoloPoseLabelerPalette(QByteArray xmlByteArray, QWidget *parent) : QWidget(parent)
 {
-    QStringList labels;
-    QStringList fiducials;
-
-    QXmlStreamReader reader(xmlByteArray);
-    while (!reader.atEnd()) {
-        if (reader.readNext()) {
-            QString name = reader.name().toString();
-            if (name == "label") {
-                labels = reader.readElementText().split(",");
-                if (labels.count() > 0){
-                    int index = labels.contains(labels.last());
-                    if (index > 0){
-                        labels.removeLast();
-                    }
-                }
-            } else if (name == "fiducial") {
-                QString string = reader.readElementText();
-                int indexA = string.indexOf("\"") + 1;
-                int indexB = string.lastIndexOf("\"");
-
-                if (indexA > -1 && indexB < string.length()){
-                    QString label = string;
-                    label = label.left(indexB);
-                    label = label.right(indexB - indexA);
-                    fiducials << label;
-                }
-            }
-        }
-    }
-    reader.clear();
-    initialize(labels, fiducials);
+    LAUPoseAnnotation annotation = LAUPoseAnnotation::fromXml(xmlByteArray);
+    initialize(annotation.labels(), annotation.fiducialNames());
 }
 
 /*************************************************************************************/
@@ -1093,6 +1926,9 @@ void LAUYoloPoseLabelerPalette::initialize(QStringList labels, QStringList fiduc
     this->layout()->setSpacing(6);
     this->setFocusPolicy(Qt::StrongFocus);
 
+    // THE WIDGETS BELOW ARE JUST A VIEW OF THIS
+    poseAnnotation = LAUPoseAnnotation(labels, fiducials);
+
     QGroupBox *box = new QGroupBox("Label:");
     box->setLayout(new QVBoxLayout());
     box->layout()->setContentsMargins(6,6,6,6);
@@ -1102,6 +1938,7 @@ void LAUYoloPoseLabelerPalette::initialize(QStringList labels, QStringList fiduc
     labelsComboBox = new QComboBox();
     labelsComboBox->addItems(labels);
     connect(labelsComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(onLabelIndexChanged(int)));
+    connect(labelsComboBox, SIGNAL(activated(int)), this, SIGNAL(emitEdited()));
     box->layout()->addWidget(labelsComboBox);
 
     box = new QGroupBox("Fiducials:");
@@ -1115,6 +1952,8 @@ void LAUYoloPoseLabelerPalette::initialize(QStringList labels, QStringList fiduc
         widget->lineEdit->setText(fiducials.at(n));
         widget->lineEdit->setReadOnly(true);
         widget->index = n;
+        connect(widget->zRadioButton, SIGNAL(toggled(bool)), widget, SLOT(onRadioButtonToggled(bool)));
+        connect(widget, SIGNAL(emitVisibleToggled(int,bool)), this, SLOT(onFiducialVisibleToggled(int,bool)));
 
         QLabel *label = new QLabel(QString("%1:").arg(n+1));
         label->setAlignment(Qt::AlignVCenter | Qt::AlignRight);
@@ -1165,6 +2004,7 @@ LAUYoloPoseLabelerPalette::~LAUYoloPoseLabelerPalette()
 /*************************************************************************************/
 void LAUYoloPoseLabelerPalette::setClass(int index)
 {
+    poseAnnotation.setClassIndex(index);
     labelsComboBox->setCurrentIndex(index);
 }
 
@@ -1173,316 +2013,166 @@ void LAUYoloPoseLabelerPalette::setClass(int index)
 /*************************************************************************************/
 void LAUYoloPoseLabelerPalette::setFiducial(int index, int x, int y, bool z)
 {
-    fiducialWidgets.at(index)->xSpinBox->setValue(x);
-    fiducialWidgets.at(index)->ySpinBox->setValue(y);
-    fiducialWidgets.at(index)->zRadioButton->setChecked(z);
+    poseAnnotation.setFiducial(index, x, y, z);
+    for (int n = 0; n < fiducialWidgets.count(); n++){
+        if (fiducialWidgets.at(n)->index == index){
+            fiducialWidgets.at(n)->xSpinBox->setValue(x);
+            fiducialWidgets.at(n)->ySpinBox->setValue(y);
+            fiducialWidgets.at(n)->zRadioButton->setChecked(z);
+        }
+    }
 }
 
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
-QByteArray LAUYoloPoseLabelerPalette::xml(QRect roi, double scale, bool flag) const
+void LAUYoloPoseLabelerPalette::setAnnotation(LAUPoseAnnotation value)
 {
-    // CREATE THE XML DATA PACKET USING QT'S XML STREAM OBJECTS
-    QBuffer buffer;
-    buffer.open(QIODevice::WriteOnly);
-
-    QXmlStreamWriter writer(&buffer);
-    writer.setAutoFormatting(true);
-    writer.writeStartDocument();
-    writer.writeStartElement("LAUYoloPoseFiducials");
-
-    // WRITE THE LABEL TO XML
-    QString labelString;
-    for (int n = 0; n < labelsComboBox->count(); n++){
-        labelString.append(QString("%1,").arg(labelsComboBox->itemText(n)));
-    }
-    labelString.append(QString("%1").arg(labelsComboBox->currentText()));
-    writer.writeTextElement("label", labelString);
+    poseAnnotation = value;
+    updateWidgets();
+    dirtyFlag = false;
+}
 
-    // SAVE THE FILENAME STRING IF AVAILABLE
-    if (originalFileName.isEmpty() == false){
-        writer.writeTextElement("origin", originalFileName);
-    }
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUYoloPoseLabelerPalette::updateWidgets()
+{
+    // THE COMBO BOX WOULD OTHERWISE MARK US DIRTY FOR JUST SHOWING WHAT IS ON DISK
+    labelsComboBox->blockSignals(true);
+    labelsComboBox->setCurrentIndex(poseAnnotation.classIndex());
+    labelsComboBox->blockSignals(false);
 
-    // WRITE THE FIDUCIALS TO XML
+    // THE FIDUCIAL WIDGETS ROTATE AS THE USER STEPS THROUGH THEM, SO MATCH THEM UP BY THEIR INDEX
     for (int n = 0; n < fiducialWidgets.count(); n++){
-        if (flag && (n < 6 || n > 11)){
-            continue;
-        }
-        int x = qRound((fiducialWidgets.at(n)->xSpinBox->value() - roi.left()) * scale);
-        int y = qRound((fiducialWidgets.at(n)->ySpinBox->value() - roi.top()) * scale);
-        int z = fiducialWidgets.at(n)->zRadioButton->isChecked();
-        writer.writeTextElement(QString("fiducial"), QString("\"%1\",%2,%3,%4").arg(fiducialWidgets.at(n)->lineEdit->text()).arg(z).arg(x).arg(y));
+        LAUFiducialWidget *widget = fiducialWidgets.at(n);
+        widget->xSpinBox->setValue(poseAnnotation.x(widget->index));
+        widget->ySpinBox->setValue(poseAnnotation.y(widget->index));
+        widget->zRadioButton->setChecked(poseAnnotation.isVisible(widget->index));
     }
-
-    // CLOSE OUT THE XML BUFFER
-    writer.writeEndElement();
-    writer.writeEndDocument();
-    buffer.close();
-
-    // EXPORT THE XML BUFFER TO THE XMLPACKET FIELD OF THE TIFF IMAGE
-    return(buffer.buffer());
 }
 
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
-QStringList LAUYoloPoseLabelerPalette::labels() const
+void LAUYoloPoseLabelerPalette::setXml(QByteArray string)
 {
-    QStringList strings;
-    if (labelsComboBox){
-        for (int n = 0; n < labelsComboBox->count(); n++){
-            strings << labelsComboBox->itemText(n);
-        }
-    }
-    return(strings);
+    poseAnnotation.setXml(string);
+    updateWidgets();
+
+    // WE NOW MATCH WHAT IS ON DISK
+    dirtyFlag = false;
 }
 
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
-QString LAUYoloPoseLabelerPalette::labelString(QRect *rect, bool flag) const
+void LAUYoloPoseLabelerPalette::onPaintEvent(QPainter *painter, QSize sze)
 {
-    QList<float> fiducials;
-
-    // EXTRACT THE LABEL INDEX
-    fiducials << (double)labelsComboBox->currentIndex();
-
-    if (flag){
-        // CENTER THE 7TH FIDUCIAL IN THE REGION OF INTEREST
-        rect->moveCenter(QPoint(fiducialWidgets.at(6)->xSpinBox->value(), fiducialWidgets.at(6)->ySpinBox->value()));
-
-        // EXTRACT THE BOUNDING BOX
-        int xMin = 10000;
-        int xMax = -1000;
-        int yMin = 10000;
-        int yMax = -1000;
-
-        // 6, 7, 8, 9, 10, 11
-        for (int n = 6; n < 12 && n < fiducialWidgets.count(); n++){
-            if (flag && (n < 6 || n > 11)){
-                continue;
-            }
-            xMin = qMin(xMin, fiducialWidgets.at(n)->xSpinBox->value() - 40);
-            xMax = qMax(xMax, fiducialWidgets.at(n)->xSpinBox->value() + 40);
-            yMin = qMin(yMin, fiducialWidgets.at(n)->ySpinBox->value() - 40);
-            yMax = qMax(yMax, fiducialWidgets.at(n)->ySpinBox->value() + 40);
-        }
-
-        // MOVE REGION OF INTEREST TO KEEP ALL FIDUCIALS INSIDE BOX
-        if (xMin < rect->left() || rect->left() < 0){
-            rect->moveLeft(qMax(0, xMin));
-        } else if (xMax > rect->right() || rect->right() >= imageWidth){
-            rect->moveRight(qMin(xMax, imageWidth-1));
-        }
-
-        if (yMin < rect->top() || rect->top() < 0){
-            rect->moveTop(qMax(0, yMin));
-        } else if (yMax > rect->bottom() || rect->bottom() >= imageHeight){
-            rect->moveBottom(qMin(yMax, imageHeight-1));
-        }
-    } else {
-        // EXTRACT THE BOUNDING BOX
-        int xMin = 10000;
-        int xMax = -1000;
-        int yMin = 10000;
-        int yMax = -1000;
-
-        for (int n = 0; n < fiducialWidgets.count(); n++){
-            if (flag && (n < 6 || n > 11)){
-                continue;
-            }
-            xMin = qMin(xMin, fiducialWidgets.at(n)->xSpinBox->value() - 40);
-            xMax = qMax(xMax, fiducialWidgets.at(n)->xSpinBox->value() + 40);
-            yMin = qMin(yMin, fiducialWidgets.at(n)->ySpinBox->value() - 40);
-            yMax = qMax(yMax, fiducialWidgets.at(n)->ySpinBox->value() + 40);
-        }
-
-        // MOVE REGION OF INTEREST TO KEEP ALL FIDUCIALS INSIDE BOX
-        if (xMin < rect->left() || rect->left() < 0){
-            rect->moveLeft(qMax(0, xMin));
-        } else if (xMax > rect->right() || rect->right() >= imageWidth){
-            rect->moveRight(qMin(xMax, imageWidth-1));
-        }
-
-        if (yMin < rect->top() || rect->top() < 0){
-            rect->moveTop(qMax(0, yMin));
-        } else if (yMax > rect->bottom() || rect->bottom() >= imageHeight){
-            rect->moveBottom(qMin(yMax, imageHeight-1));
-        }
-    }
-
-    // RECALCULATE LIMITS NOW THAT WE'VE CENTERED THE ROI
     int xMin = 10000;
     int xMax = -1000;
     int yMin = 10000;
     int yMax = -1000;
 
-    for (int n = 0; n < fiducialWidgets.count(); n++){
-        if (flag && (n < 6 || n > 11)){
+    for (int n = 0; n < poseAnnotation.fiducials(); n++){
+        if (poseAnnotation.x(n) < 0){
             continue;
         }
-        xMin = qMin(xMin, fiducialWidgets.at(n)->xSpinBox->value() - rect->left());
-        xMax = qMax(xMax, fiducialWidgets.at(n)->xSpinBox->value() - rect->left());
-        yMin = qMin(yMin, fiducialWidgets.at(n)->ySpinBox->value() - rect->top());
-        yMax = qMax(yMax, fiducialWidgets.at(n)->ySpinBox->value() - rect->top());
+        xMin = qMin(xMin, poseAnnotation.x(n));
+        xMax = qMax(xMax, poseAnnotation.x(n));
+        yMin = qMin(yMin, poseAnnotation.y(n));
+        yMax = qMax(yMax, poseAnnotation.y(n));
     }
 
-    double xLeft = (double)(xMin - 20) / (double)rect->width();
-    double xWide = (double)(xMax - xMin + 40) / (double)rect->width();
-    double yTop = (double)(yMin - 20) / (double)rect->height();
-    double yTall = (double)(yMax - yMin + 40) / (double)rect->height();
+    // DON'T DRAW ANYTHING IF ALL FIDUCIALS ARE EQUAL TO ZERO
+    if (xMin == 0 && xMax == 0 && yMin == 0 && yMax == 0){
+        return;
+    }
 
-    fiducials << (xLeft + xWide/2.0);
-    fiducials << (yTop + yTall/2.0);
-    fiducials << xWide;
-    fiducials << yTall;
+    int xLeft = (double)(xMin - 20) / (double)poseAnnotation.width() * (double)sze.width();
+    int xWide = (double)(xMax - xMin + 40) / (double)poseAnnotation.width() * (double)sze.width();
+    int yTop = (double)(yMin - 20) / (double)poseAnnotation.height() * (double)sze.height();
+    int yTall = (double)(yMax - yMin + 40) / (double)poseAnnotation.height() * (double)sze.height();
 
-    // EXTRACT THE FIDUCIAL COORDINATES
-    for (int n = 0; n < fiducialWidgets.count(); n++){
-        if (flag && (n < 6 || n > 11)){
-            continue;
-        }
-        fiducials << (double)(fiducialWidgets.at(n)->xSpinBox->value() - rect->left()) / (double)rect->width();
-        fiducials << (double)(fiducialWidgets.at(n)->ySpinBox->value() - rect->top()) / (double)rect->height();
-        if (fiducialWidgets.at(n)->zRadioButton->isChecked()){
-            fiducials << 1.0;
-        } else {
-            fiducials << 0.0;
-        }
-    }
+    painter->setPen(QPen(Qt::red, 3.0));
+    painter->setBrush(QBrush(QColor(Qt::red), Qt::NoBrush));
+    painter->drawRect(xLeft, yTop, xWide, yTall);
 
-    // CLAMP ALL COORDINATES TO NOMALIZED IMAGE BOUNDS
-    for (int n = 1; n < fiducials.count(); n++){
-        if (fiducials.at(n) > 1.0){
-            fiducials.replace(n, 0.9999);
-        } else if (fiducials.at(n) < 0.0){
-            fiducials.replace(n, 0.0001);
+    for (int n = 0; n < poseAnnotation.fiducials(); n++){
+        if (poseAnnotation.x(n) < 0){
+            continue;
         }
-    }
-
-    QString string;
-    string.append(QString("%1 ").arg((int)qRound(fiducials.takeFirst())));
-    while (fiducials.count() > 0){
-        string.append(QString("%1 ").arg(fiducials.takeFirst(), 0, 'f', 6));
-    }
-    string.chop(1);
 
-    return(string);
-}
+        QPoint point;
+        point.setX((double)poseAnnotation.x(n) / (double)poseAnnotation.width() * (double)sze.width());
+        point.setY((double)poseAnnotation.y(n) / (double)poseAnnotation.height() * (double)sze.height());
 
-/*************************************************************************************/
-/*************************************************************************************/
-/*************************************************************************************/
-void LAUYoloPoseLabelerPalette::setXml(QByteArray string)
-{
-    if (string.isEmpty()){
-        for (int n = 0; n < fiducialWidgets.count(); n++){
-            LAUFiducialWidget *widget = fiducialWidgets.at(n);
-            widget->xSpinBox->setValue(0);
-            widget->ySpinBox->setValue(0);
-            widget->zRadioButton->setChecked(true);
-            labelsComboBox->setCurrentIndex(0);
+        if (point.x() == 0 && point.y() == 0){
+            continue;
         }
-    } else {
-        QXmlStreamReader reader(string);
-        while (!reader.atEnd()) {
-            if (reader.readNext()) {
-                QString name = reader.name().toString();
-                if (name == "label") {
-                    QStringList labelStrings = reader.readElementText().split(",");
-                    if (labelStrings.count() > 0){
-                        labelsComboBox->setCurrentText(labelStrings.last().simplified());
-                    }
-                } else if (name == "fiducial") {
-                    QString string = reader.readElementText();
-                    int indexA = string.indexOf("\"") + 1;
-                    int indexB = string.lastIndexOf("\"");
-
-                    if (indexA > -1 && indexB < string.length()){
-                        QString label = string;
-                        label = label.left(indexB);
-                        label = label.right(indexB - indexA);
-
-                        for (int n = 0; n < fiducialWidgets.count(); n++){
-                            if (fiducialWidgets.at(n)->lineEdit->text() == label){
-                                string = string.right(string.length() - indexB - 2);
-                                QStringList strings = string.split(",");
-                                if (strings.count() == 3){
-                                    fiducialWidgets.at(n)->zRadioButton->setChecked(strings.at(0).toInt());
-                                    fiducialWidgets.at(n)->xSpinBox->setValue(strings.at(1).toInt());
-                                    fiducialWidgets.at(n)->ySpinBox->setValue(strings.at(2).toInt());
-                                }
-                                break;
-                            }
-                        }
-                    }
-                } else if (name == "origin"){
-                    originalFileName = reader.readElementText();
-                }
-            }
+
+        if (poseAnnotation.isVisible(n)){
+            painter->setPen(QPen(Qt::red, 6.0));
+            painter->setBrush(QBrush(QColor(Qt::red), Qt::SolidPattern));
+        } else {
+            painter->setPen(QPen(Qt::blue, 6.0));
+            painter->setBrush(QBrush(QColor(Qt::blue), Qt::SolidPattern));
         }
-        reader.clear();
+        painter->drawEllipse(point.x()-2, point.y()-2, 5, 5);
+        painter->drawText(point + QPoint(10,10), QString("%1").arg(n + 1));
     }
 }
 
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
-void LAUYoloPoseLabelerPalette::onPaintEvent(QPainter *painter, QSize sze)
+void LAUYoloPoseLabelerPalette::onOverlayRegion(QRegion *region, QSize sze, QFontMetrics metrics)
 {
+    // THIS HAS TO COVER EVERYTHING onPaintEvent() DRAWS USING THE SAME MATH
     int xMin = 10000;
     int xMax = -1000;
     int yMin = 10000;
     int yMax = -1000;
 
-    for (int n = 0; n < fiducialWidgets.count(); n++){
-        if (fiducialWidgets.at(n)->xSpinBox->value() < 0){
+    for (int n = 0; n < poseAnnotation.fiducials(); n++){
+        if (poseAnnotation.x(n) < 0){
             continue;
         }
-        xMin = qMin(xMin, fiducialWidgets.at(n)->xSpinBox->value());
-        xMax = qMax(xMax, fiducialWidgets.at(n)->xSpinBox->value());
-        yMin = qMin(yMin, fiducialWidgets.at(n)->ySpinBox->value());
-        yMax = qMax(yMax, fiducialWidgets.at(n)->ySpinBox->value());
+        xMin = qMin(xMin, poseAnnotation.x(n));
+        xMax = qMax(xMax, poseAnnotation.x(n));
+        yMin = qMin(yMin, poseAnnotation.y(n));
+        yMax = qMax(yMax, poseAnnotation.y(n));
     }
 
-    // DON'T DRAW ANYTHING IF ALL FIDUCIALS ARE EQUAL TO ZERO
     if (xMin == 0 && xMax == 0 && yMin == 0 && yMax == 0){
         return;
     }
 
-    int xLeft = (double)(xMin - 20) / (double)imageWidth * (double)sze.width();
-    int xWide = (double)(xMax - xMin + 40) / (double)imageWidth * (double)sze.width();
-    int yTop = (double)(yMin - 20) / (double)imageHeight * (double)sze.height();
-    int yTall = (double)(yMax - yMin + 40) / (double)imageHeight * (double)sze.height();
+    int xLeft = (double)(xMin - 20) / (double)poseAnnotation.width() * (double)sze.width();
+    int xWide = (double)(xMax - xMin + 40) / (double)poseAnnotation.width() * (double)sze.width();
+    int yTop = (double)(yMin - 20) / (double)poseAnnotation.height() * (double)sze.height();
+    int yTall = (double)(yMax - yMin + 40) / (double)poseAnnotation.height() * (double)sze.height();
 
-    painter->setPen(QPen(Qt::red, 3.0));
-    painter->setBrush(QBrush(QColor(Qt::red), Qt::NoBrush));
-    painter->drawRect(xLeft, yTop, xWide, yTall);
+    // JUST THE OUTLINE OF THE BOUNDING BOX, PADDED FOR ITS PEN WIDTH
+    QRect rect(xLeft, yTop, xWide, yTall);
+    *region += QRegion(rect.adjusted(-3, -3, 3, 3)).subtracted(QRegion(rect.adjusted(3, 3, -3, -3)));
 
-    for (int n = 0; n < fiducialWidgets.count(); n++){
-        if (fiducialWidgets.at(n)->xSpinBox->value() < 0){
+    for (int n = 0; n < poseAnnotation.fiducials(); n++){
+        if (poseAnnotation.x(n) < 0){
             continue;
         }
 
         QPoint point;
-        point.setX((double)fiducialWidgets.at(n)->xSpinBox->value() / (double)imageWidth * (double)sze.width());
-        point.setY((double)fiducialWidgets.at(n)->ySpinBox->value() / (double)imageHeight * (double)sze.height());
+        point.setX((double)poseAnnotation.x(n) / (double)poseAnnotation.width() * (double)sze.width());
+        point.setY((double)poseAnnotation.y(n) / (double)poseAnnotation.height() * (double)sze.height());
 
         if (point.x() == 0 && point.y() == 0){
             continue;
         }
 
-        if (fiducialWidgets.at(n)->zRadioButton->isChecked()){
-            painter->setPen(QPen(Qt::red, 6.0));
-            painter->setBrush(QBrush(QColor(Qt::red), Qt::SolidPattern));
-        } else {
-            painter->setPen(QPen(Qt::blue, 6.0));
-            painter->setBrush(QBrush(QColor(Qt::blue), Qt::SolidPattern));
-        }
-        painter->drawEllipse(point.x()-2, point.y()-2, 5, 5);
-        painter->drawText(point + QPoint(10,10), QString("%1").arg(fiducialWidgets.at(n)->index + 1));
+        // THE DOT AND ITS NUMBER
+        *region += QRect(point.x() - 6, point.y() - 6, 13, 13);
+        *region += metrics.boundingRect(QString("%1").arg(n + 1)).translated(point + QPoint(10,10)).adjusted(-2, -2, 2, 2);
     }
 }
 
@@ -1506,33 +2196,215 @@ void LAUYoloPoseLabelerPalette::onEnablePreviousFiducial()
     fiducialWidgets.prepend(fiducialWidgets.takeLast());
 }
 
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+LAUFiducialLabel::LAUFiducialLabel(QLabel *parent) : QLabel(parent)
+{
+    pyramid = new LAUImagePyramidObject(this);
+    connect(pyramid, SIGNAL(emitTileReady()), this, SLOT(update()));
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUFiducialLabel::setPixmap(QPixmap map)
+{
+    // KEEP THE ZOOM AND PAN WHEN STEPPING BETWEEN IMAGES OF THE SAME SIZE
+    if (map.size() != imageSize){
+        zoom = 1.0;
+        pan = QPoint();
+    }
+    imageSize = map.size();
+
+    pixmap = map;
+    scaledPixmap = QPixmap();
+    pyramid->setImage(LAUImage());
+    update();
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUFiducialLabel::setImage(LAUImage image, QPixmap map)
+{
+    // KEEP THE ZOOM AND PAN WHEN STEPPING BETWEEN IMAGES OF THE SAME SIZE
+    if (QSize(image.width(), image.height()) != imageSize){
+        zoom = 1.0;
+        pan = QPoint();
+    }
+    imageSize = QSize(image.width(), image.height());
+
+    pixmap = map;
+    scaledPixmap = QPixmap();
+    pyramid->setImage(image);
+    update();
+}
+
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
 void LAUFiducialLabel::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
+    qreal ratio = this->devicePixelRatioF();
+    QSize canvas = canvasSize();
 
     QPainter painter;
     painter.begin(this);
     painter.setRenderHint(QPainter::Antialiasing);
-    painter.drawPixmap(QRect(0, 0, this->width(), this->height()), pixmap);
-    emit emitPaint(&painter, this->size());
+
+    if (zoom == 1.0){
+        // RESCALE THE OVERVIEW PIXMAP ONLY WHEN THE IMAGE, WIDGET SIZE, OR SCREEN CHANGES
+        QSize size = this->size() * ratio;
+        if (pixmap.isNull() == false && scaledPixmap.size() != size){
+            scaledPixmap = pixmap.scaled(size, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+            scaledPixmap.setDevicePixelRatio(ratio);
+        }
+
+        // ONLY COPY THE PART OF THE CACHED PIXMAP THAT NEEDS REPAINTING, THE OVERLAY GETS CLIPPED TO IT TOO
+        QRect rect = event->rect();
+        painter.drawPixmap(rect.topLeft(), scaledPixmap, QRect(rect.topLeft() * ratio, rect.size() * ratio));
+    } else if (pixmap.isNull() == false){
+        // STRETCH THE VISIBLE PART OF THE OVERVIEW UNDERNEATH THE TILES SO THERE ARE NEVER ANY HOLES
+        QRectF source((double)pan.x() / (double)canvas.width() * (double)pixmap.width(),
+                      (double)pan.y() / (double)canvas.height() * (double)pixmap.height(),
+                      (double)this->width() / (double)canvas.width() * (double)pixmap.width(),
+                      (double)this->height() / (double)canvas.height() * (double)pixmap.height());
+        painter.drawPixmap(QRectF(this->rect()), pixmap, source);
+    }
+
+    // DRAW SHARPER TILES ON TOP WHEN THE OVERVIEW DOESN'T HAVE ENOUGH PIXELS FOR THE SCREEN
+    drawTiles(&painter, canvas, ratio);
+
+    painter.translate(-pan);
+    emit emitPaint(&painter, canvas);
 
     painter.end();
 }
 
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUFiducialLabel::drawTiles(QPainter *painter, QSize canvas, qreal ratio)
+{
+    if (pyramid->levels() == 0){
+        return;
+    }
+
+    // NUMBER OF SOURCE PIXELS PER DEVICE PIXEL AT THE CURRENT ZOOM
+    double scale = (double)imageSize.width() / ((double)canvas.width() * ratio);
+    if (pixmap.isNull() == false && scale >= (double)imageSize.width() / (double)pixmap.width()){
+        return;
+    }
+
+    // PICK THE COARSEST LEVEL THAT STILL HAS AT LEAST ONE PIXEL PER DEVICE PIXEL
+    int level = 0;
+    while (level < pyramid->levels() - 1 && (double)(2 << level) <= scale){
+        level++;
+    }
+
+    // WIDGET PIXELS PER LEVEL PIXEL
+    QSize levelSize = pyramid->levelSize(level);
+    double xScale = (double)canvas.width() / (double)levelSize.width();
+    double yScale = (double)canvas.height() / (double)levelSize.height();
+
+    // RANGE OF TILES THAT COVER THE VISIBLE PART OF THE CANVAS
+    int colA = qMax(0, (int)(pan.x() / xScale) / LAUIMAGEPYRAMIDTILESIZE);
+    int colB = qMin((levelSize.width() - 1) / LAUIMAGEPYRAMIDTILESIZE, (int)((pan.x() + this->width()) / xScale) / LAUIMAGEPYRAMIDTILESIZE);
+    int rowA = qMax(0, (int)(pan.y() / yScale) / LAUIMAGEPYRAMIDTILESIZE);
+    int rowB = qMin((levelSize.height() - 1) / LAUIMAGEPYRAMIDTILESIZE, (int)((pan.y() + this->height()) / yScale) / LAUIMAGEPYRAMIDTILESIZE);
+
+    QList<quint64> keys;
+    for (int row = rowA; row <= rowB; row++){
+        for (int col = colA; col <= colB; col++){
+            QRect levelRect = QRect(col * LAUIMAGEPYRAMIDTILESIZE, row * LAUIMAGEPYRAMIDTILESIZE, LAUIMAGEPYRAMIDTILESIZE, LAUIMAGEPYRAMIDTILESIZE).intersected(QRect(QPoint(0, 0), levelSize));
+            QRectF target(levelRect.x() * xScale - pan.x(), levelRect.y() * yScale - pan.y(), levelRect.width() * xScale, levelRect.height() * yScale);
+
+            QPixmap tile = pyramid->tile(level, col, row);
+            if (tile.isNull() == false){
+                painter->drawPixmap(target, tile, QRectF(tile.rect()));
+                continue;
+            }
+            keys << LAUImagePyramidObject::key(level, col, row);
+
+            // UNTIL THIS TILE ARRIVES, BORROW THE SAME AREA FROM A COARSER TILE IF WE HAVE ONE
+            for (int n = level + 1; n < pyramid->levels(); n++){
+                QSize size = pyramid->levelSize(n);
+                QRectF rect(levelRect.x() * (double)size.width() / (double)levelSize.width(),
+                            levelRect.y() * (double)size.height() / (double)levelSize.height(),
+                            levelRect.width() * (double)size.width() / (double)levelSize.width(),
+                            levelRect.height() * (double)size.height() / (double)levelSize.height());
+                int c = (int)rect.x() / LAUIMAGEPYRAMIDTILESIZE;
+                int r = (int)rect.y() / LAUIMAGEPYRAMIDTILESIZE;
+                QPixmap coarse = pyramid->tile(n, c, r);
+                if (coarse.isNull() == false){
+                    painter->drawPixmap(target, coarse, rect.translated(-c * LAUIMAGEPYRAMIDTILESIZE, -r * LAUIMAGEPYRAMIDTILESIZE));
+                    break;
+                }
+            }
+        }
+    }
+
+    // ONLY THE VISIBLE TILES GET RENDERED, ANYTHING THAT SCROLLED AWAY IS CANCELLED
+    pyramid->request(keys);
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUFiducialLabel::clampPan()
+{
+    QSize canvas = canvasSize();
+    pan.setX(qBound(0, pan.x(), canvas.width() - this->width()));
+    pan.setY(qBound(0, pan.y(), canvas.height() - this->height()));
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUFiducialLabel::resizeEvent(QResizeEvent *event)
+{
+    scaledPixmap = QPixmap();
+    clampPan();
+    QLabel::resizeEvent(event);
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUFiducialLabel::wheelEvent(QWheelEvent *event)
+{
+    double factor = qPow(1.25, (double)event->angleDelta().y() / 120.0);
+    double newZoom = qBound(1.0, zoom * factor, LAUFIDUCIALLABELMAXZOOM);
+    if (newZoom == zoom){
+        return;
+    }
+
+    // KEEP THE POINT UNDER THE CURSOR FIXED WHILE ZOOMING
+    QPointF position = event->position();
+    QPointF point = (position + QPointF(pan)) * (newZoom / zoom) - position;
+
+    zoom = newZoom;
+    pan = point.toPoint();
+    clampPan();
+    update();
+}
+
 /*************************************************************************************/
 /*************************************************************************************/
 /*************************************************************************************/
 void LAUFiducialLabel::mouseDoubleClickEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
-        int x = qRound(event->pos().x() / (double)this->width() * pixmap.width());
-        int y = qRound(event->pos().y() / (double)this->height() * pixmap.height());
+        // MAP THE CLICK FROM THE WIDGET TO THE CANVAS AND THEN TO THE SOURCE IMAGE
+        QSize canvas = canvasSize();
+        int x = qRound((event->pos().x() + pan.x()) / (double)canvas.width() * imageSize.width());
+        int y = qRound((event->pos().y() + pan.y()) / (double)canvas.height() * imageSize.height());
 
+        // REPAINT WHERE THE OVERLAY WAS AND WHERE IT IS NOW, NOT THE WHOLE IMAGE
+        QRegion region = overlayRegion();
         emit emitMousePressEvent(x, y);
-        update();
+        update(region + overlayRegion());
     }
 }
 
@@ -1543,5 +2415,21 @@ void LAUFiducialLabel::mousePressEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::RightButton) {
         emit emitMouseRightClickEvent(event);
+    } else {
+        dragPosition = event->pos();
+    }
+}
+
+/*************************************************************************************/
+/*************************************************************************************/
+/*************************************************************************************/
+void LAUFiducialLabel::mouseMoveEvent(QMouseEvent *event)
+{
+    // DRAG WITH THE LEFT OR MIDDLE BUTTON TO PAN AROUND WHEN ZOOMED IN
+    if (zoom > 1.0 && (event->buttons() & (Qt::LeftButton | Qt::MiddleButton))) {
+        pan -= event->pos() - dragPosition;
+        dragPosition = event->pos();
+        clampPan();
+        update();
     }
 }
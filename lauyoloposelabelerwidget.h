@@ -15,8 +15,28 @@
 #include <QMouseEvent>
 #include <QKeyEvent>
 #include <QPainter>
+#include <QRegion>
+#include <QFontMetrics>
 
 #include "lauimage.h"
+#include "lauposeannotation.h"
+#include "laucocoexporter.h"
+#include "lauposeimporter.h"
+#include "lauposeexporter.h"
+#include "laudatasetindex.h"
+#include "laudatasetreport.h"
+#include "laudirectorywalker.h"
+#include "laudirectorywatcher.h"
+#include "lauperceptualhash.h"
+#include "lauthumbnailbrowser.h"
+#include "lauimagewriterobject.h"
+#include "lauannotationjournal.h"
+#include "lauannotationstatistics.h"
+#include "lauposeinferenceobject.h"
+#include "lauimageprefetchobject.h"
+#include "lauimagepyramidobject.h"
+
+#define LAUFIDUCIALLABELMAXZOOM         32.0
 
 /*************************************************************************************/
 /*************************************************************************************/
@@ -26,22 +46,51 @@ class LAUFiducialLabel : public QLabel
     Q_OBJECT
 
 public:
-    LAUFiducialLabel(QLabel *parent = nullptr) : QLabel(parent) { ; }
+    LAUFiducialLabel(QLabel *parent = nullptr);
 
-    void setPixmap(QPixmap map) { pixmap = map; update(); }
+    // SHOW JUST A PIXMAP, OR AN OVERVIEW PIXMAP THAT GETS FILLED IN WITH TILES FROM THE IMAGE WHEN ZOOMED IN
+    void setPixmap(QPixmap map);
+    void setImage(LAUImage image, QPixmap map);
+
+    // AREA OF THE WIDGET COVERED BY THE FIDUCIAL OVERLAY, TAKE ONE BEFORE AND AFTER A CHANGE AND UPDATE BOTH
+    QRegion overlayRegion()
+    {
+        QRegion region;
+        emit emitOverlayRegion(&region, canvasSize(), this->fontMetrics());
+        return (region.translated(-pan));
+    }
 
 protected:
     void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void wheelEvent(QWheelEvent *event);
     void mouseDoubleClickEvent(QMouseEvent *event);
     void mousePressEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
 
 signals:
     void emitPaint(QPainter *painter, QSize sze);
+    void emitOverlayRegion(QRegion *region, QSize sze, QFontMetrics metrics);
     void emitMousePressEvent(int x, int y);
     void emitMouseRightClickEvent(QMouseEvent *event);
 
 private:
+    QSize imageSize;
     QPixmap pixmap;
+    QPixmap scaledPixmap;
+    LAUImagePyramidObject *pyramid = nullptr;
+
+    // THE WHOLE IMAGE IS STRETCHED ACROSS A CANVAS ZOOM TIMES THE SIZE OF THE WIDGET, PAN IS THE CORNER OF THE CANVAS WE SEE
+    double zoom = 1.0;
+    QPoint pan;
+    QPoint dragPosition;
+
+    QSize canvasSize() const
+    {
+        return (QSize(qRound(this->width() * zoom), qRound(this->height() * zoom)));
+    }
+    void clampPan();
+    void drawTiles(QPainter *painter, QSize canvas, qreal ratio);
 };
 
 /*************************************************************************************/
@@ -59,6 +108,15 @@ public:
     QSpinBox *xSpinBox = nullptr;
     QSpinBox *ySpinBox = nullptr;
     QRadioButton *zRadioButton = nullptr;
+
+public slots:
+    void onRadioButtonToggled(bool state)
+    {
+        emit emitVisibleToggled(index, state);
+    }
+
+signals:
+    void emitVisibleToggled(int index, bool state);
 };
 
 /*************************************************************************************/
@@ -73,36 +131,47 @@ public:
     LAUYoloPoseLabelerPalette(QStringList labels = QStringList(), QStringList fiducials = QStringList(), QWidget *parent = nullptr);
     ~LAUYoloPoseLabelerPalette();
 
-    QByteArray xml(QRect roi = QRect(0,0,0,0), double scale = 1.0, bool flag = false) const;
+    // THE PALETTE IS JUST A VIEW OF THIS, BATCH JOBS WORK ON THEIR OWN COPIES WITHOUT TOUCHING ANY WIDGETS
+    LAUPoseAnnotation annotation() const { return(poseAnnotation); }
+    void setAnnotation(LAUPoseAnnotation value);
+
+    QByteArray xml(QRect roi = QRect(0,0,0,0), double scale = 1.0, bool flag = false) const
+    {
+        return(poseAnnotation.xml(roi, scale, flag));
+    }
+
     void setXml(QByteArray string);
     void setImageSize(int x, int y)
     {
-        imageWidth = x;
-        imageHeight = y;
+        poseAnnotation.setImageSize(x, y);
     }
 
     void setFilename(QString string)
     {
-        originalFileName = string;
+        poseAnnotation.setOrigin(string);
     }
 
     QString filename() const
     {
-        return(originalFileName);
+        return(poseAnnotation.origin());
     }
 
     void setDirty(bool state) { dirtyFlag = state; }
     bool isDirty() const { return(dirtyFlag); }
-    QString labelString(QRect *rect, bool flag = false) const;
-    QStringList labels() const;
-    int fiducials() const { return(fiducialWidgets.count()); }
-    int getClass() const { return(labelsComboBox->currentIndex()); }
+
+    void setConfidence(float value) { poseAnnotation.setConfidence(value); }
+    float confidence() const { return(poseAnnotation.confidence()); }
+    QString labelString(QRect *rect, bool flag = false) const { return(poseAnnotation.labelString(rect, flag)); }
+    QStringList labels() const { return(poseAnnotation.labels()); }
+    int fiducials() const { return(poseAnnotation.fiducials()); }
+    int getClass() const { return(poseAnnotation.classIndex()); }
 
     void setClass(int index);
     void setFiducial(int index, int x, int y, bool z);
 
 public slots:
     void onPaintEvent(QPainter *painter, QSize sze);
+    void onOverlayRegion(QRegion *region, QSize sze, QFontMetrics metrics);
     void onNextButtonClicked(bool state)
     {
         emit emitNextButtonClicked(state);
@@ -113,40 +182,53 @@ public slots:
         emit emitPreviousButtonClicked(state);
     }
 
-    void onLabelIndexChanged(int)
+    void onLabelIndexChanged(int index)
     {
+        poseAnnotation.setClassIndex(index);
         dirtyFlag = true;
     }
 
     void onSpinBoxValueChanged(int x, int y)
     {
-        fiducialWidgets.constFirst()->xSpinBox->setValue(x);
-        fiducialWidgets.constFirst()->ySpinBox->setValue(y);
+        LAUFiducialWidget *widget = fiducialWidgets.constFirst();
+        poseAnnotation.setFiducial(widget->index, x, y, poseAnnotation.isVisible(widget->index));
+        widget->xSpinBox->setValue(x);
+        widget->ySpinBox->setValue(y);
         dirtyFlag = true;
+        emit emitEdited();
         onEnableNextFiducial();
     }
 
     void onVisibleRadioButtonToggled()
     {
-        fiducialWidgets.constFirst()->zRadioButton->toggle();
+        LAUFiducialWidget *widget = fiducialWidgets.constFirst();
+        poseAnnotation.setVisible(widget->index, !poseAnnotation.isVisible(widget->index));
+        widget->zRadioButton->setChecked(poseAnnotation.isVisible(widget->index));
         dirtyFlag = true;
+        emit emitEdited();
         onEnableNextFiducial();
     }
 
+    void onFiducialVisibleToggled(int index, bool state)
+    {
+        poseAnnotation.setVisible(index, state);
+    }
+
     void onEnableNextFiducial();
     void onEnablePreviousFiducial();
 
 private:
     bool dirtyFlag = false;
-    QString originalFileName;
-    int imageWidth, imageHeight;
+    LAUPoseAnnotation poseAnnotation;
     void initialize(QStringList labels, QStringList fiducials);
+    void updateWidgets();
     QList<LAUFiducialWidget*> fiducialWidgets;
     QComboBox *labelsComboBox;
 
 signals:
     void emitNextButtonClicked(bool state);
     void emitPreviousButtonClicked(bool state);
+    void emitEdited();
 };
 
 /*************************************************************************************/
@@ -160,16 +242,37 @@ public:
     LAUYoloPoseLabelerWidget(QStringList strings = QStringList(), QWidget *parent = nullptr);
     ~LAUYoloPoseLabelerWidget();
 
-    bool isValid() const { return(fileStrings.isEmpty() == false); }
+    bool isValid() const { return(fileStrings.isEmpty() == false || walker != nullptr); }
 
 public slots:
     void onContextMenuTriggered(QMouseEvent *event);
     void onExportLabelsForYoloClassifierTraining();
     void onExportLabelsForYoloPoseTraining();
+    void onExportLabelsAsCocoKeypoints();
+    void onImportLabels();
     void onSortByClass();
+    void onDatasetReport();
+    void onCheckAnnotations();
     void onLabelImagesFromDisk();
     void onPreviousButtonClicked(bool state);
     void onNextButtonClicked(bool state);
+    void onGoToImage();
+    void onBrowseThumbnails();
+    void onBrowserImageSelected(int row);
+    void onSetNavigationFilter();
+    void onSkipNearDuplicates(bool state);
+    void onSetPrefetchWindow();
+    void onSetPreviewCacheSize();
+    void onSaveComplete(QString filename, bool flag);
+    void onFilesFound(QStringList strings);
+    void onWalkComplete();
+    void onFilesChanged(QStringList strings);
+    void onFilesRemoved(QStringList strings);
+    void onPaletteEdited();
+    void onEnableModelAssist();
+    void onImageReady(QString filename);
+    void onPredictionReady(QString filename);
+    void onAcceptPrediction();
 
 protected:
     bool eventFilter(QObject *obj, QEvent *event)
@@ -191,8 +294,12 @@ protected:
                 palette->onEnablePreviousFiducial();
                 return (true);
             } else if (((QKeyEvent*)event)->key() == Qt::Key_Space){
+                QRegion region = label->overlayRegion();
                 palette->onVisibleRadioButtonToggled();
-                label->update();
+                label->update(region + label->overlayRegion());
+                return (true);
+            } else if (((QKeyEvent*)event)->key() == Qt::Key_Return || ((QKeyEvent*)event)->key() == Qt::Key_Enter){
+                this->onAcceptPrediction();
                 return (true);
             } else if (((QKeyEvent*)event)->key() == Qt::Key_Left){
                 this->onPreviousButtonClicked(true);
@@ -212,9 +319,61 @@ protected:
 
 private:
     void initialize();
+    void saveCurrentImage();
+    void showCurrentImage();
+    void stepCurrentImage(int step);
+    void updateWindowTitle();
+    bool findNearDuplicates();
+    void applyPrediction(LAUPoseInferenceObject::Prediction prediction);
+    QStringList prefetchStrings() const;
+
+    QString currentFilename() const
+    {
+        return (fileStrings.at(currentIndex));
+    }
+
     LAUImage image;
     QStringList fileStrings;
+    int currentIndex = 0;
+
+    // DIRECTORIES ARE WALKED IN THE BACKGROUND AND THEIR FILES APPENDED AS THEY ARE FOUND
+    LAUDirectoryWalker *walker = nullptr;
+    QStringList directoryStrings;
+    QString resumeFilename;
+    bool navigatedFlag = false;
+
+    // ONCE THE WALK IS DONE, FILES DROPPED INTO OR DELETED FROM THOSE DIRECTORIES ARE PICKED UP AS THEY HAPPEN
+    LAUDirectoryWatcher *directoryWatcher = nullptr;
+    QSet<QString> savedStrings;
+
+    // TABLE OF LABEL STATE FOR EVERY FILE SO WE CAN JUMP AROUND WITHOUT DECODING ANYTHING
+    LAUDatasetIndex *datasetIndex = nullptr;
+    LAUDatasetIndex::Filter navigationFilter = LAUDatasetIndex::FilterAll;
+    int navigationClass = 0;
+
+    // NEXT, PREVIOUS AND THE EXPORTS ONLY VISIT THE FIRST FRAME OF EACH RUN OF NEAR DUPLICATES
+    bool skipDuplicatesFlag = false;
+
+    // GRID OF EVERY FILE IN THE INDEX, CREATED THE FIRST TIME SOMEONE ASKS FOR IT
+    LAUThumbnailBrowser *browser = nullptr;
+
     LAUFiducialLabel *label = nullptr;
     LAUYoloPoseLabelerPalette *palette = nullptr;
+
+    bool forwardFlag = true;
+    int prefetchAhead = LAUIMAGEPREFETCHAHEAD;
+    int prefetchBehind = LAUIMAGEPREFETCHBEHIND;
+    LAUImagePrefetchObject *prefetcher = nullptr;
+    LAUImageWriterObject *writer = nullptr;
+
+    // EVERY EDIT IS LOGGED HERE RIGHT AWAY SO A CRASH NEVER COSTS MORE THAN ONE BATCH WINDOW OF WORK
+    LAUAnnotationJournal *journal = nullptr;
+
+    // OPTIONAL MODEL THAT PREDICTS LABELS FOR THE UNLABELED IMAGES AROUND THE CURSOR
+    LAUPoseInferenceObject *inference = nullptr;
+    bool prefillFlag = false;
+
+    // THE PALETTE HOLDS A GUESS NOBODY HAS CHECKED, WHICH IS LEFT UNSAVED UNTIL IT IS EDITED OR ACCEPTED
+    bool predictionFlag = false;
 };
 #endif // LAUYOLOPOSELABELERWIDGET_H
@@ -1,9 +1,32 @@
+#include "laucommandline.h"
+
+#include <QCoreApplication>
+
+#ifndef HEADLESS
 #include "lauyoloposelabelerwidget.h"
 
 #include <QApplication>
+#endif
 
 int main(int argc, char *argv[])
 {
+    // A SUBCOMMAND AS THE FIRST ARGUMENT RUNS A BATCH ACTION WITHOUT CREATING A SINGLE WIDGET
+    if (argc > 1 && LAUCommandLine::isCommand(QString::fromLocal8Bit(argv[1]))){
+        QCoreApplication app(argc, argv);
+        app.setOrganizationName(QString("Lau Consulting Inc"));
+        app.setOrganizationDomain(QString("drhalftone.com"));
+        app.setApplicationName(QString("Fly's Eye Interlacing Tool"));
+
+        LAUCommandLine commandLine(app.arguments());
+        return commandLine.exec();
+    }
+
+#ifdef HEADLESS
+    QCoreApplication app(argc, argv);
+    LAUCommandLine commandLine(QStringList() << app.arguments().value(0) << QString("--help"));
+    commandLine.exec();
+    return 1;
+#else
     QApplication app(argc, argv);
     app.setQuitOnLastWindowClosed(false);
     app.setOrganizationName(QString("Lau Consulting Inc"));
@@ -11,10 +34,12 @@ int main(int argc, char *argv[])
     app.setApplicationName(QString("Fly's Eye Interlacing Tool"));
     app.setQuitOnLastWindowClosed(true);
 
-    LAUYoloPoseLabelerWidget w;
+    // IMAGES OR DIRECTORIES OF IMAGES CAN BE GIVEN ON THE COMMAND LINE, OTHERWISE WE ASK FOR A DIRECTORY
+    LAUYoloPoseLabelerWidget w(app.arguments().mid(1));
     if (w.isValid()){
         w.show();
         return app.exec();
     }
     return 1;
+#endif
 }